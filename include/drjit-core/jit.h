@@ -265,6 +265,149 @@ extern JIT_EXPORT uint32_t jit_llvm_vector_width();
 /// Specify the number of threads that are used to parallelize the computation
 extern JIT_EXPORT void jit_llvm_set_thread_count(uint32_t size);
 
+/// Get the number of threads that are used to parallelize the computation
+extern JIT_EXPORT uint32_t jit_llvm_thread_count();
+
+/**
+ * \brief NUMA-related policies of the LLVM backend
+ *
+ * On multi-socket machines, the placement of memory pages and the assignment
+ * of work to threads can have a large impact on the performance of
+ * bandwidth-bound kernels. See \ref jit_llvm_set_numa_mode().
+ */
+#if defined(__cplusplus)
+enum class NUMAMode : uint32_t {
+    /// Leave page placement to the OS and balance blocks dynamically (default)
+    Disabled = 0,
+
+    /// Interleave the pages of large host-asynchronous allocations across nodes
+    Interleave = 1,
+
+    /**
+     * Partition large host-asynchronous allocations into one contiguous range
+     * per NUMA node, and preferentially process the kernel blocks that access
+     * each range on pool threads that are pinned to the owning node. Pool
+     * threads are pinned when they first run such a kernel and stay pinned.
+     */
+    Partition = 2
+};
+#else
+enum NUMAMode {
+    NUMAModeDisabled = 0,
+    NUMAModeInterleave = 1,
+    NUMAModePartition = 2
+};
+#endif
+
+/**
+ * \brief Set the NUMA policy of the LLVM backend
+ *
+ * The policy applies to host-asynchronous allocations that are made after
+ * this call (the allocation cache is flushed when the mode changes). The
+ * request is ignored with a warning on machines with a single NUMA node.
+ * NUMA support is currently only available on Linux.
+ */
+extern JIT_EXPORT void jit_llvm_set_numa_mode(JIT_ENUM NUMAMode mode);
+
+/// Return the NUMA policy of the LLVM backend
+extern JIT_EXPORT JIT_ENUM NUMAMode jit_llvm_numa_mode();
+
+/// Return the number of NUMA nodes detected on this machine
+extern JIT_EXPORT uint32_t jit_llvm_numa_node_count();
+
+/**
+ * \brief Configure software prefetching of gathers in LLVM kernels
+ *
+ * When enabled, the LLVM backend looks for gathers whose index is read from
+ * an evaluated array. It then loads the indices of the packet that the kernel
+ * will process \c distance iterations later and issues prefetch instructions
+ * for the associated addresses, which hides part of the latency of cache
+ * misses in random-access workloads. Gathers with other kinds of indices are
+ * not affected.
+ *
+ * \param enable
+ *     Enable or disable prefetching (it is disabled by default).
+ *
+ * \param distance
+ *     Number of packets (i.e., loop iterations of the kernel) to look ahead.
+ *     The value \c 0 chooses a distance based on the size of each kernel.
+ */
+extern JIT_EXPORT void jit_llvm_set_prefetch(int enable, uint32_t distance);
+
+/// Return whether gathers are prefetched and the prefetch distance (see above)
+extern JIT_EXPORT int jit_llvm_prefetch(uint32_t *distance);
+
+/**
+ * \brief Configure coherent dispatch of virtual function calls in LLVM kernels
+ *
+ * The LLVM backend normally dispatches a virtual function call by invoking
+ * each instance referenced by a packet with a partial mask. When many
+ * instances are involved, most SIMD lanes of these calls are idle. In
+ * coherent mode, the worker threads instead sort the lanes of every block of
+ * the kernel by their \c self value before running it, so that the packets
+ * mostly reference a single instance. The kernel then loads and stores its
+ * arrays through this permutation.
+ *
+ * Sorting has a cost, hence it is only done for blocks where the average
+ * number of distinct instances per packet (measured before sorting) is at
+ * least \c threshold. Coherent mode requires the \c self argument of the
+ * call to be an evaluated array. \ref jit_var_vcall() evaluates it when
+ * this mode is active.
+ *
+ * \param threshold
+ *     Minimum divergence that triggers sorting. The default value \c 0
+ *     disables coherent mode.
+ */
+extern JIT_EXPORT void jit_llvm_set_vcall_coherence(float threshold);
+
+/// Return the divergence threshold of coherent dispatch (see above)
+extern JIT_EXPORT float jit_llvm_vcall_coherence();
+
+/**
+ * \brief Select the vector width of LLVM kernels
+ *
+ * By default, every kernel is compiled for the vector width of the target
+ * (see \ref jit_llvm_set_target()). Narrower kernels can be faster when
+ * most of their work consists of gathers or divergent control flow, e.g. on
+ * machines that lower their clock frequency when executing AVX512
+ * instructions. The vector width is part of the generated code, hence kernels
+ * compiled at different widths coexist in the kernel cache.
+ *
+ * \param width
+ *     Vector width of subsequently compiled kernels. This must be a power of
+ *     two between 4 and the vector width of the target. The value \c 0 selects
+ *     the width of the target.
+ *
+ * \param autotune
+ *     When enabled, the first launches of large kernels alternate between the
+ *     above width and half of it while measuring the time per element. The
+ *     faster variant is then used for all later kernels with the same
+ *     structure. Timed launches run synchronously.
+ */
+extern JIT_EXPORT void jit_llvm_set_kernel_width(uint32_t width, int autotune);
+
+/// Return the vector width of LLVM kernels and whether it is autotuned (see above)
+extern JIT_EXPORT uint32_t jit_llvm_kernel_width(int *autotune);
+
+/**
+ * \brief Unroll the main loop of LLVM kernels
+ *
+ * Every iteration of the loop in a generated LLVM kernel normally processes a
+ * single packet (see \ref jit_llvm_vector_width()). With unrolling, LLVM
+ * processes \c packets consecutive packets per iteration and interleaves
+ * their instructions, which exposes more instruction-level parallelism in
+ * short, latency-bound kernels at the cost of larger code. Kernel sizes that
+ * are not a multiple of the unrolled step are handled by a remainder loop.
+ *
+ * \param packets
+ *     Number of packets per loop iteration, between 1 (the default, which
+ *     disables unrolling) and 4.
+ */
+extern JIT_EXPORT void jit_llvm_set_unroll(uint32_t packets);
+
+/// Return the number of packets per loop iteration of LLVM kernels (see above)
+extern JIT_EXPORT uint32_t jit_llvm_unroll();
+
 // ====================================================================
 //                        Logging infrastructure
 // ====================================================================
@@ -643,7 +786,8 @@ extern JIT_EXPORT uint32_t jit_var_literal(JIT_ENUM JitBackend backend,
  * \brief Create a counter variable
  *
  * This operation creates a variable of type \ref VarType::UInt32 that will
- * evaluate to <tt>0, ..., size - 1</tt>.
+ * evaluate to <tt>0, ..., size - 1</tt>. Counters of arrays with 2^32 or more
+ * entries (only supported by the LLVM backend) have type \ref VarType::UInt64.
  */
 extern JIT_EXPORT uint32_t jit_var_counter(JIT_ENUM JitBackend backend,
                                            size_t size);
@@ -687,7 +831,7 @@ enum class JitOp : uint32_t {
     // Fast approximations
     Rcp, Rsqrt,
 
-    // Multi-function generator (CUDA)
+    // Transcendental functions (CUDA: multi-function generator, LLVM: polynomials)
     Sin, Cos, Exp2, Log2,
 
     // Total number of operations
@@ -926,6 +1070,23 @@ extern JIT_EXPORT uint32_t jit_var_scatter(uint32_t target, uint32_t value,
                                            uint32_t index, uint32_t mask,
                                            JIT_ENUM ReduceOp reduce_op);
 
+/**
+ * \brief Variant of \ref jit_var_scatter() for indices that are known to be
+ * unique
+ *
+ * The caller guarantees that the active entries of \c index do not contain
+ * duplicates, and that no other scatter of the same kernel modifies these
+ * entries of \c target. Scatter-reductions can then be implemented without
+ * atomic memory operations: the LLVM backend lowers them to a sequence of
+ * gather, arithmetic operation, and scatter. The result is undefined if the
+ * guarantee is violated.
+ */
+extern JIT_EXPORT uint32_t jit_var_scatter_unique(uint32_t target,
+                                                  uint32_t value,
+                                                  uint32_t index,
+                                                  uint32_t mask,
+                                                  JIT_ENUM ReduceOp reduce_op);
+
 /**
  * \brief Schedule a Kahan-compensated floating point atomic scatter-write
  *
@@ -1005,6 +1166,55 @@ extern JIT_EXPORT uint32_t jit_var_mem_copy(JIT_ENUM JitBackend backend,
                                             const void *ptr,
                                             size_t size);
 
+/**
+ * \brief Create a variable backed by a memory-mapped region of a file
+ *
+ * On the LLVM backend, this function maps the specified file region into
+ * memory without copying it, and returns the index of a new variable that
+ * directly references the mapping. Its reference count is initialized to \c 1,
+ * and the region is unmapped once the variable is freed and all kernels
+ * accessing it have finished. On the CUDA backend, the region is mapped,
+ * uploaded to the device, and unmapped right away.
+ *
+ * \param vtype
+ *    Type of the variable to be created, see \ref VarType for details.
+ *
+ * \param filename
+ *    Path of the file to be mapped.
+ *
+ * \param offset
+ *    Offset of the region in bytes (does not need to be page-aligned).
+ *
+ * \param size
+ *    Number of elements (and *not* the size in bytes)
+ *
+ * \param shared
+ *    If \c shared == 0, the mapping is private and copy-on-write: the file is
+ *    never modified, and pages are only copied when written (e.g. by a
+ *    scatter). Otherwise, writes are carried through to the file.
+ *
+ * This feature is currently unavailable on Windows.
+ *
+ * \sa jit_var_write_file()
+ */
+extern JIT_EXPORT uint32_t jit_var_mem_map_file(JIT_ENUM JitBackend backend,
+                                                JIT_ENUM VarType vtype,
+                                                const char *filename,
+                                                size_t offset, size_t size,
+                                                int shared JIT_DEF(0));
+
+/**
+ * \brief Write the contents of a variable to a file
+ *
+ * The variable is evaluated if necessary, and its contents are then streamed
+ * to \c filename (which is created or truncated) in large chunks. Literal
+ * constants are written without materializing them in memory. On the CUDA
+ * backend, downloads to host memory overlap with the file writes.
+ *
+ * \sa jit_var_mem_map_file()
+ */
+extern JIT_EXPORT void jit_var_write_file(uint32_t index, const char *filename);
+
 /// Increase the reference count of a given variable
 extern JIT_EXPORT void jit_var_inc_ref_impl(uint32_t index) JIT_NOEXCEPT;
 
@@ -1187,6 +1397,27 @@ extern JIT_EXPORT int jit_var_eval(uint32_t index);
 /// Evaluate all scheduled computation
 extern JIT_EXPORT void jit_eval();
 
+/**
+ * \brief Limit the size of the kernels generated by \ref jit_eval()
+ *
+ * Very large kernels (e.g. involving many vcalls or unrolled loops) are slow
+ * to compile and can suffer from register spilling. Kernels with more than \c
+ * max_ops operations or more than \c max_live simultaneously live values (an
+ * estimate of register pressure) are split into several kernels that run one
+ * after the other. Intermediate results needed by later kernels are stored to
+ * memory, and the split points are chosen to keep their number small. Loops
+ * and vcalls are never split.
+ *
+ * Passing zero disables the associated limit. The defaults are <tt>max_ops =
+ * 100000</tt> and <tt>max_live = 0</tt>.
+ */
+extern JIT_EXPORT void jit_set_kernel_split_threshold(uint32_t max_ops,
+                                                      uint32_t max_live);
+
+/// Query the limits specified via \ref jit_set_kernel_split_threshold()
+extern JIT_EXPORT void jit_kernel_split_threshold(uint32_t *max_ops,
+                                                  uint32_t *max_live);
+
 /**
  * \brief Assign a callback function that is invoked when the variable is
  * evaluated or freed.
@@ -1203,6 +1434,90 @@ extern JIT_EXPORT void
 jit_var_set_callback(uint32_t index, void (*callback)(uint32_t, int, void *),
                      void *callback_data);
 
+/// Describes an input of \ref jit_eval_stream()
+struct JitStreamInput {
+    /// Element type
+    JIT_ENUM VarType type;
+
+    /// Memory-map the input from this file (or \c NULL if \c source is used)
+    const char *filename;
+
+    /// Byte offset of the first element within \c filename
+    size_t offset;
+
+    /**
+     * \brief Callback that writes \c count elements starting at element \c
+     * start to \c dst (or \c NULL if \c filename is used)
+     */
+    void (*source)(void *payload, size_t start, uint32_t count, void *dst);
+
+    /// Payload passed to \c source
+    void *payload;
+};
+
+/// Describes an output of \ref jit_eval_stream()
+struct JitStreamOutput {
+    /**
+     * \brief Reduction that combines the output across all chunks
+     *
+     * When set to <tt>ReduceOp::None</tt>, the output is instead processed
+     * elementwise and delivered to \c filename or \c sink.
+     */
+    JIT_ENUM ReduceOp reduce;
+
+    /// Write elementwise outputs to this file (or \c NULL if \c sink is used)
+    const char *filename;
+
+    /**
+     * \brief Callback that receives \c count elements starting at element
+     * \c start (or \c NULL if \c filename is used)
+     */
+    void (*sink)(void *payload, size_t start, uint32_t count, const void *src);
+
+    /// Payload passed to \c sink
+    void *payload;
+
+    /// Receives the bit pattern of the reduced value (reductions only)
+    uint64_t result;
+};
+
+/// Callback that traces one chunk of a streaming evaluation
+typedef void (*JitStreamKernel)(void *payload, size_t start, uint32_t count,
+                                const uint32_t *inputs, uint32_t *outputs);
+
+/**
+ * \brief Evaluate a computation over arrays that do not fit into memory
+ *
+ * This function splits the index range <tt>[0, size)</tt> into chunks of
+ * \c chunk_size elements (<tt>chunk_size == 0</tt> selects a default of 16M)
+ * and processes them one after the other. For each chunk, it creates
+ * variables for the \c input_count inputs, which are either mapped from a file
+ * or filled by a user callback, and then invokes \c kernel to trace the
+ * computation. \c kernel receives the payload, the range of the chunk, the
+ * input variable indices, and must write \c output_count variable indices
+ * (owning references of size \c count or \c 1) to \c outputs.
+ *
+ * Elementwise outputs are written to a file or passed to a sink callback.
+ * Reductions are combined across chunks, and the final value is stored in
+ * <tt>JitStreamOutput::result</tt>.
+ *
+ * Processing is double-buffered: the inputs of chunk <tt>i + 1</tt> are
+ * prepared, and the outputs of chunk <tt>i - 1</tt> are written while the
+ * kernel of chunk \c i runs. The traced computation should be identical for
+ * every chunk so that all but the first chunk can reuse the compiled kernel.
+ * Chunk-dependent values (e.g., \c start) should therefore be passed as
+ * opaque literals.
+ *
+ * Callbacks are invoked without holding the internal lock and may call other
+ * <tt>jit_*</tt> functions. This function is not supported on Windows when
+ * any input or output is file-backed.
+ */
+extern JIT_EXPORT void
+jit_eval_stream(JIT_ENUM JitBackend backend, size_t size, uint32_t chunk_size,
+                uint32_t input_count, const struct JitStreamInput *inputs,
+                uint32_t output_count, struct JitStreamOutput *outputs,
+                JitStreamKernel kernel, void *payload);
+
 // ====================================================================
 //      Functionality for debug output and GraphViz visualizations
 // ====================================================================
@@ -1279,7 +1594,7 @@ extern JIT_EXPORT void jit_prefix_pop(JIT_ENUM JitBackend backend);
  * The default set of flags is:
  *
  * <tt>ConstProp | ValueNumbering | LoopRecord | LoopOptimize |
- * VCallRecord | VCallOptimize | ADOptimize</tt>
+ * VCallRecord | VCallOptimize | ADOptimize | Simplify | HoistUniform</tt>
  */
 #if defined(__cplusplus)
 enum class JitFlag : uint32_t {
@@ -1331,15 +1646,58 @@ enum class JitFlag : uint32_t {
     /// Exploit literal constants during AD (used in the Dr.Jit parent project)
     ADOptimize = 8192,
 
-    /// Perform a intra-warp/SIMD register reduction before issuing global atomics
+    /**
+     * \brief Perform a intra-warp/SIMD register reduction before issuing
+     * global atomics. On the LLVM backend, scatter-reductions into small
+     * arrays are furthermore privatized: every worker thread accumulates into
+     * its own copy, and the copies are merged when the kernel finishes.
+     */
     AtomicReduceLocal = 16384,
 
+    /**
+     * \brief Apply algebraic rewrite rules and strength reduction when
+     * creating variables (see \ref JitRewrite for the list of rules)
+     */
+    Simplify = 32768,
+
+    /**
+     * \brief Permit contracting floating point <tt>a*b + c</tt> into a fused
+     * multiply-add (off by default, since this changes the rounding behavior).
+     * Requires \ref Simplify.
+     *
+     * Contraction takes place when a kernel is generated, and only if the
+     * product has no other users (including variable handles that are still
+     * alive). The flag must therefore be set when the expression is evaluated.
+     */
+    ContractFma = 65536,
+
+    /**
+     * \brief Use a cost model to decide whether expensive intermediate
+     * results that remain referenced after \ref jit_eval() should be stored
+     * instead of being recomputed by later kernels
+     *
+     * A variable is stored when recomputing it for each remaining reference
+     * is estimated to cost more than the memory traffic of storing it once
+     * and loading it for each reference. This assumes that the references
+     * are used by later evaluations, which is why the flag is disabled by
+     * default.
+     */
+    AutoMaterialize = 131072,
+
+    /**
+     * \brief Compute scalar (uniform) arithmetic and inputs once before the
+     * main loop of LLVM kernels instead of leaving this to LLVM's
+     * loop-invariant code motion
+     */
+    HoistUniform = 262144,
+
     /// Default flags
     Default = (uint32_t) ConstProp | (uint32_t) ValueNumbering |
               (uint32_t) LoopRecord | (uint32_t) LoopOptimize |
               (uint32_t) VCallRecord | (uint32_t) VCallDeduplicate |
               (uint32_t) VCallOptimize | (uint32_t) ADOptimize |
-              (uint32_t) AtomicReduceLocal
+              (uint32_t) AtomicReduceLocal | (uint32_t) Simplify |
+              (uint32_t) HoistUniform
 };
 #else
 enum JitFlag {
@@ -1357,7 +1715,11 @@ enum JitFlag {
     JitFlagKernelHistory       = 2048,
     JitFlagLaunchBlocking      = 4096,
     JitFlagADOptimize          = 8192,
-    JitFlagAtomicReduceLocal = 16384
+    JitFlagAtomicReduceLocal = 16384,
+    JitFlagSimplify            = 32768,
+    JitFlagContractFma         = 65536,
+    JitFlagAutoMaterialize     = 131072,
+    JitFlagHoistUniform        = 262144
 };
 #endif
 
@@ -1373,6 +1735,58 @@ extern JIT_EXPORT void jit_set_flag(JIT_ENUM JitFlag flag, int enable);
 /// Checks whether a given flag is active. Returns zero or one.
 extern JIT_EXPORT int jit_flag(JIT_ENUM JitFlag flag);
 
+/// Rewrite rules applied when \ref JitFlag::Simplify is set
+#if defined(__cplusplus)
+enum class JitRewrite : uint32_t {
+    /// Integer division by a literal via multiply-high "magic numbers"
+    DivConst,
+
+    /// Integer modulo by a literal via the rewritten division or a bit mask
+    ModConst,
+
+    /// <tt>x * 2 -> x + x</tt>
+    MulTwo,
+
+    /// <tt>-(-x) -> x</tt>, <tt>~(~x) -> x</tt>
+    DoubleNeg,
+
+    /// <tt>select(c, x, x) -> x</tt>
+    SelectSame,
+
+    /// Comparisons with a known outcome, negated integer comparisons, and
+    /// comparisons of masks against literals
+    CompareFold,
+
+    /// <tt>a*b + c -> fma(a, b, c)</tt>, counted when generating kernels
+    /// (see \ref JitFlag::ContractFma)
+    FmaContract,
+
+    /// Chains of lossless casts and reinterpreting casts
+    CastChain,
+
+    /// Denotes the number of rewrite rules
+    Count
+};
+#else
+enum JitRewrite {
+    JitRewriteDivConst,
+    JitRewriteModConst,
+    JitRewriteMulTwo,
+    JitRewriteDoubleNeg,
+    JitRewriteSelectSame,
+    JitRewriteCompareFold,
+    JitRewriteFmaContract,
+    JitRewriteCastChain,
+    JitRewriteCount
+};
+#endif
+
+/// Return how many times the rewrite rule \c rule has been applied
+extern JIT_EXPORT size_t jit_rewrite_count(JIT_ENUM JitRewrite rule);
+
+/// Reset the counters reported by \ref jit_rewrite_count()
+extern JIT_EXPORT void jit_rewrite_clear_statistics();
+
 // ====================================================================
 //  Advanced JIT usage: recording loops, virtual function calls, etc.
 // ====================================================================
@@ -1535,7 +1949,7 @@ extern JIT_EXPORT uint32_t jit_var_mask_peek(JIT_ENUM JitBackend backend);
 
 /// Return the default mask for a wavefront of the given \c size
 extern JIT_EXPORT uint32_t jit_var_mask_default(JIT_ENUM JitBackend backend,
-                                                uint32_t size);
+                                                size_t size);
 
 /**
  * \brief Combine the given mask 'index' with the mask stack
@@ -1543,7 +1957,7 @@ extern JIT_EXPORT uint32_t jit_var_mask_default(JIT_ENUM JitBackend backend,
  * On the LLVM backend, a default mask will be created when the mask stack is empty.
  * The \c size parameter determines the size of the associated wavefront.
  */
-extern JIT_EXPORT uint32_t jit_var_mask_apply(uint32_t index, uint32_t size);
+extern JIT_EXPORT uint32_t jit_var_mask_apply(uint32_t index, size_t size);
 
 // ====================================================================
 //                          Horizontal reductions
@@ -1570,7 +1984,7 @@ extern JIT_EXPORT uint32_t jit_var_reduce(uint32_t index, JIT_ENUM ReduceOp redu
  * a single int, float, double, etc. (\c isize can be 1, 2, 4, or 8).
  * Runs asynchronously.
  */
-extern JIT_EXPORT void jit_memset_async(JIT_ENUM JitBackend backend, void *ptr, uint32_t size,
+extern JIT_EXPORT void jit_memset_async(JIT_ENUM JitBackend backend, void *ptr, size_t size,
                                         uint32_t isize, const void *src);
 
 /// Perform a synchronous copy operation
@@ -1592,7 +2006,7 @@ extern JIT_EXPORT void jit_memcpy_async(JIT_ENUM JitBackend backend, void *dst,
  */
 extern JIT_EXPORT void jit_reduce(JIT_ENUM JitBackend backend, JIT_ENUM VarType type,
                                   JIT_ENUM ReduceOp rtype,
-                                  const void *in, uint32_t size, void *out);
+                                  const void *in, size_t size, void *out);
 
 /** \brief Compute n prefix sum over the given input array
  *
@@ -1627,7 +2041,7 @@ extern JIT_EXPORT void jit_reduce(JIT_ENUM JitBackend backend, JIT_ENUM VarType
  */
 extern JIT_EXPORT void jit_prefix_sum(JIT_ENUM JitBackend backend,
                                       JIT_ENUM VarType type, int exclusive,
-                                      const void *in, uint32_t size, void *out);
+                                      const void *in, size_t size, void *out);
 
 /**
  * \brief Compress a mask into a list of nonzero indices
@@ -1640,10 +2054,11 @@ extern JIT_EXPORT void jit_prefix_sum(JIT_ENUM JitBackend backend,
  * The internals resemble \ref jit_prefix_sum_u32(), and the CUDA implementation may
  * similarly access regions beyond the end of \c in and \c out.
  *
- * This function internally performs a synchronization step.
+ * This function internally performs a synchronization step. Since the output
+ * consists of 32 bit indices, \c size must be smaller than 2^32.
  */
 extern JIT_EXPORT uint32_t jit_compress(JIT_ENUM JitBackend backend, const uint8_t *in,
-                                        uint32_t size, uint32_t *out);
+                                        size_t size, uint32_t *out);
 
 
 /**
@@ -1673,9 +2088,12 @@ extern JIT_EXPORT uint32_t jit_compress(JIT_ENUM JitBackend backend, const uint8
  * \return
  *     When \c offsets != NULL, the function returns the number of unique
  *     values found in \c values. Otherwise, it returns zero.
+ *
+ * Since the permutation consists of 32 bit indices, \c size must be smaller
+ * than 2^32.
  */
 extern JIT_EXPORT uint32_t jit_mkperm(JIT_ENUM JitBackend backend, const uint32_t *values,
-                                      uint32_t size, uint32_t bucket_count,
+                                      size_t size, uint32_t bucket_count,
                                       uint32_t *perm, uint32_t *offsets);
 
 /// Helper data structure for vector method calls, see \ref jit_var_vcall()
@@ -1734,7 +2152,7 @@ jit_var_vcall_reduce(JIT_ENUM JitBackend backend, const char *domain,
  */
 extern JIT_EXPORT void jit_block_copy(JIT_ENUM JitBackend backend, JIT_ENUM VarType type,
                                       const void *in, void *out,
-                                      uint32_t size, uint32_t block_size);
+                                      size_t size, uint32_t block_size);
 
 /**
  * \brief Sum over elements within blocks
@@ -1746,7 +2164,7 @@ extern JIT_EXPORT void jit_block_copy(JIT_ENUM JitBackend backend, JIT_ENUM VarT
  * and the output array must have space for <tt>size</tt> elements.
  */
 extern JIT_EXPORT void jit_block_sum(JIT_ENUM JitBackend backend, JIT_ENUM VarType type,
-                                     const void *in, void *out, uint32_t size,
+                                     const void *in, void *out, size_t size,
                                      uint32_t block_size);
 /**
  * \brief Insert a function call to a ray tracing functor into the LLVM program
@@ -1838,7 +2256,7 @@ struct KernelHistoryEntry {
     int cache_disk;
 
     /// Launch width / number of array entries that were processed
-    uint32_t size;
+    uint64_t size;
 
     /// Number of input arrays
     uint32_t input_count;
@@ -18,6 +18,8 @@
 #include "op.h"
 #include "vcall.h"
 #include "loop.h"
+#include "numa.h"
+#include "stream.h"
 #include <thread>
 #include <condition_variable>
 #include <drjit-core/texture.h>
@@ -169,6 +171,16 @@ int jit_flag(JitFlag flag) {
     return (jitc_flags() & (uint32_t) flag) ? 1 : 0;
 }
 
+size_t jit_rewrite_count(JitRewrite rule) {
+    lock_guard guard(state.lock);
+    return jitc_rewrite_count(rule);
+}
+
+void jit_rewrite_clear_statistics() {
+    lock_guard guard(state.lock);
+    jitc_rewrite_clear_statistics();
+}
+
 uint32_t jit_record_checkpoint(JitBackend backend) {
     lock_guard guard(state.lock);
     uint32_t result =
@@ -274,6 +286,73 @@ void jit_llvm_set_thread_count(uint32_t size) {
     pool_set_size(nullptr, size);
 }
 
+uint32_t jit_llvm_thread_count() {
+    return pool_size(nullptr);
+}
+
+void jit_llvm_set_numa_mode(NUMAMode mode) {
+    lock_guard guard(state.lock);
+    jitc_numa_set_mode(mode);
+}
+
+NUMAMode jit_llvm_numa_mode() {
+    lock_guard guard(state.lock);
+    return jitc_numa_mode;
+}
+
+uint32_t jit_llvm_numa_node_count() {
+    lock_guard guard(state.lock);
+    return jitc_numa_node_count();
+}
+
+void jit_llvm_set_prefetch(int enable, uint32_t distance) {
+    lock_guard guard(state.lock);
+    state.llvm_prefetch = enable != 0;
+    state.llvm_prefetch_distance = distance;
+}
+
+int jit_llvm_prefetch(uint32_t *distance) {
+    lock_guard guard(state.lock);
+    if (distance)
+        *distance = state.llvm_prefetch_distance;
+    return (int) state.llvm_prefetch;
+}
+
+void jit_llvm_set_vcall_coherence(float threshold) {
+    lock_guard guard(state.lock);
+    state.llvm_vcall_coherence = threshold;
+}
+
+float jit_llvm_vcall_coherence() {
+    lock_guard guard(state.lock);
+    return state.llvm_vcall_coherence;
+}
+
+void jit_llvm_set_kernel_width(uint32_t width, int autotune) {
+    lock_guard guard(state.lock);
+    jitc_llvm_set_kernel_width(width, autotune != 0);
+}
+
+uint32_t jit_llvm_kernel_width(int *autotune) {
+    lock_guard guard(state.lock);
+    if (autotune)
+        *autotune = (int) state.llvm_autotune;
+    return state.llvm_kernel_width;
+}
+
+void jit_llvm_set_unroll(uint32_t packets) {
+    lock_guard guard(state.lock);
+    if (packets < 1 || packets > 4)
+        jitc_raise("jit_llvm_set_unroll(): the number of packets per loop "
+                   "iteration must be between 1 and 4, got %u!", packets);
+    state.llvm_unroll = packets;
+}
+
+uint32_t jit_llvm_unroll() {
+    lock_guard guard(state.lock);
+    return state.llvm_unroll;
+}
+
 void jit_llvm_set_target(const char *target_cpu,
                          const char *target_features,
                          uint32_t vector_width) {
@@ -401,6 +480,13 @@ uint32_t jit_var_scatter(uint32_t target, uint32_t value,
     return jitc_var_scatter(target, value, index, mask, reduce_op);
 }
 
+uint32_t jit_var_scatter_unique(uint32_t target, uint32_t value,
+                                uint32_t index, uint32_t mask,
+                                ReduceOp reduce_op) {
+    lock_guard guard(state.lock);
+    return jitc_var_scatter(target, value, index, mask, reduce_op, true);
+}
+
 void jit_var_scatter_reduce_kahan(uint32_t *target_1, uint32_t *target_2,
                                   uint32_t value, uint32_t index, uint32_t mask) {
     lock_guard guard(state.lock);
@@ -436,7 +522,7 @@ int jit_var_exists(uint32_t index) {
     if (index == 0)
         return 0;
     lock_guard guard(state.lock);
-    return state.variables.find(index) != state.variables.end();
+    return state.variables.find(index) != nullptr;
 }
 
 uint32_t jit_var_ref(uint32_t index) {
@@ -544,6 +630,19 @@ uint32_t jit_var_mem_copy(JitBackend backend, AllocType atype, VarType vtype,
     return jitc_var_mem_copy(backend, atype, vtype, value, size);
 }
 
+uint32_t jit_var_mem_map_file(JitBackend backend, VarType vtype,
+                              const char *filename, size_t offset,
+                              size_t size, int shared) {
+    lock_guard guard(state.lock);
+    return jitc_var_mem_map_file(backend, vtype, filename, offset, size,
+                                 shared);
+}
+
+void jit_var_write_file(uint32_t index, const char *filename) {
+    lock_guard guard(state.lock);
+    jitc_var_write_file(index, filename);
+}
+
 uint32_t jit_var_copy(uint32_t index) {
     lock_guard guard(state.lock);
     return jitc_var_copy(index);
@@ -564,7 +663,7 @@ uint32_t jit_var_mask_peek(JitBackend backend) {
     return jitc_var_mask_peek(backend);
 }
 
-uint32_t jit_var_mask_apply(uint32_t index, uint32_t size) {
+uint32_t jit_var_mask_apply(uint32_t index, size_t size) {
     lock_guard guard(state.lock);
     return jitc_var_mask_apply(index, size);
 }
@@ -579,7 +678,7 @@ void jit_var_mask_pop(JitBackend backend) {
     jitc_var_mask_pop(backend);
 }
 
-uint32_t jit_var_mask_default(JitBackend backend, uint32_t size) {
+uint32_t jit_var_mask_default(JitBackend backend, size_t size) {
     lock_guard guard(state.lock);
     return jitc_var_mask_default(backend, size);
 }
@@ -636,6 +735,29 @@ void jit_eval() {
     jitc_eval(thread_state_llvm);
 }
 
+void jit_set_kernel_split_threshold(uint32_t max_ops, uint32_t max_live) {
+    lock_guard guard(state.lock);
+    state.kernel_split_ops = max_ops;
+    state.kernel_split_live = max_live;
+}
+
+void jit_kernel_split_threshold(uint32_t *max_ops, uint32_t *max_live) {
+    lock_guard guard(state.lock);
+    if (max_ops)
+        *max_ops = state.kernel_split_ops;
+    if (max_live)
+        *max_live = state.kernel_split_live;
+}
+
+void jit_eval_stream(JitBackend backend, size_t size, uint32_t chunk_size,
+                     uint32_t input_count, const JitStreamInput *inputs,
+                     uint32_t output_count, JitStreamOutput *outputs,
+                     JitStreamKernel kernel, void *payload) {
+    lock_guard guard(state.lock);
+    jitc_eval_stream(backend, size, chunk_size, input_count, inputs,
+                     output_count, outputs, kernel, payload);
+}
+
 int jit_var_eval(uint32_t index) {
     if (index == 0)
         return 0;
@@ -660,7 +782,7 @@ void jit_prefix_pop(JitBackend backend) {
     jitc_prefix_pop(backend);
 }
 
-void jit_memset_async(JitBackend backend, void *ptr, uint32_t size, uint32_t isize,
+void jit_memset_async(JitBackend backend, void *ptr, size_t size, uint32_t isize,
                       const void *src) {
     lock_guard guard(state.lock);
     jitc_memset_async(backend, ptr, size, isize, src);
@@ -677,36 +799,36 @@ void jit_memcpy_async(JitBackend backend, void *dst, const void *src, size_t siz
 }
 
 void jit_reduce(JitBackend backend, VarType type, ReduceOp rtype, const void *ptr,
-                uint32_t size, void *out) {
+                size_t size, void *out) {
     lock_guard guard(state.lock);
     jitc_reduce(backend, type, rtype, ptr, size, out);
 }
 
 void jit_prefix_sum(JitBackend backend, VarType type, int exclusive, const void *in,
-              uint32_t size, void *out) {
+              size_t size, void *out) {
     lock_guard guard(state.lock);
     jitc_prefix_sum(backend, type, exclusive != 0, in, size, out);
 }
 
-uint32_t jit_compress(JitBackend backend, const uint8_t *in, uint32_t size, uint32_t *out) {
+uint32_t jit_compress(JitBackend backend, const uint8_t *in, size_t size, uint32_t *out) {
     lock_guard guard(state.lock);
     return jitc_compress(backend, in, size, out);
 }
 
-uint32_t jit_mkperm(JitBackend backend, const uint32_t *values, uint32_t size,
+uint32_t jit_mkperm(JitBackend backend, const uint32_t *values, size_t size,
                     uint32_t bucket_count, uint32_t *perm, uint32_t *offsets) {
     lock_guard guard(state.lock);
     return jitc_mkperm(backend, values, size, bucket_count, perm, offsets);
 }
 
 void jit_block_copy(JitBackend backend, enum VarType type, const void *in, void *out,
-                    uint32_t size, uint32_t block_size) {
+                    size_t size, uint32_t block_size) {
     lock_guard guard(state.lock);
     jitc_block_copy(backend, type, in, out, size, block_size);
 }
 
 void jit_block_sum(JitBackend backend, enum VarType type, const void *in, void *out,
-                   uint32_t size, uint32_t block_size) {
+                   size_t size, uint32_t block_size) {
     lock_guard guard(state.lock);
     jitc_block_sum(backend, type, in, out, size, block_size);
 }
@@ -49,7 +49,6 @@
     } while (0);
 
 // Forward declarations
-static void jitc_cuda_render_stmt(uint32_t index, const Variable *v);
 static void jitc_cuda_render_var(uint32_t index, const Variable *v);
 static void jitc_cuda_render_scatter(const Variable *v, const Variable *ptr,
                                      const Variable *value, const Variable *index,
@@ -158,8 +157,8 @@ void jitc_cuda_assemble(ThreadState *ts, ScheduledGroup group,
     for (uint32_t gi = group.start; gi != group.end; ++gi) {
         uint32_t index = schedule[gi].index;
         const Variable *v = jitc_var(index);
-        const uint32_t vti = v->type,
-                       size = v->size;
+        const uint32_t vti = v->type;
+        const uint64_t size = v->size;
         const VarType vt = (VarType) vti;
         bool assemble = false;
 
@@ -182,7 +181,7 @@ void jitc_cuda_assemble(ThreadState *ts, ScheduledGroup group,
             }
         }
 
-        if (likely(v->param_type == ParamType::Input)) {
+        if (likely(v->cold().param_type == ParamType::Input)) {
             if (v->is_literal()) {
                 fmt("    ld.$s.u64 $v, [$s+$o];\n", params_type, v, params_base, v);
                 continue;
@@ -202,13 +201,11 @@ void jitc_cuda_assemble(ThreadState *ts, ScheduledGroup group,
                     size > 1 ? "ld.global.cs.u8" : "ldu.global.u8", v);
             }
             continue;
-        } else if (!v->is_stmt()) {
-            jitc_cuda_render_var(index, v);
         } else if (likely(!assemble)) {
-            jitc_cuda_render_stmt(index, v);
+            jitc_cuda_render_var(index, v);
         }
 
-        if (v->param_type == ParamType::Output) {
+        if (v->cold().param_type == ParamType::Output) {
             fmt("    ld.$s.u64 %rd0, [$s+$o];\n"
                 "    mad.wide.u32 %rd0, %r0, $a, %rd0;\n",
                 params_type, params_base, v, v);
@@ -367,10 +364,8 @@ void jitc_cuda_assemble_func(const char *name, uint32_t inst_id,
                     it->second - data_offset, v);
         } else if (v->is_literal()) {
             fmt("    mov.$b $v, $l;\n", v, v, v);
-        } else if (v->is_node()) {
-            jitc_cuda_render_var(sv.index, v);
         } else {
-            jitc_cuda_render_stmt(sv.index, v);
+            jitc_cuda_render_var(sv.index, v);
         }
     }
 
@@ -438,10 +433,20 @@ static void jitc_cuda_render_var(uint32_t index, const Variable *v) {
             fmt("    abs.$t $v, $v;\n", v, v, a0);
             break;
 
-        case VarKind::Add:
-            fmt(jitc_is_single(v) ? "    add.ftz.$t $v, $v, $v;\n"
-                                  : "    add.$t $v, $v, $v;\n",
-                v, v, a0, a1);
+        case VarKind::Add: {
+                const Variable *other, *m = jitc_fma_contract(v, a0, a1, other);
+                if (!m) {
+                    fmt(jitc_is_single(v) ? "    add.ftz.$t $v, $v, $v;\n"
+                                          : "    add.$t $v, $v, $v;\n",
+                        v, v, a0, a1);
+                    break;
+                }
+
+                // The product itself becomes dead code
+                fmt(jitc_is_single(v) ? "    fma.rn.ftz.$t $v, $v, $v, $v;\n"
+                                      : "    fma.rn.$t $v, $v, $v, $v;\n",
+                    v, v, jitc_var(m->dep[0]), jitc_var(m->dep[1]), other);
+            }
             break;
 
         case VarKind::Sub:
@@ -688,7 +693,7 @@ static void jitc_cuda_render_var(uint32_t index, const Variable *v) {
                 bool is_bool = v->type == (uint32_t) VarType::Bool;
 
                 if (!unmasked)
-                    fmt("    @!$v bra l_$u_masked;\n", a2, v->reg_index);
+                    fmt("    @!$v bra l_$u_masked;\n", a2, v->cold().reg_index);
 
                 if (index_zero) {
                     fmt("    mov.u64 %rd3, $v;\n", a0);
@@ -711,8 +716,8 @@ static void jitc_cuda_render_var(uint32_t index, const Variable *v) {
                     fmt("    bra.uni l_$u_done;\n\n"
                         "l_$u_masked:\n"
                         "    mov.$b $v, 0;\n\n"
-                        "l_$u_done:\n", v->reg_index,
-                        v->reg_index, v, v, v->reg_index);
+                        "l_$u_done:\n", v->cold().reg_index,
+                        v->cold().reg_index, v, v, v->cold().reg_index);
             }
             break;
 
@@ -739,8 +744,8 @@ static void jitc_cuda_render_var(uint32_t index, const Variable *v) {
 
         case VarKind::Dispatch:
             jitc_var_vcall_assemble((VCall *) state.extra[index].callback_data,
-                                    a0->reg_index, a1->reg_index, a2->reg_index,
-                                    a3 ? a3->reg_index : 0);
+                                    a0->cold().reg_index, a1->cold().reg_index, a2->cold().reg_index,
+                                    a3 ? a3->cold().reg_index : 0);
             break;
 
         case VarKind::TexLookup:
@@ -772,6 +777,15 @@ static void jitc_cuda_render_var(uint32_t index, const Variable *v) {
             fmt("    mov.$b $v, $v_out_$u;\n", v, v, a0, (uint32_t) v->literal);
             break;
 
+        case VarKind::Copy:
+            fmt("    mov.$t $v, $v;\n", v, v, a0);
+            break;
+
+        case VarKind::LoopStart:
+        case VarKind::LoopCond:
+        case VarKind::LoopEnd:
+            break; // Code is generated by the loop's 'Extra::assemble' hook
+
         default:
             jitc_fail("jitc_cuda_render_var(): unhandled variable kind \"%s\"!",
                       var_kind_name[(uint32_t) v->kind]);
@@ -788,7 +802,7 @@ static void jitc_cuda_render_scatter(const Variable *v,
     bool is_bool = value->type == (uint32_t) VarType::Bool;
 
     if (!unmasked)
-        fmt("    @!$v bra l_$u_done;\n", mask, v->reg_index);
+        fmt("    @!$v bra l_$u_done;\n", mask, v->cold().reg_index);
 
     if (index_zero) {
         fmt("    mov.u64 %rd3, $v;\n", ptr);
@@ -898,7 +912,7 @@ static void jitc_cuda_render_scatter(const Variable *v,
     }
 
     if (!unmasked)
-        fmt("\nl_$u_done:\n", v->reg_index);
+        fmt("\nl_$u_done:\n", v->cold().reg_index);
 }
 
 static void jitc_cuda_render_scatter_kahan(const Variable *v, uint32_t v_index) {
@@ -913,7 +927,7 @@ static void jitc_cuda_render_scatter_kahan(const Variable *v, uint32_t v_index)
     bool unmasked = mask->is_literal() && mask->literal == 1;
 
     if (!unmasked)
-        fmt("    @!$v bra l_$u_done;\n", mask, v->reg_index);
+        fmt("    @!$v bra l_$u_done;\n", mask, v->cold().reg_index);
 
     fmt("    mad.wide.$t %rd2, $v, $a, $v;\n"
         "    mad.wide.$t %rd3, $v, $a, $v;\n",
@@ -956,7 +970,7 @@ static void jitc_cuda_render_scatter_kahan(const Variable *v, uint32_t v_index)
         value);
 
     if (!unmasked)
-        fmt("\nl_$u_done:\n", v->reg_index);
+        fmt("\nl_$u_done:\n", v->cold().reg_index);
 }
 
 static void jitc_cuda_render_printf(uint32_t index, const Variable *v,
@@ -1082,7 +1096,7 @@ static void jitc_cuda_render_trace(uint32_t index, const Variable *v,
 
     bool masked = !valid->is_literal() || valid->literal != 1;
     if (masked)
-        fmt("    @!$v bra l_masked_$u;\n", valid, v->reg_index);
+        fmt("    @!$v bra l_masked_$u;\n", valid, v->cold().reg_index);
 
     fmt("    .reg.u32 $v_payload_type, $v_payload_count;\n"
         "    mov.u32 $v_payload_type, 0;\n"
@@ -1108,62 +1122,10 @@ static void jitc_cuda_render_trace(uint32_t index, const Variable *v,
     put(");\n");
 
     if (masked)
-        fmt("\nl_masked_$u:\n", v->reg_index);
+        fmt("\nl_masked_$u:\n", v->cold().reg_index);
 }
 #endif
 
-/// Convert an IR template with '$' expressions into valid IR
-static void jitc_cuda_render_stmt(uint32_t index, const Variable *v) {
-    const char *s = v->stmt;
-    if (unlikely(*s == '\0'))
-        return;
-    put("    ");
-    char c;
-    do {
-        const char *start = s;
-        while (c = *s, c != '\0' && c != '$')
-            s++;
-        put(start, s - start);
-
-        if (c == '$') {
-            s++;
-            const char **prefix_table = nullptr, type = *s++;
-            switch (type) {
-                case 'n': put(";\n    "); continue;
-                case 't': prefix_table = type_name_ptx; break;
-                case 'b': prefix_table = type_name_ptx_bin; break;
-                case 's': prefix_table = type_size_str; break;
-                case 'r': prefix_table = type_prefix; break;
-                default:
-                    jitc_fail("jit_cuda_render_stmt(): encountered invalid \"$\" "
-                              "expression (unknown type \"%c\") in \"%s\"!", type, v->stmt);
-            }
-
-            uint32_t arg_id = *s++ - '0';
-            if (unlikely(arg_id > 4))
-                jitc_fail("jit_cuda_render_stmt(%s): encountered invalid \"$\" "
-                          "expression (argument out of bounds)!", v->stmt);
-
-            uint32_t dep_id = arg_id == 0 ? index : v->dep[arg_id - 1];
-            if (unlikely(dep_id == 0))
-                jitc_fail("jit_cuda_render_stmt(%s): encountered invalid \"$\" "
-                          "expression (referenced variable %u is missing)!", v->stmt, arg_id);
-
-            const Variable *dep = jitc_var(dep_id);
-            const char *prefix = prefix_table[(int) dep->type];
-            put(prefix, strlen(prefix));
-
-            if (type == 'r') {
-                buffer.put_u32(dep->reg_index);
-                if (unlikely(dep->reg_index == 0))
-                    jitc_fail("jitc_cuda_render_stmt(): variable has no register index!");
-            }
-        }
-    } while (c != '\0');
-
-    put(";\n");
-}
-
 /// Virtual function call code generation -- CUDA/PTX-specific bits
 void jitc_var_vcall_assemble_cuda(VCall *vcall, uint32_t vcall_reg,
                                   uint32_t self_reg, uint32_t mask_reg,
@@ -1220,16 +1182,15 @@ void jitc_var_vcall_assemble_cuda(VCall *vcall, uint32_t vcall_reg,
 
     // Special handling for predicates
     for (uint32_t in : vcall->in) {
-        auto it = state.variables.find(in);
-        if (it == state.variables.end())
+        const Variable *v2 = state.variables.find(in);
+        if (!v2)
             continue;
-        const Variable *v2 = &it->second;
 
         if ((VarType) v2->type != VarType::Bool)
             continue;
 
         fmt("        selp.u16 %w$u, 1, 0, %p$u;\n",
-            v2->reg_index, v2->reg_index);
+            v2->cold().reg_index, v2->cold().reg_index);
     }
 
     put("        {\n");
@@ -1265,10 +1226,9 @@ void jitc_var_vcall_assemble_cuda(VCall *vcall, uint32_t vcall_reg,
 
     uint32_t offset = 0;
     for (uint32_t in : vcall->in) {
-        auto it = state.variables.find(in);
-        if (it == state.variables.end())
+        const Variable *v2 = state.variables.find(in);
+        if (!v2)
             continue;
-        const Variable *v2 = &it->second;
         uint32_t size = type_size[v2->type];
 
         const char *tname = type_name_ptx[v2->type],
@@ -1281,7 +1241,7 @@ void jitc_var_vcall_assemble_cuda(VCall *vcall, uint32_t vcall_reg,
         }
 
         fmt("            st.param.$s [in+$u], $s$u;\n", tname, offset, prefix,
-            v2->reg_index);
+            v2->cold().reg_index);
 
         offset += size;
     }
@@ -1305,20 +1265,18 @@ void jitc_var_vcall_assemble_cuda(VCall *vcall, uint32_t vcall_reg,
     for (uint32_t i = 0; i < n_out; ++i) {
         uint32_t index = vcall->out_nested[i],
                  index_2 = vcall->out[i];
-        auto it = state.variables.find(index);
-        if (it == state.variables.end())
+        const Variable *v = state.variables.find(index);
+        if (!v)
             continue;
-        uint32_t size = type_size[it->second.type],
+        uint32_t size = type_size[v->type],
                  load_offset = offset;
         offset += size;
 
         // Skip if expired
-        auto it2 = state.variables.find(index_2);
-        if (it2 == state.variables.end())
+        const Variable *v2 = state.variables.find(index_2);
+        if (!v2)
             continue;
-
-        const Variable *v2 = &it2.value();
-        if (v2->reg_index == 0 || v2->param_type == ParamType::Input)
+        if (v2->cold().reg_index == 0 || v2->cold().param_type == ParamType::Input)
             continue;
 
         const char *tname = type_name_ptx[v2->type],
@@ -1331,7 +1289,7 @@ void jitc_var_vcall_assemble_cuda(VCall *vcall, uint32_t vcall_reg,
         }
 
         fmt("            ld.param.$s $s$u, [out+$u];\n",
-            tname, prefix, v2->reg_index, load_offset);
+            tname, prefix, v2->cold().reg_index, load_offset);
     }
 
     put("        }\n\n");
@@ -1341,18 +1299,17 @@ void jitc_var_vcall_assemble_cuda(VCall *vcall, uint32_t vcall_reg,
     // =====================================================
 
     for (uint32_t out : vcall->out) {
-        auto it = state.variables.find(out);
-        if (it == state.variables.end())
+        const Variable *v2 = state.variables.find(out);
+        if (!v2)
             continue;
-        const Variable *v2 = &it->second;
         if ((VarType) v2->type != VarType::Bool)
             continue;
-        if (v2->reg_index == 0 || v2->param_type == ParamType::Input)
+        if (v2->cold().reg_index == 0 || v2->cold().param_type == ParamType::Input)
             continue;
 
         // Special handling for predicates
         fmt("        setp.ne.u16 %p$u, %w$u, 0;\n",
-            v2->reg_index, v2->reg_index);
+            v2->cold().reg_index, v2->cold().reg_index);
     }
 
 
@@ -1365,11 +1322,10 @@ void jitc_var_vcall_assemble_cuda(VCall *vcall, uint32_t vcall_reg,
 
     fmt("\nl_masked_$u:\n", vcall_reg);
     for (uint32_t out : vcall->out) {
-        auto it = state.variables.find(out);
-        if (it == state.variables.end())
+        const Variable *v2 = state.variables.find(out);
+        if (!v2)
             continue;
-        const Variable *v2 = &it->second;
-        if (v2->reg_index == 0 || v2->param_type == ParamType::Input)
+        if (v2->cold().reg_index == 0 || v2->cold().param_type == ParamType::Input)
             continue;
 
         fmt("    mov.$b $v, 0;\n", v2, v2);
@@ -466,7 +466,7 @@ void jitc_cuda_tex_memcpy_t2d(size_t ndim, const size_t *shape,
 
 Variable jitc_cuda_tex_check(size_t ndim, const uint32_t *pos) {
     // Validate input types, determine size of the operation
-    uint32_t size = 0;
+    uint64_t size = 0;
     bool dirty = false, placeholder = false;
     JitBackend backend = JitBackend::Invalid;
 
@@ -493,7 +493,7 @@ Variable jitc_cuda_tex_check(size_t ndim, const uint32_t *pos) {
     }
 
     if (dirty) {
-        jitc_eval(thread_state(backend));
+        jitc_eval_dirty(thread_state(backend), pos, ndim);
         for (size_t i = 0; i < ndim; ++i) {
             if (jitc_var(pos[i])->is_dirty())
                 jitc_fail("jit_cuda_tex_check(): operand r%u remains dirty "
@@ -15,7 +15,8 @@
 #include "util.h"
 #include "optix.h"
 #include "loop.h"
-#include <tsl/robin_set.h>
+#include "numa.h"
+#include <atomic>
 
 // ====================================================================
 //  The following data structures are temporarily used during program
@@ -29,8 +30,58 @@ std::vector<ScheduledVariable> schedule;
 /// Groups of variables with the same size
 std::vector<ScheduledGroup> schedule_groups;
 
-/// Auxiliary data structure needed to compute 'schedule_sizes' and 'schedule'
-static tsl::robin_set<std::pair<uint32_t, uint32_t>, pair_hash> visited;
+/// Privatized scatter-reductions of the last assembled kernel
+std::vector<PrivateScatter> private_scatters;
+
+/// Coherent dispatch settings of the last assembled kernel
+CoherentDispatch coherent_dispatch;
+
+/// Stack frame of the (non-recursive) graph traversal in jitc_var_traverse()
+struct TraverseFrame {
+    uint32_t index;
+    /// Next dependency to visit (0-3: 'Variable::dep', 4+: 'Extra::dep')
+    uint32_t next;
+    const uint32_t *extra_dep;
+    uint32_t extra_n_dep;
+};
+
+/// Auxiliary data structures needed to compute 'schedule'
+static std::vector<TraverseFrame> traverse_stack;
+static std::vector<std::pair<uint64_t, uint32_t>> traverse_roots;
+
+/// Variables marked with 'traverse_epoch' were visited by the current traversal
+static uint32_t traverse_epoch = 0;
+
+/// Variables marked with an earlier epoch have not been visited by any
+/// traversal of the current jitc_eval()/jitc_assemble_func() call
+static uint32_t traverse_epoch_base = 0;
+
+/// Estimated cost of operations that are never worth recomputing (vcalls, ray
+/// tracing). The unit is roughly one arithmetic instruction.
+#define DRJIT_MATERIALIZE_COST 32
+
+/// Estimated cost of loading or storing one element of an evaluated array
+#define DRJIT_MEMORY_COST 4
+
+/// Per-variable information collected by jitc_eval_materialize()
+struct MaterializeInfo {
+    /// Number of references from other variables in the schedule
+    uint32_t refs = 0;
+    /// Marks variables that were already counted by jitc_materialize_cost()
+    uint32_t visited = 0;
+};
+
+static tsl::robin_map<uint32_t, MaterializeInfo> materialize_info;
+static std::vector<uint32_t> materialize_stack;
+static uint32_t materialize_epoch = 0;
+
+/// Auxiliary data structures used by jitc_eval_split()
+static std::vector<ScheduledVariable> split_schedule;
+static std::vector<ScheduledGroup> split_groups;
+static tsl::robin_map<uint32_t, uint32_t, UInt32Hasher> split_pos;
+static std::vector<uint32_t> split_last_use, split_mark, split_cuts;
+static std::vector<uint8_t> split_class;
+static std::vector<int32_t> split_cost, split_bad, split_live;
 
 /// Kernel parameter buffer and device copy
 static std::vector<void *> kernel_params;
@@ -46,6 +97,13 @@ StringBuffer globals { 1000 };
 /// Temporary scratch space for scheduled tasks (LLVM only)
 static std::vector<Task *> scheduled_tasks;
 
+/// Parameters of small kernels that are launched by a single task (LLVM only)
+static std::vector<void *> batch_params;
+static std::vector<uint32_t> batch_offsets;
+
+/// Private copies of scatter-reduction targets, released at the end of jitc_eval()
+static std::vector<void *> private_buffers;
+
 /// Hash code of the last generated kernel
 XXH128_hash_t kernel_hash { 0, 0 };
 
@@ -59,8 +117,8 @@ static uint32_t n_ops_total = 0;
 bool uses_optix = false;
 
 /// Size and alignment of auxiliary buffer needed by virtual function calls
-int32_t alloca_size = -1;
-int32_t alloca_align = -1;
+thread_local int32_t alloca_size = -1;
+thread_local int32_t alloca_align = -1;
 
 /// Number of tentative callables that were assembled in the kernel being compiled
 uint32_t callable_count = 0;
@@ -74,20 +132,55 @@ uint32_t callable_depth = 0;
 /// Information about the kernel launch to go in the kernel launch history
 KernelHistoryEntry kernel_history_entry;
 
+/// Only autotune the vector width of LLVM kernels with at least this many elements
+#define DRJIT_AUTOTUNE_MIN_SIZE (4 * DRJIT_POOL_BLOCK_SIZE)
+
+/// Number of timed launches per vector width before the autotuner decides
+#define DRJIT_AUTOTUNE_SAMPLES 3
+
+/// Vector width measurements of LLVM kernels with a given structure
+struct WidthAutotune {
+    /// Candidate widths (the default, and half of it)
+    uint32_t width[2] { 0, 0 };
+    /// Number of timed launches per candidate
+    uint32_t samples[2] { 0, 0 };
+    /// Best time per element (in microseconds) per candidate
+    float time[2] { 0.f, 0.f };
+    /// Selected width (0: still measuring)
+    uint32_t selected = 0;
+};
+
+static std::map<XXH128_hash_t, WidthAutotune, XXH128Cmp> width_autotune;
+
+/// Kernel structure signature used to look up 'width_autotune'
+static std::vector<uint32_t> width_autotune_key;
+
+/// Measurement to be taken by the next jitc_run() call (if any)
+static WidthAutotune *width_autotune_pending = nullptr;
+static uint32_t width_autotune_variant = 0;
+
+/// Vector width of the last assembled LLVM kernel
+static uint32_t kernel_width = 0;
+
 // ====================================================================
 
-/// Recursively traverse the computation graph to find variables needed by a computation
-static void jitc_var_traverse(uint32_t size, uint32_t index) {
-    if (!visited.emplace(size, index).second)
-        return;
+/// Mark a variable as visited, returns 'false' if this already happened before
+static bool jitc_var_visit(Variable *v) {
+    VariableCold &vc = v->cold();
+    if (vc.visit_epoch == traverse_epoch)
+        return false;
 
-    Variable *v = jitc_var(index);
-    for (int i = 0; i < 4; ++i) {
-        uint32_t index2 = v->dep[i];
-        if (index2 == 0)
-            break;
-        jitc_var_traverse(size, index2);
-    }
+    // If we're really visiting this variable the first time, no matter its size
+    if (vc.visit_epoch < traverse_epoch_base)
+        vc.output_flag = false;
+
+    vc.visit_epoch = traverse_epoch;
+    return true;
+}
+
+/// Push a newly visited variable onto the traversal stack
+static void jitc_var_traverse_push(uint32_t index, const Variable *v) {
+    TraverseFrame frame { index, 0, nullptr, 0 };
 
     if (unlikely(v->extra)) {
         auto it = state.extra.find(index);
@@ -95,19 +188,164 @@ static void jitc_var_traverse(uint32_t size, uint32_t index) {
             jitc_fail("jit_var_traverse(): could not find matching 'extra' record!");
 
         const Extra &extra = it->second;
-        for (uint32_t i = 0; i < extra.n_dep; ++i) {
-            uint32_t index2 = extra.dep[i];
-            if (index2 == 0)
-                continue;
-            jitc_var_traverse(size, index2);
+        frame.extra_dep = extra.dep;
+        frame.extra_n_dep = extra.n_dep;
+    }
+
+    traverse_stack.push_back(frame);
+}
+
+/**
+ * \brief Traverse the computation graph to find variables needed by a
+ * computation, and append them to 'schedule' in post-order.
+ *
+ * Uses an explicit stack so that long dependency chains cannot overflow the
+ * call stack. Variables already visited in the current epoch are skipped.
+ */
+static void jitc_var_traverse(uint64_t size, uint32_t index) {
+    Variable *v = jitc_var(index);
+    if (!jitc_var_visit(v))
+        return;
+
+    jitc_var_traverse_push(index, v);
+
+    while (!traverse_stack.empty()) {
+        TraverseFrame &frame = traverse_stack.back();
+        v = jitc_var(frame.index);
+
+        uint32_t index_2 = 0;
+        while (!index_2) {
+            uint32_t next = frame.next;
+            if (next < 4) {
+                index_2 = v->dep[next];
+                // Dependencies are packed, stop at the first empty entry
+                frame.next = index_2 ? next + 1 : 4;
+            } else if (next - 4 < frame.extra_n_dep) {
+                index_2 = frame.extra_dep[next - 4];
+                frame.next = next + 1;
+            } else {
+                break;
+            }
+
+            if (index_2) {
+                Variable *v2 = jitc_var(index_2);
+                if (jitc_var_visit(v2)) {
+                    jitc_var_traverse_push(index_2, v2); // invalidates 'frame'
+                    break;
+                }
+                index_2 = 0;
+            }
         }
+
+        if (index_2)
+            continue;
+
+        // All dependencies were visited, emit the variable
+        schedule.emplace_back(size, v->scope, traverse_stack.back().index);
+        traverse_stack.pop_back();
     }
+}
 
-    // If we're really visiting this variable the first time, no matter its size
-    if (visited.emplace(0, index).second)
-        v->output_flag = false;
+const Variable *jitc_fma_contract(const Variable *v, const Variable *a0,
+                                  const Variable *a1, const Variable *&other) {
+    uint32_t flags = jitc_flags();
+    if (!jitc_is_float(v) || !(flags & (uint32_t) JitFlag::Simplify) ||
+        !(flags & (uint32_t) JitFlag::ContractFma))
+        return nullptr;
+
+    for (int i = 0; i < 2; ++i) {
+        const Variable *m = i == 0 ? a0 : a1;
+        if ((VarKind) m->kind != VarKind::Mul || m->ref_count != 1 ||
+            m->cold().output_flag)
+            continue;
 
-    schedule.emplace_back(size, v->scope, index);
+        other = i == 0 ? a1 : a0;
+        state.rewrite_count[(int) JitRewrite::FmaContract].fetch_add(
+            1, std::memory_order_relaxed);
+        return m;
+    }
+
+    return nullptr;
+}
+
+void jitc_llvm_set_kernel_width(uint32_t width, bool autotune) {
+    if (width != 0 && (width < 4 || (width & (width - 1)) != 0 ||
+                       width > jitc_llvm_vector_width))
+        jitc_raise("jit_llvm_set_kernel_width(): the vector width must be a "
+                   "power of two between 4 and the width of the target (%u), "
+                   "got %u!", jitc_llvm_vector_width, width);
+
+    state.llvm_kernel_width = width;
+    state.llvm_autotune = autotune;
+
+    // Previous measurements refer to other candidate widths
+    width_autotune.clear();
+    width_autotune_pending = nullptr;
+}
+
+/**
+ * Choose the vector width of an LLVM kernel. When autotuning, this looks up
+ * the measurements of previous kernels with the same structure (the kernel
+ * hash is not yet known at this point) and, if no decision was made yet,
+ * requests that jitc_run() times the launch.
+ */
+static uint32_t jitc_llvm_kernel_width(ScheduledGroup group) {
+    uint32_t target = jitc_llvm_vector_width,
+             width = state.llvm_kernel_width ? state.llvm_kernel_width : target;
+    width = std::min(width, target);
+
+    width_autotune_pending = nullptr;
+    if (!state.llvm_autotune || width < 8 ||
+        group.size < DRJIT_AUTOTUNE_MIN_SIZE || coherent_dispatch.perm_slot)
+        return width;
+
+    width_autotune_key.clear();
+    width_autotune_key.push_back(width);
+    for (uint32_t i = group.start; i != group.end; ++i) {
+        const Variable *v = jitc_var(schedule[i].index);
+        width_autotune_key.push_back(
+            (uint32_t) v->kind | ((uint32_t) v->type << 16) |
+            ((uint32_t) v->cold().param_type << 24) |
+            ((uint32_t) (v->size == 1) << 28) |
+            ((uint32_t) v->is_literal() << 29));
+    }
+
+    XXH128_hash_t key =
+        XXH128(width_autotune_key.data(),
+               width_autotune_key.size() * sizeof(uint32_t), 0);
+
+    WidthAutotune &at = width_autotune[key];
+    if (at.selected)
+        return at.selected;
+
+    at.width[0] = width;
+    at.width[1] = width / 2;
+
+    width_autotune_pending = &at;
+    width_autotune_variant = at.samples[1] < at.samples[0] ? 1 : 0;
+    return at.width[width_autotune_variant];
+}
+
+/// Record the time taken by a launch requested by jitc_llvm_kernel_width()
+static void jitc_llvm_autotune_record(float time, uint64_t size) {
+    WidthAutotune &at = *width_autotune_pending;
+    uint32_t i = width_autotune_variant;
+    float time_per_elem = time / (float) size;
+    width_autotune_pending = nullptr;
+
+    // Keep the best time, which is least affected by other system activity
+    if (at.samples[i] == 0 || time_per_elem < at.time[i])
+        at.time[i] = time_per_elem;
+
+    if (++at.samples[i] < DRJIT_AUTOTUNE_SAMPLES ||
+        at.samples[1 - i] < DRJIT_AUTOTUNE_SAMPLES)
+        return;
+
+    at.selected = at.width[at.time[1] < at.time[0] ? 1 : 0];
+    jitc_log(Info,
+             "jit_run(): autotuner selected vector width %u (%.3f ns/element "
+             "at width %u, %.3f ns/element at width %u).", at.selected,
+             at.time[0] * 1e3f, at.width[0], at.time[1] * 1e3f, at.width[1]);
 }
 
 void jitc_assemble(ThreadState *ts, ScheduledGroup group) {
@@ -132,9 +370,7 @@ void jitc_assemble(ThreadState *ts, ScheduledGroup group) {
              n_regs         = 0;
 
     if (backend == JitBackend::CUDA) {
-        uintptr_t size = 0;
-        memcpy(&size, &group.size, sizeof(uint32_t));
-        kernel_params.push_back((void *) size);
+        kernel_params.push_back((void *) (uintptr_t) group.size);
 
         // The first 3 variables are reserved on the CUDA backend
         n_regs = 4;
@@ -159,20 +395,22 @@ void jitc_assemble(ThreadState *ts, ScheduledGroup group) {
             jitc_fail("jit_assemble(): schedule contains unreferenced variable r%u!", index);
         if (unlikely(v->size != 1 && v->size != group.size))
             jitc_fail("jit_assemble(): schedule contains variable r%u with incompatible size "
-                     "(%u and %u)!", index, v->size, group.size);
+                     "(%zu and %zu)!", index, (size_t) v->size,
+                     (size_t) group.size);
         if (unlikely(v->is_dirty()))
             jitc_fail("jit_assemble(): dirty variable r%u encountered!", index);
 
-        v->param_offset = (uint32_t) kernel_params.size() * sizeof(void *);
-        v->reg_index = n_regs++;
+        VariableCold &vc = v->cold();
+        vc.param_offset = (uint32_t) kernel_params.size() * sizeof(void *);
+        vc.reg_index = n_regs++;
 
         if (v->is_data()) {
             n_params_in++;
-            v->param_type = ParamType::Input;
+            vc.param_type = ParamType::Input;
             kernel_params.push_back(v->data);
-        } else if (v->output_flag && v->size == group.size) {
+        } else if (vc.output_flag && v->size == group.size) {
             n_params_out++;
-            v->param_type = ParamType::Output;
+            vc.param_type = ParamType::Output;
 
             size_t isize = (size_t) type_size[v->type],
                    dsize = (size_t) group.size * isize;
@@ -189,12 +427,12 @@ void jitc_assemble(ThreadState *ts, ScheduledGroup group) {
             kernel_params.push_back(sv.data);
         } else if (v->is_literal() && (VarType) v->type == VarType::Pointer) {
             n_params_in++;
-            v->param_type = ParamType::Input;
+            vc.param_type = ParamType::Input;
             kernel_params.push_back((void *) v->literal);
         } else {
             n_side_effects += (uint32_t) v->side_effect;
-            v->param_type = ParamType::Register;
-            v->param_offset = 0xFFFF;
+            vc.param_type = ParamType::Register;
+            vc.param_offset = 0xFFFF;
 
             #if defined(DRJIT_ENABLE_OPTIX)
                 uses_optix |= v->optix;
@@ -202,6 +440,29 @@ void jitc_assemble(ThreadState *ts, ScheduledGroup group) {
         }
     }
 
+    /* Coherent vcall dispatch on the LLVM backend: reserve a parameter slot
+       for the lane permutation of each block (see jitc_run_coherent()) */
+    coherent_dispatch = CoherentDispatch();
+    if (backend == JitBackend::LLVM && state.llvm_vcall_coherence > 0.f &&
+        group.size > DRJIT_POOL_BLOCK_SIZE && group.size <= 0xFFFFFFFFu) {
+        for (uint32_t i = group.start; i != group.end; ++i) {
+            const Variable *v = jitc_var(schedule[i].index);
+            if (v->kind != (uint32_t) VarKind::Dispatch)
+                continue;
+
+            const Variable *self = jitc_var(v->dep[0]);
+            if (self->is_literal() || self->size != group.size ||
+                self->cold().param_type != ParamType::Input)
+                continue;
+
+            coherent_dispatch.self_slot =
+                self->cold().param_offset / (uint32_t) sizeof(void *);
+            coherent_dispatch.perm_slot = (uint32_t) kernel_params.size();
+            kernel_params.push_back(nullptr);
+            break;
+        }
+    }
+
     if (unlikely(n_regs > 0xFFFFF))
         jitc_log(Warn,
                  "jit_run(): The generated kernel uses a more than 1 million "
@@ -241,34 +502,52 @@ void jitc_assemble(ThreadState *ts, ScheduledGroup group) {
             uint32_t index = schedule[group_index].index;
             Variable *v = jitc_var(index);
 
+            const VariableCold &vc = v->cold();
             buffer.fmt("   - %s%u -> r%u: ", type_prefix[v->type],
-                       v->reg_index, index);
+                       vc.reg_index, index);
 
             const char *label = jitc_var_label(index);
             if (label)
                 buffer.fmt("label=\"%s\", ", label);
-            if (v->param_type == ParamType::Input)
-                buffer.fmt("in, offset=%u, ", v->param_offset);
-            if (v->param_type == ParamType::Output)
-                buffer.fmt("out, offset=%u, ", v->param_offset);
+            if (vc.param_type == ParamType::Input)
+                buffer.fmt("in, offset=%u, ", vc.param_offset);
+            if (vc.param_type == ParamType::Output)
+                buffer.fmt("out, offset=%u, ", vc.param_offset);
             if (v->is_literal())
                 buffer.put("literal, ");
-            if (v->size == 1 && v->param_type != ParamType::Output)
+            if (v->size == 1 && vc.param_type != ParamType::Output)
                 buffer.put("scalar, ");
             if (v->side_effect)
                 buffer.put("side effects, ");
             buffer.rewind_to(buffer.size() - 2);
             buffer.put('\n');
         }
-        jitc_trace("jit_assemble(size=%u): register map:\n%s",
-                  group.size, buffer.get());
+        jitc_trace("jit_assemble(size=%zu): register map:\n%s",
+                  (size_t) group.size, buffer.get());
     }
 
     buffer.clear();
-    if (backend == JitBackend::CUDA)
+    if (backend == JitBackend::CUDA) {
         jitc_cuda_assemble(ts, group, n_regs, kernel_param_count);
-    else
-        jitc_llvm_assemble(ts, group);
+    } else {
+        /* Code generation reads 'jitc_llvm_vector_width', which temporarily
+           changes when this kernel uses another width. The width is part of
+           the generated IR and hence of the kernel cache key. Launches
+           refer to 'kernel_width' instead, since previously assembled
+           kernels may still be running on the thread pool. */
+        uint32_t target_width = jitc_llvm_vector_width;
+        kernel_width = jitc_llvm_kernel_width(group);
+        jitc_llvm_set_width(kernel_width);
+
+        try {
+            jitc_llvm_assemble(ts, group);
+        } catch (...) {
+            jitc_llvm_set_width(target_width);
+            throw;
+        }
+
+        jitc_llvm_set_width(target_width);
+    }
 
     // Replace '^'s in '__raygen__^^^..' or 'drjit_^^^..' with hash
     kernel_hash = hash_kernel(buffer.get());
@@ -294,15 +573,15 @@ void jitc_assemble(ThreadState *ts, ScheduledGroup group) {
 
     if (n_side_effects)
         jitc_log(
-            Info, "  -> launching %016llx (%sn=%u, in=%u, out=%u, se=%u, ops=%u, jit=%s):",
+            Info, "  -> launching %016llx (%sn=%zu, in=%u, out=%u, se=%u, ops=%u, jit=%s):",
             (unsigned long long) kernel_hash.high64,
-            uses_optix ? "via OptiX, " : "", group.size, n_params_in,
+            uses_optix ? "via OptiX, " : "", (size_t) group.size, n_params_in,
             n_params_out, n_side_effects, n_ops_total, jitc_time_string(codegen_time));
     else
         jitc_log(
-            Info, "  -> launching %016llx (%sn=%u, in=%u, out=%u, ops=%u, jit=%s):",
+            Info, "  -> launching %016llx (%sn=%zu, in=%u, out=%u, ops=%u, jit=%s):",
             (unsigned long long) kernel_hash.high64,
-            uses_optix ? "via OptiX, " : "", group.size, n_params_in,
+            uses_optix ? "via OptiX, " : "", (size_t) group.size, n_params_in,
             n_params_out, n_ops_total, jitc_time_string(codegen_time));
 
     if (unlikely(jit_flag(JitFlag::KernelHistory))) {
@@ -321,10 +600,308 @@ void jitc_assemble(ThreadState *ts, ScheduledGroup group) {
     }
 }
 
+/// Header of the parameter buffer of jitc_run_coherent()
+struct CoherentHeader {
+    uint32_t n_params, self_slot, perm_slot, width;
+    float threshold;
+};
+
+/**
+ * \brief Compute the lane permutation of one block of a kernel with coherent
+ * dispatch (see \ref jit_llvm_set_vcall_coherence())
+ *
+ * Lanes are sorted by their 'self' value using a counting sort, unless the
+ * block is already coherent enough. The permutation is padded to a multiple
+ * of the vector width of the kernel with lanes that keep their position.
+ */
+static void jitc_coherent_perm(const uint32_t *self, uint32_t start,
+                               uint32_t size, uint32_t width, float threshold,
+                               std::vector<uint32_t> &perm,
+                               std::vector<uint32_t> &counts) {
+    uint32_t packets = (size + width - 1) / width,
+             distinct = 0, self_max = 0;
+
+    perm.resize((size_t) packets * width);
+
+    // Count the distinct instances referenced by each packet
+    for (uint32_t i = 0; i < size; ++i) {
+        uint32_t value = self[i], j = i / width * width;
+        while (j < i && self[j] != value)
+            ++j;
+        distinct += j == i;
+        self_max = std::max(self_max, value);
+    }
+
+    if ((float) distinct < threshold * (float) packets || self_max >= size) {
+        for (uint32_t i = 0; i < packets * width; ++i)
+            perm[i] = start + i;
+        return;
+    }
+
+    counts.assign(self_max + 2, 0);
+    for (uint32_t i = 0; i < size; ++i)
+        counts[self[i] + 1]++;
+    for (uint32_t i = 1; i <= self_max; ++i)
+        counts[i] += counts[i - 1];
+    for (uint32_t i = 0; i < size; ++i)
+        perm[counts[self[i]]++] = start + i;
+    for (uint32_t i = size; i < packets * width; ++i)
+        perm[i] = start + i;
+}
+
+/**
+ * \brief Launch an LLVM kernel with coherent dispatch of a virtual function
+ * call
+ *
+ * Every work item sorts the lanes of its block by the 'self' value of the
+ * call and passes the resulting permutation to the kernel through the
+ * parameter slot reserved by \ref jitc_assemble().
+ */
+static Task *jitc_run_coherent(Task *dep, uint32_t blocks) {
+    CoherentHeader header;
+    header.n_params = (uint32_t) kernel_params.size();
+    header.self_slot = coherent_dispatch.self_slot;
+    header.perm_slot = coherent_dispatch.perm_slot;
+    header.width = kernel_width; // May differ from the target's width
+    header.threshold = state.llvm_vcall_coherence;
+
+    std::vector<uint8_t> payload(sizeof(CoherentHeader) +
+                                 header.n_params * sizeof(void *));
+    memcpy(payload.data(), &header, sizeof(CoherentHeader));
+    memcpy(payload.data() + sizeof(CoherentHeader), kernel_params.data(),
+           header.n_params * sizeof(void *));
+
+    auto callback = [](uint32_t index, void *ptr) {
+        static thread_local std::vector<uint32_t> perm, counts;
+        static thread_local std::vector<void *> params;
+
+        const CoherentHeader *h = (const CoherentHeader *) ptr;
+        void **params_in = (void **) (h + 1);
+        params.assign(params_in, params_in + h->n_params);
+
+        LLVMKernelFunction kernel = (LLVMKernelFunction) params[0];
+        uint64_t size  = (uint64_t) (uintptr_t) params[1],
+                 start = (uint64_t) index * DRJIT_POOL_BLOCK_SIZE,
+                 end   = std::min(start + DRJIT_POOL_BLOCK_SIZE, size);
+
+        jitc_coherent_perm((const uint32_t *) params[h->self_slot] + start,
+                           (uint32_t) start, (uint32_t) (end - start),
+                           h->width, h->threshold, perm, counts);
+        params[h->perm_slot] = perm.data();
+
+#if defined(DRJIT_ENABLE_ITTNOTIFY)
+        __itt_task_begin(drjit_domain, __itt_null, __itt_null,
+                         (__itt_string_handle *) params[2]);
+#endif
+        kernel(start, end, params.data());
+#if defined(DRJIT_ENABLE_ITTNOTIFY)
+        __itt_task_end(drjit_domain);
+#endif
+    };
+
+    jitc_trace("jit_run(): coherent dispatch over %u block%s (threshold=%.2f).",
+               blocks, blocks == 1 ? "" : "s", (double) header.threshold);
+
+    return task_submit_dep(nullptr, &dep, 1, blocks, callback, payload.data(),
+                           (uint32_t) payload.size(), nullptr);
+}
+
+/// Number of target entries that one work item of the merge task processes
+#define DRJIT_PRIVATE_MERGE_BLOCK 4096
+
+/// Target array of a privatized scatter-reduction (see jitc_run_private())
+struct PrivateTarget {
+    /// The actual target, and 'items' consecutive private copies of it
+    void *target, *copies;
+    uint32_t slot, size;
+    VarType type;
+    ReduceOp op;
+};
+
+/// Header of the parameter buffer of jitc_run_private()
+struct PrivateHeader {
+    uint32_t n_params, n_targets, items, blocks;
+};
+
+template <typename T> static T jitc_private_identity(ReduceOp op) {
+    switch (op) {
+        case ReduceOp::Mul: return T(1);
+        case ReduceOp::Min:
+            return std::is_integral<T>::value
+                       ? std::numeric_limits<T>::max()
+                       : std::numeric_limits<T>::infinity();
+        case ReduceOp::Max:
+            return std::is_integral<T>::value
+                       ? std::numeric_limits<T>::min()
+                       : -std::numeric_limits<T>::infinity();
+        case ReduceOp::And: return T(-1);
+        default: return T(0);
+    }
+}
+
+template <typename T> static T jitc_private_combine(ReduceOp op, T a, T b) {
+    using UInt = uint_with_size_t<T>;
+    UInt ai, bi;
+    switch (op) {
+        case ReduceOp::Mul: return a * b;
+        case ReduceOp::Min: return std::min(a, b);
+        case ReduceOp::Max: return std::max(a, b);
+        case ReduceOp::And:
+        case ReduceOp::Or:
+            memcpy(&ai, &a, sizeof(T));
+            memcpy(&bi, &b, sizeof(T));
+            ai = op == ReduceOp::And ? (ai & bi) : (ai | bi);
+            memcpy(&a, &ai, sizeof(T));
+            return a;
+        default: return a + b;
+    }
+}
+
+/// Call 'func' with a value of the C++ type associated with 'vt'
+template <typename Func> static void jitc_private_dispatch(VarType vt, Func func) {
+    switch (vt) {
+        case VarType::Int32:   func(int32_t()); break;
+        case VarType::UInt32:  func(uint32_t()); break;
+        case VarType::Int64:   func(int64_t()); break;
+        case VarType::UInt64:  func(uint64_t()); break;
+        case VarType::Float32: func(float()); break;
+        case VarType::Float64: func(double()); break;
+        default: break;
+    }
+}
+
+/**
+ * \brief Launch an LLVM kernel with privatized scatter-reductions
+ *
+ * The targets of the reductions listed in 'private_scatters' are replaced by
+ * one private copy per work item. Each work item initializes its copy with
+ * the identity element of the reduction and then processes every
+ * 'items'-th block of the kernel, which means that the copies are never
+ * accessed concurrently. A second task merges the copies into the actual
+ * targets. The copies are released at the end of \ref jitc_eval().
+ */
+static Task *jitc_run_private(Task *dep, uint32_t blocks) {
+    PrivateHeader header;
+    header.n_params = (uint32_t) kernel_params.size();
+    header.n_targets = (uint32_t) private_scatters.size();
+    header.items = std::max(std::min(pool_size(), blocks), 1u);
+    header.blocks = blocks;
+
+    std::vector<uint8_t> payload(sizeof(PrivateHeader) +
+                                 header.n_targets * sizeof(PrivateTarget) +
+                                 header.n_params * sizeof(void *));
+
+    uint32_t merge_items = 0;
+    PrivateTarget *targets = (PrivateTarget *) (payload.data() + sizeof(PrivateHeader));
+    for (uint32_t i = 0; i < header.n_targets; ++i) {
+        const PrivateScatter &ps = private_scatters[i];
+        PrivateTarget &t = targets[i];
+        t.target = kernel_params[ps.slot];
+        t.copies = jitc_malloc(AllocType::HostAsync,
+                               (size_t) header.items * ps.size *
+                                   type_size[(int) ps.type]);
+        t.slot = ps.slot;
+        t.size = ps.size;
+        t.type = ps.type;
+        t.op = ps.op;
+        private_buffers.push_back(t.copies);
+        merge_items += (ps.size + DRJIT_PRIVATE_MERGE_BLOCK - 1) /
+                       DRJIT_PRIVATE_MERGE_BLOCK;
+    }
+
+    memcpy(payload.data(), &header, sizeof(PrivateHeader));
+    memcpy(targets + header.n_targets, kernel_params.data(),
+           header.n_params * sizeof(void *));
+
+    auto callback_kernel = [](uint32_t index, void *ptr) {
+        const PrivateHeader *h = (const PrivateHeader *) ptr;
+        const PrivateTarget *t = (const PrivateTarget *) (h + 1);
+        std::unique_ptr<void *[]> params(new void *[h->n_params]);
+        memcpy(params.get(), t + h->n_targets, h->n_params * sizeof(void *));
+
+        for (uint32_t i = 0; i < h->n_targets; ++i) {
+            size_t bytes = (size_t) t[i].size * type_size[(int) t[i].type];
+            uint8_t *copy = (uint8_t *) t[i].copies + bytes * index;
+            params[t[i].slot] = copy;
+
+            jitc_private_dispatch(t[i].type, [&](auto value) {
+                using T = decltype(value);
+                T identity = jitc_private_identity<T>(t[i].op);
+                for (uint32_t j = 0; j < t[i].size; ++j)
+                    ((T *) copy)[j] = identity;
+            });
+        }
+
+        LLVMKernelFunction kernel = (LLVMKernelFunction) params[0];
+        uint64_t size = (uint64_t) (uintptr_t) params[1];
+
+#if defined(DRJIT_ENABLE_ITTNOTIFY)
+        __itt_task_begin(drjit_domain, __itt_null, __itt_null,
+                         (__itt_string_handle *) params[2]);
+#endif
+        for (uint32_t i = index; i < h->blocks; i += h->items) {
+            uint64_t start = (uint64_t) i * DRJIT_POOL_BLOCK_SIZE,
+                     end   = std::min(start + DRJIT_POOL_BLOCK_SIZE, size);
+            kernel(start, end, params.get());
+        }
+#if defined(DRJIT_ENABLE_ITTNOTIFY)
+        __itt_task_end(drjit_domain);
+#endif
+    };
+
+    auto callback_merge = [](uint32_t index, void *ptr) {
+        const PrivateHeader *h = (const PrivateHeader *) ptr;
+        const PrivateTarget *t = (const PrivateTarget *) (h + 1);
+
+        // Find the target and range of entries processed by this work item
+        uint32_t i = 0;
+        while (true) {
+            uint32_t n = (t[i].size + DRJIT_PRIVATE_MERGE_BLOCK - 1) /
+                         DRJIT_PRIVATE_MERGE_BLOCK;
+            if (index < n)
+                break;
+            index -= n;
+            i++;
+        }
+
+        uint32_t start = index * DRJIT_PRIVATE_MERGE_BLOCK,
+                 end = std::min(start + DRJIT_PRIVATE_MERGE_BLOCK, t[i].size);
+
+        jitc_private_dispatch(t[i].type, [&](auto value) {
+            using T = decltype(value);
+            T *target = (T *) t[i].target;
+            const T *copies = (const T *) t[i].copies;
+            for (uint32_t j = start; j < end; ++j) {
+                T result = target[j];
+                for (uint32_t k = 0; k < h->items; ++k)
+                    result = jitc_private_combine<T>(
+                        t[i].op, result, copies[(size_t) k * t[i].size + j]);
+                target[j] = result;
+            }
+        });
+    };
+
+    jitc_trace("jit_run(): privatizing %u scatter-reduction%s over %u work "
+               "item%s.", header.n_targets, header.n_targets == 1 ? "" : "s",
+               header.items, header.items == 1 ? "" : "s");
+
+    Task *kernel_task = task_submit_dep(
+        nullptr, &dep, 1, header.items, callback_kernel, payload.data(),
+        (uint32_t) payload.size(), nullptr);
+
+    Task *merge_task = task_submit_dep(
+        nullptr, &kernel_task, 1, merge_items, callback_merge, payload.data(),
+        (uint32_t) payload.size(), nullptr);
+
+    task_release(kernel_task);
+    return merge_task;
+}
+
 static ProfilerRegion profiler_region_backend_compile("jit_eval: compiling");
 static ProfilerRegion profiler_region_backend_load("jit_eval: loading");
 
-Task *jitc_run(ThreadState *ts, ScheduledGroup group) {
+Task *jitc_run(ThreadState *ts, ScheduledGroup group, Task *dep,
+               bool batch) {
     uint64_t flags = 0;
 
 #if defined(DRJIT_ENABLE_OPTIX)
@@ -378,6 +955,7 @@ Task *jitc_run(ThreadState *ts, ScheduledGroup group) {
         ProfilerPhase profiler(profiler_region_backend_load);
 
         if (ts->backend == JitBackend::LLVM) {
+            jitc_llvm_link(kernel);
             jitc_llvm_disasm(kernel);
         } else if (!uses_optix) {
             CUresult ret = (CUresult) 0;
@@ -461,7 +1039,7 @@ Task *jitc_run(ThreadState *ts, ScheduledGroup group) {
     if (ts->backend == JitBackend::CUDA) {
 #if defined(DRJIT_ENABLE_OPTIX)
         if (unlikely(uses_optix))
-            jitc_optix_launch(ts, kernel, group.size, kernel_params_global,
+            jitc_optix_launch(ts, kernel, (uint32_t) group.size, kernel_params_global,
                               kernel_param_count);
 #endif
 
@@ -476,7 +1054,7 @@ Task *jitc_run(ThreadState *ts, ScheduledGroup group) {
                 CU_LAUNCH_PARAM_END
             };
 
-            uint32_t block_count, thread_count, size = group.size;
+            uint32_t block_count, thread_count, size = (uint32_t) group.size;
             const Device &device = state.devices[ts->device];
             device.get_launch_config(&block_count, &thread_count, size,
                                      (uint32_t) kernel.cuda.block_size);
@@ -489,16 +1067,14 @@ Task *jitc_run(ThreadState *ts, ScheduledGroup group) {
         if (unlikely(jit_flag(JitFlag::LaunchBlocking)))
             cuda_check(cuStreamSynchronize(ts->stream));
     } else {
-        uint32_t packets =
-            (group.size + jitc_llvm_vector_width - 1) / jitc_llvm_vector_width;
+        size_t packets = (group.size + kernel_width - 1) / kernel_width;
 
         auto callback = [](uint32_t index, void *ptr) {
             void **params = (void **) ptr;
             LLVMKernelFunction kernel = (LLVMKernelFunction) params[0];
-            uint32_t size       = (uint32_t) (uintptr_t) params[1],
-                     block_size = (uint32_t) ((uintptr_t) params[1] >> 32),
-                     start      = index * block_size,
-                     end        = std::min(start + block_size, size);
+            uint64_t size  = (uint64_t) (uintptr_t) params[1],
+                     start = (uint64_t) index * DRJIT_POOL_BLOCK_SIZE,
+                     end   = std::min(start + DRJIT_POOL_BLOCK_SIZE, size);
 
 #if defined(DRJIT_ENABLE_ITTNOTIFY)
             // Signal start of kernel
@@ -514,28 +1090,115 @@ Task *jitc_run(ThreadState *ts, ScheduledGroup group) {
 #endif
         };
 
-        uint32_t block_size = DRJIT_POOL_BLOCK_SIZE,
-                 blocks = (group.size + block_size - 1) / block_size;
+        uint64_t block_size = DRJIT_POOL_BLOCK_SIZE;
+        uint32_t blocks = (uint32_t) ((group.size + block_size - 1) / block_size);
 
         kernel_params[0] = (void *) kernel.llvm.reloc[0];
-        kernel_params[1] = (void *) ((((uintptr_t) block_size) << 32) +
-                                     (uintptr_t) group.size);
+        kernel_params[1] = (void *) (uintptr_t) group.size;
 
 #if defined(DRJIT_ENABLE_ITTNOTIFY)
         kernel_params[2] = kernel.llvm.itt;
 #endif
 
-        jitc_trace("jit_run(): scheduling %u packet%s in %u block%s ..",
+        if (batch) {
+            // Deferred, see jitc_run_batch()
+            batch_offsets.push_back((uint32_t) batch_params.size());
+            batch_params.insert(batch_params.end(), kernel_params.begin(),
+                                kernel_params.end());
+            return nullptr;
+        }
+
+        jitc_trace("jit_run(): scheduling %zu packet%s in %u block%s ..",
                    packets, packets == 1 ? "" : "s", blocks,
                    blocks == 1 ? "" : "s");
         (void) packets; // jitc_trace may be disabled
 
-        ret_task = task_submit_dep(
-            nullptr, &jitc_task, 1, blocks,
-            callback, kernel_params.data(),
-            (uint32_t) (kernel_params.size() * sizeof(void *)),
-            nullptr
-        );
+        NUMASchedule numa;
+        if (width_autotune_pending && (!private_scatters.empty() ||
+                                       jitc_numa_schedule(blocks, numa)))
+            width_autotune_pending = nullptr; // Only time the default path
+
+        if (!private_scatters.empty()) {
+            ret_task = jitc_run_private(dep, blocks);
+        } else if (coherent_dispatch.perm_slot) {
+            ret_task = jitc_run_coherent(dep, blocks);
+        } else if (jitc_numa_schedule(blocks, numa)) {
+            /* NUMA-aware schedule: every work item claims blocks from the
+               range of the node that its thread is pinned to, and then helps
+               with the ranges of the other nodes. The schedule and one block
+               counter per node are prepended to the parameter buffer. */
+            auto callback_numa = [](uint32_t index, void *ptr) {
+                const NUMASchedule *sched = (const NUMASchedule *) ptr;
+                std::atomic<uint32_t> *counters =
+                    (std::atomic<uint32_t> *) ((void **) ptr + 2);
+                void **params = (void **) ptr + 2 + sched->nodes;
+                LLVMKernelFunction kernel = (LLVMKernelFunction) params[0];
+                uint64_t size = (uint64_t) (uintptr_t) params[1];
+
+                uint32_t node = jitc_numa_pin_worker(sched->nodes);
+                if (node == (uint32_t) -1)
+                    node = index % sched->nodes;
+
+#if defined(DRJIT_ENABLE_ITTNOTIFY)
+                __itt_task_begin(drjit_domain, __itt_null, __itt_null,
+                                 (__itt_string_handle *) params[2]);
+#endif
+                for (uint32_t j = 0; j < sched->nodes; ++j) {
+                    uint32_t n = (node + j) % sched->nodes, block_start, block_end;
+                    sched->node_range(n, block_start, block_end);
+
+                    while (true) {
+                        uint32_t i = block_start + counters[n].fetch_add(
+                                                       1, std::memory_order_relaxed);
+                        if (i >= block_end)
+                            break;
+                        uint64_t start = (uint64_t) i * DRJIT_POOL_BLOCK_SIZE,
+                                 end   = std::min(start + DRJIT_POOL_BLOCK_SIZE, size);
+                        kernel(start, end, params);
+                    }
+                }
+#if defined(DRJIT_ENABLE_ITTNOTIFY)
+                __itt_task_end(drjit_domain);
+#endif
+            };
+
+            static_assert(sizeof(NUMASchedule) <= 2 * sizeof(void *) &&
+                          sizeof(std::atomic<uint32_t>) <= sizeof(void *),
+                          "NUMASchedule: header too large!");
+            kernel_params.insert(kernel_params.begin(), 2 + numa.nodes, nullptr);
+            memcpy(kernel_params.data(), &numa, sizeof(NUMASchedule));
+            for (uint32_t i = 0; i < numa.nodes; ++i)
+                new (kernel_params.data() + 2 + i) std::atomic<uint32_t>(0);
+
+            jitc_trace("jit_run(): using a NUMA-aware schedule with %u work "
+                       "item%s on %u NUMA nodes.", numa.workers,
+                       numa.workers == 1 ? "" : "s", numa.nodes);
+
+            ret_task = task_submit_dep(
+                nullptr, &dep, 1, numa.workers,
+                callback_numa, kernel_params.data(),
+                (uint32_t) (kernel_params.size() * sizeof(void *)),
+                nullptr
+            );
+        } else {
+            // Autotuned launches run synchronously to measure their duration
+            if (width_autotune_pending) {
+                task_wait(dep);
+                (void) timer();
+            }
+
+            ret_task = task_submit_dep(
+                nullptr, &dep, 1, blocks,
+                callback, kernel_params.data(),
+                (uint32_t) (kernel_params.size() * sizeof(void *)),
+                nullptr
+            );
+
+            if (width_autotune_pending) {
+                task_wait(ret_task);
+                jitc_llvm_autotune_record(timer(), group.size);
+            }
+        }
 
         if (unlikely(jit_flag(JitFlag::LaunchBlocking)))
             task_wait(ret_task);
@@ -556,8 +1219,516 @@ Task *jitc_run(ThreadState *ts, ScheduledGroup group) {
     return ret_task;
 }
 
+/**
+ * \brief Launch the small kernels collected by jitc_run() using a single
+ * task (LLVM only)
+ *
+ * Every kernel of the batch processes at most one block, which is why there
+ * is little to be gained from submitting them separately. Work item 'i' of
+ * the task runs the 'i'th kernel. The parameter buffer starts with the number
+ * of kernels followed by the offsets of their parameters.
+ */
+static Task *jitc_run_batch() {
+    uint32_t n = (uint32_t) batch_offsets.size();
+
+    kernel_params.clear();
+    kernel_params.push_back((void *) (uintptr_t) n);
+    for (uint32_t offset : batch_offsets)
+        kernel_params.push_back((void *) (uintptr_t) (offset + n + 1));
+    kernel_params.insert(kernel_params.end(), batch_params.begin(),
+                         batch_params.end());
+    batch_params.clear();
+    batch_offsets.clear();
+
+    auto callback = [](uint32_t index, void *ptr) {
+        void **base = (void **) ptr,
+             **params = base + (uintptr_t) base[index + 1];
+        LLVMKernelFunction kernel = (LLVMKernelFunction) params[0];
+        uint64_t size = (uint64_t) (uintptr_t) params[1];
+
+#if defined(DRJIT_ENABLE_ITTNOTIFY)
+        __itt_task_begin(drjit_domain, __itt_null, __itt_null,
+                         (__itt_string_handle *) params[2]);
+#endif
+        kernel(0, size, params);
+#if defined(DRJIT_ENABLE_ITTNOTIFY)
+        __itt_task_end(drjit_domain);
+#endif
+    };
+
+    jitc_trace("jit_run(): scheduling %u small kernel%s in one task ..", n,
+               n == 1 ? "" : "s");
+
+    return task_submit_dep(
+        nullptr, &jitc_task, 1, n, callback, kernel_params.data(),
+        (uint32_t) (kernel_params.size() * sizeof(void *)), nullptr);
+}
+
 static ProfilerRegion profiler_region_eval("jit_eval");
 
+/// Estimated cost of computing a variable once its operands are available
+static uint32_t jitc_var_cost(const Variable *v) {
+    if (v->is_data())
+        return v->size > 1 ? DRJIT_MEMORY_COST : 0;
+
+    switch ((VarKind) v->kind) {
+        case VarKind::Literal:
+        case VarKind::Nop:
+        case VarKind::Copy:
+        case VarKind::Bitcast:
+        case VarKind::Extract:
+        case VarKind::Counter:
+        case VarKind::DefaultMask:
+        case VarKind::VCallMask:
+        case VarKind::VCallSelf:
+            return 0;
+
+        case VarKind::Div:
+        case VarKind::Mod:
+            return jitc_is_float((VarType) v->type) ? 4 : 8;
+
+        case VarKind::Sqrt:
+        case VarKind::Rcp:
+        case VarKind::Rsqrt:
+            return 4;
+
+        case VarKind::Sin:
+        case VarKind::Cos:
+        case VarKind::Exp2:
+        case VarKind::Log2:
+            return 8;
+
+        case VarKind::Gather:
+        case VarKind::TexLookup:
+        case VarKind::TexFetchBilerp:
+            return 4 * DRJIT_MEMORY_COST;
+
+        case VarKind::Dispatch:
+        case VarKind::TraceRay:
+            return DRJIT_MATERIALIZE_COST;
+
+        default:
+            return 1;
+    }
+}
+
+/// Visit the (packed and 'extra') dependencies of a scheduled variable
+template <typename Func> static void jitc_visit_deps(uint32_t index, Func func) {
+    const Variable *v = jitc_var(index);
+    for (uint32_t i = 0; i < 4; ++i) {
+        if (!v->dep[i])
+            break;
+        func(v->dep[i]);
+    }
+
+    if (unlikely(v->extra)) {
+        const Extra &extra = state.extra[index];
+        for (uint32_t i = 0; i < extra.n_dep; ++i) {
+            if (extra.dep[i])
+                func(extra.dep[i]);
+        }
+    }
+}
+
+/**
+ * \brief Estimate the per-element cost of recomputing 'index' along with the
+ * unevaluated part of the graph below it
+ *
+ * Every variable is counted once, even if it is reachable along several paths.
+ * Outputs of the current evaluation will be loaded from memory instead.
+ */
+static uint64_t jitc_materialize_cost(uint32_t index) {
+    uint32_t epoch = ++materialize_epoch;
+    uint64_t cost = 0;
+
+    materialize_stack.clear();
+    materialize_stack.push_back(index);
+
+    while (!materialize_stack.empty()) {
+        uint32_t index2 = materialize_stack.back();
+        materialize_stack.pop_back();
+
+        auto it = materialize_info.find(index2);
+        if (it == materialize_info.end() || it.value().visited == epoch)
+            continue;
+        it.value().visited = epoch;
+
+        const Variable *v = jitc_var(index2);
+        if (index2 != index && v->cold().output_flag) {
+            cost += DRJIT_MEMORY_COST;
+            continue;
+        }
+
+        cost += jitc_var_cost(v);
+        jitc_visit_deps(index2, [](uint32_t dep) {
+            materialize_stack.push_back(dep);
+        });
+    }
+
+    return cost;
+}
+
+/**
+ * \brief Decide which intermediate results of the current schedule should
+ * be stored to memory
+ *
+ * Variables that are still referenced once this evaluation finishes (e.g. by
+ * the application or by variables that will be evaluated later on) are
+ * normally recomputed by every kernel that needs them. The kernels of one
+ * evaluation cannot reuse each other's results, hence this is a bet on such
+ * later uses: the function estimates the cost of recomputing the variable for
+ * each remaining reference and stores it instead if this exceeds the memory
+ * traffic of storing it once and loading it for each reference. Cheap
+ * expressions (e.g. a few arithmetic operations involving evaluated arrays)
+ * continue to be recomputed.
+ */
+static void jitc_eval_materialize() {
+    if (!(jitc_flags() & (uint32_t) JitFlag::AutoMaterialize))
+        return;
+
+    // Pass 1: count references within the schedule
+    materialize_info.clear();
+    for (const ScheduledVariable &sv : schedule) {
+        if (materialize_info.find(sv.index) != materialize_info.end())
+            continue; // Already visited while processing a different size
+
+        jitc_visit_deps(sv.index, [](uint32_t dep) {
+            auto it = materialize_info.find(dep);
+            if (it != materialize_info.end())
+                it.value().refs++;
+        });
+
+        materialize_info[sv.index];
+    }
+
+    // Pass 2: store variables that would be expensive to recompute later on
+    uint32_t n_materialized = 0, n_recomputed = 0;
+    for (const ScheduledVariable &sv : schedule) {
+        Variable *v = jitc_var(sv.index);
+        VariableCold &vc = v->cold();
+        if (vc.output_flag || !v->is_node() || v->placeholder ||
+            v->extra || v->side_effect ||
+            v->size != sv.size || (VarType) v->type == VarType::Void ||
+            (VarType) v->type == VarType::Pointer)
+            continue;
+
+        uint32_t refs = materialize_info[sv.index].refs;
+        if (v->ref_count <= refs)
+            continue; // Not referenced after this evaluation
+
+        uint64_t uses = v->ref_count - refs,
+                 cost = jitc_materialize_cost(sv.index),
+                 recompute = v->size * cost * uses,
+                 traffic = v->size * DRJIT_MEMORY_COST * (1 + uses);
+
+        if (recompute == 0)
+            continue;
+
+        if (recompute > traffic) {
+            vc.output_flag = true;
+            n_materialized++;
+        } else {
+            n_recomputed++;
+        }
+
+        jitc_log(Debug,
+                 "jit_eval(): %s r%u (estimated cost: %" PRIu64
+                 " per element and use, %" PRIu64 " uses)",
+                 vc.output_flag ? "materializing" : "will recompute",
+                 sv.index, cost, uses);
+    }
+
+    if (n_materialized || n_recomputed)
+        jitc_log(Info,
+                 "jit_eval(): cost model stores %u and recomputes %u shared "
+                 "intermediate result%s.", n_materialized, n_recomputed,
+                 n_materialized + n_recomputed == 1 ? "" : "s");
+}
+
+/// Classification of variables that are live across a kernel split point
+enum SplitClass : uint8_t {
+    /// Loaded by every part (evaluated arrays, literals, kernel outputs)
+    SplitReload,
+    /// Recomputed by every part (scalar expressions, counters)
+    SplitRecompute,
+    /// Must be stored to memory by the part that computes it
+    SplitStore,
+    /// Cannot be passed between kernels (loop state, vcall results, ..)
+    SplitForbidden
+};
+
+/// Append the variable at position 'pos' of 'group' to a later part (and
+/// the scalar expressions it depends on)
+static void jitc_split_import(ScheduledGroup group, uint32_t pos, uint32_t part) {
+    if (split_mark[pos] == part)
+        return;
+    split_mark[pos] = part;
+
+    uint32_t index = schedule[group.start + pos].index;
+    const Variable *v = jitc_var(index);
+
+    if (split_class[pos] == SplitRecompute)
+        jitc_visit_deps(index, [&](uint32_t dep) {
+            jitc_split_import(group, split_pos[dep], part);
+        });
+
+    split_schedule.emplace_back(group.size, v->scope, index);
+}
+
+/**
+ * \brief Partition kernels that exceed the limits specified via
+ * jit_set_kernel_split_threshold() into several smaller kernels
+ *
+ * The parts of a split kernel run one after the other. Values computed by
+ * one part and needed by a later one are stored to memory, and the cut points
+ * are chosen so that few such intermediates are needed. Evaluated arrays,
+ * literals, and scalar expressions are instead loaded or recomputed by every
+ * part that uses them. Loops, vcalls, and other constructs whose state cannot
+ * be passed through memory are never cut.
+ */
+static void jitc_eval_split() {
+    uint32_t max_ops = state.kernel_split_ops,
+             max_live = state.kernel_split_live;
+
+    if (!max_ops && !max_live)
+        return;
+
+    bool split = false;
+    for (const ScheduledGroup &group : schedule_groups)
+        split |= max_live || group.end - group.start > max_ops;
+    if (!split)
+        return;
+
+    split_schedule.clear();
+    split_groups.clear();
+
+    for (const ScheduledGroup &group : schedule_groups) {
+        uint32_t n = group.end - group.start, parts = 1;
+
+        if (max_ops && n > max_ops)
+            parts = (n + max_ops - 1) / max_ops;
+
+        if (parts == 1 && !max_live) {
+            uint32_t start = (uint32_t) split_schedule.size();
+            split_schedule.insert(split_schedule.end(),
+                                  schedule.begin() + group.start,
+                                  schedule.begin() + group.end);
+            split_groups.emplace_back(group.size, start,
+                                      (uint32_t) split_schedule.size());
+            continue;
+        }
+
+        // Determine the last use of each variable within the group
+        split_pos.clear();
+        split_last_use.resize(n);
+        split_class.resize(n);
+        for (uint32_t i = 0; i < n; ++i) {
+            split_pos[schedule[group.start + i].index] = i;
+            split_last_use[i] = i;
+        }
+
+        for (uint32_t i = 0; i < n; ++i)
+            jitc_visit_deps(schedule[group.start + i].index, [&](uint32_t dep) {
+                uint32_t &last_use = split_last_use[split_pos[dep]];
+                last_use = std::max(last_use, i);
+            });
+
+        /* Count the variables that are live across each potential cut point
+           'k', where the first part contains the positions [0, k) */
+        split_cost.assign(n + 1, 0);
+        split_bad.assign(n + 1, 0);
+        split_live.assign(n + 1, 0);
+
+        for (uint32_t i = 0; i < n; ++i) {
+            uint32_t index = schedule[group.start + i].index;
+            const Variable *v = jitc_var(index);
+            VarType vt = (VarType) v->type;
+
+            SplitClass cl;
+            if (v->is_data() || v->is_literal() ||
+                (v->cold().output_flag && v->size == group.size)) {
+                cl = SplitReload;
+            } else if (v->placeholder || v->extra || v->side_effect ||
+                       vt == VarType::Void || vt == VarType::Pointer) {
+                cl = SplitForbidden;
+            } else if (v->size != group.size || v->dep[0] == 0) {
+                cl = SplitRecompute;
+                jitc_visit_deps(index, [&](uint32_t dep) {
+                    if (split_class[split_pos[dep]] >= SplitStore)
+                        cl = SplitForbidden;
+                });
+            } else {
+                cl = SplitStore;
+            }
+            split_class[i] = (uint8_t) cl;
+
+            uint32_t last_use = split_last_use[i];
+            if (last_use == i)
+                continue;
+
+            split_live[i + 1]++;
+            split_live[last_use + 1]--;
+            if (cl == SplitStore) {
+                split_cost[i + 1]++;
+                split_cost[last_use + 1]--;
+            } else if (cl == SplitForbidden) {
+                split_bad[i + 1]++;
+                split_bad[last_use + 1]--;
+            }
+        }
+
+        int32_t peak_live = 0;
+        for (uint32_t k = 1; k <= n; ++k) {
+            split_cost[k] += split_cost[k - 1];
+            split_bad[k] += split_bad[k - 1];
+            split_live[k] += split_live[k - 1];
+            peak_live = std::max(peak_live, split_live[k]);
+        }
+
+        if (max_live && (uint32_t) peak_live > max_live)
+            parts = std::max(parts, ((uint32_t) peak_live + max_live - 1) / max_live);
+        parts = std::min(parts, std::max(n / 2, 1u));
+
+        /* Look for the cheapest admissible cut point in a window surrounding
+           each of the ideal (evenly spaced) cut points */
+        split_cuts.clear();
+        uint32_t prev = 0, window = n / (2 * parts);
+        for (uint32_t j = 1; j < parts; ++j) {
+            uint32_t target = (uint32_t) ((uint64_t) n * j / parts),
+                     lo = std::max(prev + 1, target > window ? target - window : 1u),
+                     hi = std::min(n - 1, target + window),
+                     best = 0, best_cost = 0, best_dist = 0;
+
+            for (uint32_t k = lo; k <= hi; ++k) {
+                if (split_bad[k])
+                    continue;
+                uint32_t cost = (uint32_t) split_cost[k],
+                         dist = k > target ? k - target : target - k;
+                if (!best || cost < best_cost ||
+                    (cost == best_cost && dist < best_dist)) {
+                    best = k;
+                    best_cost = cost;
+                    best_dist = dist;
+                }
+            }
+
+            if (best) {
+                split_cuts.push_back(best);
+                prev = best;
+            }
+        }
+        split_cuts.push_back(n);
+
+        if (split_cuts.size() > 1) {
+            uint32_t n_stored = 0;
+            for (uint32_t i = 0; i < n; ++i) {
+                if (split_class[i] != SplitStore ||
+                    split_last_use[i] < split_cuts[0])
+                    continue;
+                // Live across some cut, is it used by a later part?
+                for (uint32_t cut : split_cuts) {
+                    if (i < cut && split_last_use[i] >= cut) {
+                        jitc_var(schedule[group.start + i].index)->cold().output_flag = true;
+                        n_stored++;
+                        break;
+                    }
+                }
+            }
+
+            jitc_log(Info,
+                     "jit_eval(): splitting kernel with %u operations and ~%i "
+                     "live values into %zu parts, storing %u intermediate "
+                     "result%s.", n, peak_live, split_cuts.size(), n_stored,
+                     n_stored == 1 ? "" : "s");
+        }
+
+        split_mark.assign(n, 0);
+        for (uint32_t j = 0, a = 0; j < (uint32_t) split_cuts.size(); ++j) {
+            uint32_t b = split_cuts[j],
+                     start = (uint32_t) split_schedule.size();
+
+            // Operands computed by earlier parts
+            for (uint32_t i = a; i < b; ++i)
+                jitc_visit_deps(schedule[group.start + i].index, [&](uint32_t dep) {
+                    uint32_t pos = split_pos[dep];
+                    if (pos < a)
+                        jitc_split_import(group, pos, j + 1);
+                });
+
+            split_schedule.insert(split_schedule.end(),
+                                  schedule.begin() + group.start + a,
+                                  schedule.begin() + group.start + b);
+
+            ScheduledGroup &part = split_groups.emplace_back(
+                group.size, start, (uint32_t) split_schedule.size());
+            part.chained = j > 0;
+            a = b;
+        }
+    }
+
+    schedule.swap(split_schedule);
+    schedule_groups.swap(split_groups);
+}
+
+/**
+ * \brief Turn an evaluated output into a 'Data' variable and remove the
+ * internal edges of a scheduled variable
+ *
+ * This causes many variables to expire once a kernel has been launched.
+ */
+static void jitc_eval_finalize(const ScheduledVariable &sv) {
+    uint32_t index = sv.index;
+
+    Variable *v = state.variables.find(index);
+    if (!v)
+        return;
+    v->cold().reg_index = 0;
+    if (!(v->cold().output_flag || v->side_effect))
+        return;
+
+    if (unlikely(v->is_literal()))
+        jitc_fail("jit_eval(): internal error: did not expect a literal "
+                  "constant variable here!");
+
+    jitc_lvn_drop(index, v);
+
+    if (v->cold().output_flag && v->size == sv.size) {
+        v->kind = (uint32_t) VarKind::Data;
+        v->data = sv.data;
+        v->cold().output_flag = false;
+    }
+
+    if (unlikely(v->extra)) {
+        auto it2 = state.extra.find(index);
+        if (it2 == state.extra.end())
+            jitc_fail("jit_eval(): could not find 'extra' record of variable %u", index);
+        const Extra &extra = it2->second;
+
+        if (extra.callback) {
+            if (extra.callback_internal) {
+                extra.callback(index, 0, extra.callback_data);
+            } else {
+                unlock_guard guard_2(state.lock);
+                extra.callback(index, 0, extra.callback_data);
+            }
+            v = jitc_var(index);
+        }
+
+        state.extra[index].assemble = nullptr;
+    }
+
+    uint32_t dep[4], side_effect = v->side_effect;
+    memcpy(dep, v->dep, sizeof(uint32_t) * 4);
+    memset(v->dep, 0, sizeof(uint32_t) * 4);
+    v->side_effect = false;
+
+    if (side_effect)
+        jitc_var_dec_ref(index);
+
+    for (int j = 0; j < 4; ++j)
+        jitc_var_dec_ref(dep[j]);
+}
+
 /// Evaluate all computation that is queued on the given ThreadState
 void jitc_eval(ThreadState *ts) {
     if (!ts || (ts->scheduled.empty() && ts->side_effects.empty()))
@@ -579,34 +1750,59 @@ void jitc_eval(ThreadState *ts) {
 
     jitc_var_loop_simplify();
 
-    visited.clear();
     schedule.clear();
+    traverse_roots.clear();
 
     // Collect variables that must be computed along with their dependencies
     for (int j = 0; j < 2; ++j) {
         auto &source = j == 0 ? ts->scheduled : ts->side_effects;
         for (size_t i = 0; i < source.size(); ++i) {
             uint32_t index = source[i];
-            auto it = state.variables.find(index);
-            if (it == state.variables.end())
+            Variable *v = state.variables.find(index);
+            if (!v)
                 continue;
 
-            Variable *v = &it.value();
-
             // Skip variables that are already evaluated
             if (v->is_data())
                 continue;
 
-            jitc_var_traverse(v->size, index);
-            v->output_flag = (VarType) v->type != VarType::Void;
+            traverse_roots.emplace_back(v->size, index);
         }
 
         source.clear();
     }
 
+    /* Traverse the roots grouped by size, using a separate epoch per size.
+       The stable sort preserves the order of roots with the same size, so
+       the resulting schedule matches a traversal in the original order. */
+    std::stable_sort(traverse_roots.begin(), traverse_roots.end(),
+                     [](const std::pair<uint64_t, uint32_t> &a,
+                        const std::pair<uint64_t, uint32_t> &b) {
+                         return a.first < b.first;
+                     });
+
+    uint32_t n_sizes = 0;
+    for (size_t i = 0; i < traverse_roots.size(); ++i)
+        n_sizes += i == 0 || traverse_roots[i].first != traverse_roots[i - 1].first;
+
+    traverse_epoch_base = jitc_var_epoch_new(std::max(n_sizes, 1u));
+    traverse_epoch = traverse_epoch_base - 1;
+
+    for (size_t i = 0; i < traverse_roots.size(); ++i) {
+        auto [size, index] = traverse_roots[i];
+        if (i == 0 || size != traverse_roots[i - 1].first)
+            traverse_epoch++;
+
+        jitc_var_traverse(size, index);
+        Variable *v = jitc_var(index);
+        v->cold().output_flag = (VarType) v->type != VarType::Void;
+    }
+
     if (schedule.empty())
         return;
 
+    jitc_eval_materialize();
+
     // Order variables into groups of matching size
     std::stable_sort(
         schedule.begin(), schedule.end(),
@@ -641,6 +1837,8 @@ void jitc_eval(ThreadState *ts) {
                                      cur, (uint32_t) schedule.size());
     }
 
+    jitc_eval_split();
+
     jitc_log(Info, "jit_eval(): launching %zu kernel%s.",
             schedule_groups.size(),
             schedule_groups.size() == 1 ? "" : "s");
@@ -648,17 +1846,56 @@ void jitc_eval(ThreadState *ts) {
     scoped_set_context_maybe guard2(ts->context);
     scheduled_tasks.clear();
 
-    for (ScheduledGroup &group : schedule_groups) {
+    /* On the LLVM backend, kernels that fit into a single block are launched
+       together by one task to reduce the task creation overheads */
+    auto batchable = [](size_t i) {
+        return schedule_groups[i].size <= DRJIT_POOL_BLOCK_SIZE &&
+               !schedule_groups[i].chained &&
+               !(i + 1 < schedule_groups.size() &&
+                 schedule_groups[i + 1].chained);
+    };
+
+    uint32_t n_batch = 0;
+    if (ts->backend == JitBackend::LLVM &&
+        !(jitc_flags() & ((uint32_t) JitFlag::KernelHistory |
+                          (uint32_t) JitFlag::LaunchBlocking))) {
+        for (size_t i = 0; i < schedule_groups.size(); ++i)
+            n_batch += batchable(i);
+        if (n_batch < 2)
+            n_batch = 0;
+    }
+
+    for (size_t i = 0; i < schedule_groups.size(); ++i) {
+        const ScheduledGroup &group = schedule_groups[i];
         jitc_assemble(ts, group);
 
-        scheduled_tasks.push_back(jitc_run(ts, group));
+        // The parts of a split kernel must run one after the other
+        Task *dep = group.chained ? scheduled_tasks.back() : jitc_task;
+        bool batch = n_batch && batchable(i);
+        Task *task = jitc_run(ts, group, dep, batch);
+        if (!batch)
+            scheduled_tasks.push_back(task);
 
         if (ts->backend == JitBackend::CUDA) {
             jitc_free(kernel_params_global);
             kernel_params_global = nullptr;
         }
+
+        // Subsequent parts access the outputs of this one as evaluated arrays
+        if (i + 1 < schedule_groups.size() && schedule_groups[i + 1].chained) {
+            for (uint32_t j = group.start; j != group.end; ++j) {
+                const ScheduledVariable &sv = schedule[j];
+                const Variable *v = state.variables.find(sv.index);
+                if (v && v->cold().output_flag && v->size == sv.size &&
+                    !v->side_effect)
+                    jitc_eval_finalize(sv);
+            }
+        }
     }
 
+    if (n_batch)
+        scheduled_tasks.push_back(jitc_run_batch());
+
     if (ts->backend == JitBackend::LLVM) {
         if (scheduled_tasks.size() == 1) {
             task_release(jitc_task);
@@ -675,98 +1912,115 @@ void jitc_eval(ThreadState *ts) {
                 task_release(t);
             jitc_task = new_task;
         }
+
+        // Later kernels wait for 'jitc_task', so the copies can be recycled
+        for (void *ptr : private_buffers)
+            jitc_free(ptr);
+        private_buffers.clear();
     }
 
     /* Variables and their dependencies are now computed, hence internal edges
        between them can be removed. This will cause many variables to expire. */
     jitc_log(Debug, "jit_eval(): cleaning up..");
 
-    for (ScheduledVariable sv : schedule) {
-        uint32_t index = sv.index;
+    for (const ScheduledVariable &sv : schedule)
+        jitc_eval_finalize(sv);
 
-        auto it = state.variables.find(index);
-        if (it == state.variables.end())
-            continue;
-
-        Variable *v = &it.value();
-        v->reg_index = 0;
-        if (!(v->output_flag || v->side_effect))
-            continue;
+    jitc_log(Info, "jit_eval(): done.");
+}
 
-        if (unlikely(v->is_literal()))
-            jitc_fail("jit_eval(): internal error: did not expect a literal "
-                      "constant variable here!");
+/// Can the queued side effect 'index' write to the variable 'target'?
+static bool jitc_side_effect_writes(uint32_t index, uint32_t target) {
+    const Variable *v = state.variables.find(index);
+    if (!v || v->is_data())
+        return false;
 
-        jitc_lvn_drop(index, v);
+    switch ((VarKind) v->kind) {
+        case VarKind::Scatter:
+            return jitc_var(v->dep[0])->dep[3] == target;
 
-        if (v->free_stmt) {
-            free(v->stmt);
-            v->stmt = nullptr;
-            v->free_stmt = false;
-        }
+        case VarKind::ScatterKahan: {
+                const Extra &e = state.extra[index];
+                return jitc_var(e.dep[0])->dep[3] == target ||
+                       jitc_var(e.dep[1])->dep[3] == target;
+            }
 
-        if (v->output_flag && v->size == sv.size) {
-            v->kind = (uint32_t) VarKind::Data;
-            v->data = sv.data;
-            v->output_flag = false;
-        }
+        case VarKind::Printf:
+            return false;
 
-        if (unlikely(v->extra)) {
-            auto it2 = state.extra.find(index);
-            if (it2 == state.extra.end())
-                jitc_fail("jit_eval(): could not find 'extra' record of variable %u", index);
-            const Extra &extra = it2->second;
+        default:
+            // Loops, vcalls, etc.: could write anywhere
+            return true;
+    }
+}
 
-            if (extra.callback) {
-                if (extra.callback_internal) {
-                    extra.callback(index, 0, extra.callback_data);
-                } else {
-                    unlock_guard guard_2(state.lock);
-                    extra.callback(index, 0, extra.callback_data);
-                }
-                v = jitc_var(index);
-            }
+void jitc_eval_dirty(ThreadState *ts, const uint32_t *indices, size_t n) {
+    std::vector<uint32_t> targets;
+    for (size_t i = 0; i < n; ++i) {
+        if (indices[i] && jitc_var(indices[i])->is_dirty())
+            targets.push_back(indices[i]);
+    }
 
-            state.extra[index].assemble = nullptr;
-        }
+    if (targets.empty())
+        return;
 
-        uint32_t dep[4], side_effect = v->side_effect;
-        memcpy(dep, v->dep, sizeof(uint32_t) * 4);
-        memset(v->dep, 0, sizeof(uint32_t) * 4);
-        v->side_effect = false;
+    // Partition the side effect queue, preserving the original order
+    std::vector<uint32_t> selected, remaining;
+    for (uint32_t index : ts->side_effects) {
+        bool writes = false;
+        for (uint32_t target : targets)
+            writes |= jitc_side_effect_writes(index, target);
+        (writes ? selected : remaining).push_back(index);
+    }
 
-        if (side_effect)
-            jitc_var_dec_ref(index);
+    jitc_log(Debug,
+             "jit_eval_dirty(): evaluating %zu/%zu queued side effect%s, "
+             "deferring %zu scheduled variable%s.",
+             selected.size(), ts->side_effects.size(),
+             ts->side_effects.size() == 1 ? "" : "s", ts->scheduled.size(),
+             ts->scheduled.size() == 1 ? "" : "s");
+
+    std::vector<uint32_t> scheduled;
+    scheduled.swap(ts->scheduled);
+    ts->side_effects.swap(selected);
+
+    // Re-queue the deferred work (and anything that was added in the meantime)
+    auto restore = [&]() {
+        scheduled.insert(scheduled.end(), ts->scheduled.begin(),
+                         ts->scheduled.end());
+        remaining.insert(remaining.end(), ts->side_effects.begin(),
+                         ts->side_effects.end());
+        ts->scheduled.swap(scheduled);
+        ts->side_effects.swap(remaining);
+    };
 
-        for (int j = 0; j < 4; ++j)
-            jitc_var_dec_ref(dep[j]);
+    try {
+        jitc_eval(ts);
+    } catch (...) {
+        restore();
+        throw;
     }
 
-    jitc_log(Info, "jit_eval(): done.");
+    restore();
 }
 
 static ProfilerRegion profiler_region_assemble_func("jit_assemble_func");
 
-XXH128_hash_t
-jitc_assemble_func(ThreadState *ts, const char *name, uint32_t inst_id,
-                   uint32_t in_size, uint32_t in_align, uint32_t out_size,
-                   uint32_t out_align, uint32_t data_offset,
-                   const tsl::robin_map<uint64_t, uint32_t, UInt64Hasher> &data_map,
-                   uint32_t n_in, const uint32_t *in, uint32_t n_out,
-                   const uint32_t *out_nested, uint32_t n_se,
-                   const uint32_t *se, bool use_self) {
-    ProfilerPhase profiler(profiler_region_assemble_func);
-
-    visited.clear();
+uint32_t jitc_assemble_func_schedule(ThreadState *ts, uint32_t n_in,
+                                     const uint32_t *in, uint32_t n_out,
+                                     const uint32_t *out_nested, uint32_t n_se,
+                                     const uint32_t *se) {
     schedule.clear();
+    traverse_epoch = traverse_epoch_base = jitc_var_epoch_new();
 
     for (uint32_t i = 0; i < n_in; ++i) {
         if (in[i] == 0)
             continue;
 
-        const Variable *v = jitc_var(in[i]);
+        // Mark inputs as visited so that the traversal stops there
+        Variable *v = jitc_var(in[i]);
         if (!v->is_literal())
-            visited.emplace(1, in[i]);
+            v->cold().visit_epoch = traverse_epoch;
     }
 
     auto traverse = [](uint32_t index) {
@@ -774,7 +2028,7 @@ jitc_assemble_func(ThreadState *ts, const char *name, uint32_t inst_id,
             return;
         jitc_var_traverse(1, index);
         Variable *v = jitc_var(index);
-        v->output_flag = (VarType) v->type != VarType::Void;
+        v->cold().output_flag = (VarType) v->type != VarType::Void;
     };
 
     for (uint32_t i = 0; i < n_out; ++i)
@@ -791,23 +2045,32 @@ jitc_assemble_func(ThreadState *ts, const char *name, uint32_t inst_id,
 
     uint32_t n_regs = ts->backend == JitBackend::CUDA ? 4 : 1;
 
+    /* LLVM: number the inputs of the callable by their parameter offset. This
+       gives them the same register in every instance of a vcall, which in
+       turn permits generating the instances in parallel. */
+    bool fixed_inputs = ts->backend == JitBackend::LLVM;
+    if (fixed_inputs) {
+        for (auto &sv : schedule) {
+            Variable *v = jitc_var(sv.index);
+            if (!v->vcall_iface)
+                continue;
+            v->cold().reg_index = 1 + v->cold().param_offset;
+            n_regs = std::max(n_regs, v->cold().reg_index + 1);
+        }
+    }
+
     for (auto &sv : schedule) {
         Variable *v = jitc_var(sv.index);
-        v->reg_index = n_regs++;
+        if (fixed_inputs && v->vcall_iface)
+            continue;
+        v->cold().reg_index = n_regs++;
     }
 
-    size_t kernel_offset = buffer.size();
-
-    callable_depth++;
-    if (ts->backend == JitBackend::CUDA)
-        jitc_cuda_assemble_func(name, inst_id, n_regs, in_size, in_align,
-                                out_size, out_align, data_offset, data_map,
-                                n_out, out_nested, use_self);
-    else
-        jitc_llvm_assemble_func(name, inst_id, in_size, data_offset, data_map,
-                                n_out, out_nested, use_self);
-    callable_depth--;
+    return n_regs;
+}
 
+XXH128_hash_t jitc_assemble_func_register(ThreadState *ts, size_t kernel_offset,
+                                          uint32_t n_regs) {
     size_t kernel_length = buffer.size() - kernel_offset;
 
     if (jit_flag(JitFlag::VCallDeduplicate)) {
@@ -817,8 +2080,9 @@ jitc_assemble_func(ThreadState *ts, const char *name, uint32_t inst_id,
         kernel_hash.high64 = 0;
     }
 
-    if (globals_map.emplace(GlobalKey(kernel_hash, true),
-                            GlobalValue(globals.size(), kernel_length)).second) {
+    auto result = globals_map.emplace(GlobalKey(kernel_hash, true),
+                                      GlobalValue(globals.size(), kernel_length));
+    if (result.second) {
         // Replace '^'s in 'func_^^^..' or '__direct_callable__^^^..' with hash
         size_t hash_offset = strchr(buffer.get() + kernel_offset, '^') - buffer.get(),
                end_offset = buffer.size();
@@ -828,6 +2092,14 @@ jitc_assemble_func(ThreadState *ts, const char *name, uint32_t inst_id,
         buffer.put_q64_unchecked(kernel_hash.low64);
         buffer.rewind_to(end_offset);
 
+        /* Deduplicated LLVM callables without nested vcalls don't depend on
+           the kernel that calls them. Compile them once and share the result
+           between kernels (see jitc_llvm_link()) */
+        result.first->second.library =
+            ts->backend == JitBackend::LLVM &&
+            jit_flag(JitFlag::VCallDeduplicate) &&
+            !strstr(buffer.get() + kernel_offset, "@callables");
+
         n_ops_total += n_regs;
         callable_count_unique++;
         globals.put(buffer.get() + kernel_offset, kernel_length);
@@ -840,10 +2112,58 @@ jitc_assemble_func(ThreadState *ts, const char *name, uint32_t inst_id,
     return kernel_hash;
 }
 
+XXH128_hash_t
+jitc_assemble_func(ThreadState *ts, const char *name, uint32_t inst_id,
+                   uint32_t in_size, uint32_t in_align, uint32_t out_size,
+                   uint32_t out_align, uint32_t data_offset,
+                   const tsl::robin_map<uint64_t, uint32_t, UInt64Hasher> &data_map,
+                   uint32_t n_in, const uint32_t *in, uint32_t n_out,
+                   const uint32_t *out_nested, uint32_t n_se,
+                   const uint32_t *se, bool use_self) {
+    ProfilerPhase profiler(profiler_region_assemble_func);
+
+    uint32_t n_regs = jitc_assemble_func_schedule(ts, n_in, in, n_out,
+                                                  out_nested, n_se, se);
+
+    size_t kernel_offset = buffer.size();
+
+    callable_depth++;
+    if (ts->backend == JitBackend::CUDA)
+        jitc_cuda_assemble_func(name, inst_id, n_regs, in_size, in_align,
+                                out_size, out_align, data_offset, data_map,
+                                n_out, out_nested, use_self);
+    else
+        jitc_llvm_assemble_func(name, inst_id, in_size, data_offset, data_map,
+                                n_out, out_nested, use_self, schedule);
+    callable_depth--;
+
+    return jitc_assemble_func_register(ts, kernel_offset, n_regs);
+}
+
+/// See jitc_register_global_defer()
+static thread_local StringBuffer *globals_deferred = nullptr;
+
 /// Register a global declaration that will be included in the final program
 void jitc_register_global(const char *str) {
     size_t length = strlen(str);
+    if (unlikely(globals_deferred)) {
+        globals_deferred->put(str, length + 1);
+        return;
+    }
+
     if (globals_map.emplace(GlobalKey(XXH128(str, length, 0), false),
                             GlobalValue(globals.size(), length)).second)
         globals.put(str, length);
 }
+
+void jitc_register_global_defer(StringBuffer *out) {
+    globals_deferred = out;
+}
+
+void jitc_register_globals(const char *str, size_t size) {
+    const char *end = str + size;
+    while (str < end) {
+        jitc_register_global(str);
+        str += strlen(str) + 1;
+    }
+}
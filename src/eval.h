@@ -15,22 +15,25 @@
 
 /// A single variable that is scheduled to execute for a launch with 'size' entries
 struct ScheduledVariable {
-    uint32_t size;
+    uint64_t size;
     uint32_t index;
     uint32_t scope;
     void *data;
 
-    ScheduledVariable(uint32_t size, uint32_t scope, uint32_t index)
+    ScheduledVariable(uint64_t size, uint32_t scope, uint32_t index)
         : size(size), index(index), scope(scope), data(nullptr) { }
 };
 
 /// Start and end index of a group of variables that will be merged into the same kernel
 struct ScheduledGroup {
-    uint32_t size;
+    uint64_t size;
     uint32_t start;
     uint32_t end;
 
-    ScheduledGroup(uint32_t size, uint32_t start, uint32_t end)
+    /// Must this kernel wait for the previous one? (see jitc_eval_split())
+    bool chained = false;
+
+    ScheduledGroup(uint64_t size, uint32_t start, uint32_t end)
         : size(size), start(start), end(end) { }
 };
 
@@ -59,8 +62,11 @@ struct GlobalValue {
     /// Index within the callable list, if applicable
     uint32_t callable_index;
 
+    /// Is this a callable that is compiled separately (see jitc_llvm_link())?
+    bool library;
+
     GlobalValue(size_t start, size_t length)
-        : start(start), length(length), callable_index(0) { }
+        : start(start), length(length), callable_index(0), library(false) { }
 };
 
 /// Cache data structure for global declarations
@@ -79,8 +85,8 @@ extern char kernel_name[52];
 extern bool uses_optix;
 
 /// Size and alignment of auxiliary buffer needed by virtual function calls
-extern int32_t alloca_size;
-extern int32_t alloca_align;
+extern thread_local int32_t alloca_size;
+extern thread_local int32_t alloca_align;
 
 /// Number of tentative callables that were assembled in the kernel being compiled
 extern uint32_t callable_count;
@@ -97,9 +103,63 @@ extern std::vector<ScheduledVariable> schedule;
 /// Groups of variables with the same size
 extern std::vector<ScheduledGroup> schedule_groups;
 
+/// Scatter-reduction that is privatized per worker thread (LLVM only)
+struct PrivateScatter {
+    /// Position of the target pointer in the kernel parameter array
+    uint32_t slot;
+
+    /// Number of entries of the target array
+    uint32_t size;
+
+    VarType type;
+    ReduceOp op;
+};
+
+/// Privatized scatter-reductions of the last assembled kernel
+extern std::vector<PrivateScatter> private_scatters;
+
+/// Lane reordering of an LLVM kernel with an incoherent vcall (see jitc_run_coherent())
+struct CoherentDispatch {
+    /// Parameter slot of the 'self' array of the virtual function call
+    uint32_t self_slot = 0;
+
+    /// Parameter slot that receives the lane permutation (0: disabled)
+    uint32_t perm_slot = 0;
+};
+
+/// Coherent dispatch settings of the last assembled kernel
+extern CoherentDispatch coherent_dispatch;
+
 /// Evaluate all computation that is queued on the current thread
 extern void jitc_eval(ThreadState *ts);
 
+/// Set the vector width of LLVM kernels (see jit_llvm_set_kernel_width())
+extern void jitc_llvm_set_kernel_width(uint32_t width, bool autotune);
+
+/**
+ * \brief Check if the floating point addition \c v of \c a0 and \c a1 should
+ * be generated as a fused multiply-add (see \ref JitFlag::ContractFma)
+ *
+ * Returns the product operand and sets \c other to the remaining operand, or
+ * returns \c nullptr. This check runs while assembling a kernel, where the
+ * reference count of the product accounts for all of its users. The product
+ * is only contracted when the addition is its sole user, which ensures that
+ * the multiplication is never computed twice.
+ */
+extern const Variable *jitc_fma_contract(const Variable *v, const Variable *a0,
+                                         const Variable *a1,
+                                         const Variable *&other);
+
+/**
+ * \brief Evaluate the queued side effects that write to any of the given
+ * (dirty) variables
+ *
+ * Unrelated side effects and scheduled variables remain queued so that they
+ * can be merged into a later kernel launch.
+ */
+extern void jitc_eval_dirty(ThreadState *ts, const uint32_t *indices,
+                            size_t n);
+
 /// Used by jitc_eval() to generate PTX source code
 extern void jitc_cuda_assemble(ThreadState *ts, ScheduledGroup group,
                                uint32_t n_regs, uint32_t n_params);
@@ -107,6 +167,9 @@ extern void jitc_cuda_assemble(ThreadState *ts, ScheduledGroup group,
 /// Used by jitc_eval() to generate LLVM IR source code
 extern void jitc_llvm_assemble(ThreadState *ts, ScheduledGroup group);
 
+/// Append metadata and function attributes shared by all LLVM modules
+extern void jitc_llvm_render_attributes(StringBuffer &out);
+
 /// Used by jitc_vcall() to generate source code for vcalls
 extern XXH128_hash_t
 jitc_assemble_func(ThreadState *ts, const char *name, uint32_t inst_id,
@@ -132,7 +195,37 @@ jitc_llvm_assemble_func(const char *name, uint32_t inst_id,
                         uint32_t in_size, uint32_t data_offset,
                         const tsl::robin_map<uint64_t, uint32_t, UInt64Hasher> &data_map,
                         uint32_t n_out, const uint32_t *out_nested,
-                        bool use_self);
+                        bool use_self,
+                        const std::vector<ScheduledVariable> &func_schedule);
+
+/**
+ * \brief Traverse the body of a callable and assign registers
+ *
+ * The variables are appended to 'schedule' (which must be empty). Returns the
+ * number of registers. Part of jitc_assemble_func(), exposed so that
+ * jitc_var_vcall_assemble() can generate callables in parallel.
+ */
+extern uint32_t jitc_assemble_func_schedule(ThreadState *ts, uint32_t n_in,
+                                            const uint32_t *in, uint32_t n_out,
+                                            const uint32_t *out_nested,
+                                            uint32_t n_se, const uint32_t *se);
+
+/// Deduplicate the callable at 'offset' of 'buffer' and move it to 'globals'
+extern XXH128_hash_t jitc_assemble_func_register(ThreadState *ts,
+                                                 size_t offset,
+                                                 uint32_t n_regs);
 
 /// Register a global declaration that will be included in the final program
 extern void jitc_register_global(const char *str);
+
+/**
+ * \brief Redirect jitc_register_global() on the calling thread
+ *
+ * While set, declarations are appended to 'out' (each followed by a zero byte)
+ * instead of being registered. Used by worker threads generating callables,
+ * whose declarations are later passed to \ref jitc_register_globals().
+ */
+extern void jitc_register_global_defer(StringBuffer *out);
+
+/// Register a sequence of zero-separated declarations
+extern void jitc_register_globals(const char *str, size_t size);
@@ -107,7 +107,12 @@ inline size_t hash_str(const char *str) {
 }
 
 inline XXH128_hash_t hash_kernel(const char *str) {
-    const char *offset = strstr(str, "body:");
+    /* Skip the kernel name. LLVM kernels may compute uniform values in the
+       'entry' block that precedes the main loop, which must be hashed. */
+    const char *offset = strstr(str, "body:"),
+               *entry  = strstr(str, "entry:");
+    if (entry && (!offset || entry < offset))
+        offset = entry;
     if (unlikely(!offset)) {
         offset = strchr(str, '{');
         if (unlikely(!offset))
@@ -13,6 +13,7 @@
 #include "log.h"
 #include "registry.h"
 #include "var.h"
+#include "op.h"
 #include "profiler.h"
 #include <sys/stat.h>
 
@@ -52,12 +53,12 @@ __itt_domain *drjit_domain = __itt_domain_create("drjit");
 #endif
 
 static_assert(
-    sizeof(VariableKey) == 9 * sizeof(uint32_t),
+    sizeof(VariableKey) == 10 * sizeof(uint32_t),
     "VariableKey: incorrect size, likely an issue with padding/packing!");
 
 static_assert(
-    sizeof(tsl::detail_robin_hash::bucket_entry<VariableMap::value_type, false>) == 64,
-    "VariableMap: incorrect bucket size, likely an issue with padding/packing!");
+    sizeof(Variable) == 48 && sizeof(VariableCold) == 16,
+    "Variable: incorrect size, likely an issue with padding/packing!");
 
 static ProfilerRegion profiler_region_init("jit_init");
 
@@ -133,6 +134,7 @@ void jitc_init(uint32_t backends) {
 
     state.kernel_hard_misses = state.kernel_soft_misses = 0;
     state.kernel_hits = state.kernel_launches = 0;
+    jitc_rewrite_clear_statistics();
 }
 
 void* jitc_cuda_stream() {
@@ -184,6 +186,7 @@ void jitc_shutdown(int light) {
         state.kernel_cache.clear();
     }
 
+    jitc_llvm_free_library();
     state.kernel_history.clear();
 
     // CUDA: Try to already free some memory asynchronously (faster)
@@ -244,9 +247,9 @@ void jitc_shutdown(int light) {
         if (state.variables.empty() && !state.lvn_map.empty()) {
             for (auto &kv: state.lvn_map)
                 jitc_log(Warn,
-                        " - id=%u: size=%u, type=%s, dep=[%u, "
+                        " - id=%u: size=%zu, type=%s, dep=[%u, "
                         "%u, %u, %u]",
-                        kv.second, kv.first.size, type_name[kv.first.type],
+                        kv.second, (size_t) kv.first.size, type_name[kv.first.type],
                         kv.first.dep[0], kv.first.dep[1], kv.first.dep[2],
                         kv.first.dep[3]);
 
@@ -263,28 +266,26 @@ void jitc_shutdown(int light) {
 
     if (std::max(state.log_level_stderr, state.log_level_callback) >= LogLevel::Warn) {
         uint32_t n_leaked = 0;
-        for (auto &var : state.variables) {
+        state.variables.for_each([&](uint32_t index, const Variable &v) {
             if (n_leaked == 0)
                 jitc_log(Warn, "jit_shutdown(): detected variable leaks:");
             if (n_leaked < 10)
                 jitc_log(Warn,
                          " - variable r%u is still being referenced! "
-                         "(ref=%u, ref_se=%u, type=%s, size=%u, "
-                         "stmt=\"%s\", dep=[%u, %u, %u, %u])",
-                         var.first,
-                         (uint32_t) var.second.ref_count,
-                         (uint32_t) var.second.ref_count_se,
-                         type_name[var.second.type],
-                         var.second.size,
-                         var.second.is_literal()
-                             ? "<value>"
-                             : (var.second.stmt ? var.second.stmt : "<null>"),
-                         var.second.dep[0], var.second.dep[1],
-                         var.second.dep[2], var.second.dep[3]);
+                         "(ref=%u, ref_se=%u, type=%s, size=%zu, "
+                         "kind=%s, dep=[%u, %u, %u, %u])",
+                         index,
+                         (uint32_t) v.ref_count,
+                         (uint32_t) v.ref_count_se,
+                         type_name[v.type],
+                         (size_t) v.size,
+                         var_kind_name[v.kind],
+                         v.dep[0], v.dep[1],
+                         v.dep[2], v.dep[3]);
             else if (n_leaked == 10)
                 jitc_log(Warn, " - (skipping remainder)");
             ++n_leaked;
-        }
+        });
 
         if (n_leaked > 0)
             jitc_log(Warn, "jit_shutdown(): %u variables are still referenced!", n_leaked);
@@ -15,6 +15,7 @@
 #include "llvm.h"
 #include "alloc.h"
 #include "io.h"
+#include <atomic>
 #include <deque>
 #include <string.h>
 #include <inttypes.h>
@@ -35,9 +36,6 @@ enum VarKind : uint32_t {
     // An evaluated node representing data
     Data,
 
-    // Legacy string-based IR statement
-    Stmt,
-
     // A literal constant
     // (note: this must be the last enumeration entry before the regular nodes start)
     Literal,
@@ -81,7 +79,7 @@ enum VarKind : uint32_t {
     // Fast approximations
     Rcp, Rsqrt,
 
-    // Multi-function generator (CUDA)
+    // Transcendental functions (CUDA: multi-function generator, LLVM: polynomials)
     Sin, Cos, Exp2, Log2,
 
     // Casts
@@ -117,12 +115,23 @@ enum VarKind : uint32_t {
     // Extract a component from an operation that produced multiple results
     Extract,
 
+    // Copy a variable into a new register (e.g. to change its size)
+    Copy,
+
+    // Markers denoting the start, condition, and end of a recorded loop
+    LoopStart, LoopCond, LoopEnd,
+
+    // Phi node representing the state of a loop variable (LLVM)
+    LoopPhi,
+
     // Denotes the number of different node types
     Count
 };
 
 #pragma pack(push, 1)
 
+struct VariableCold;
+
 /// Central variable data structure, which represents an assignment in SSA form
 struct Variable {
     #if defined(__GNUC__)
@@ -172,20 +181,14 @@ struct Variable {
 
         /// Pointer to device memory. Used when kind == VarKind::Data
         void *data;
-
-        // Legacy string-based IR (to be removed)
-        char *stmt;
     };
 
     /// Number of entries
-    uint32_t size;
-
-    /// Unused, to be eventually used to upgrade to 64 bit array sizes
-    uint32_t unused;
+    uint64_t size;
 
     // ================  Essential flags used in the LVN key  =================
 
-    // Variable kind (IR statement / literal constant / data)
+    // Variable kind (IR node / literal constant / data)
     uint32_t kind : 8;
 
     /// Backend associated with this variable
@@ -197,9 +200,6 @@ struct Variable {
     /// Is this a pointer variable that is used to write to some array?
     uint32_t write_ptr : 1;
 
-    /// Free the 'stmt' variables at destruction time?
-    uint32_t free_stmt : 1;
-
     // =======================  Miscellaneous fields =========================
 
     /// If set, 'data' will not be deallocated when the variable is destructed
@@ -223,22 +223,11 @@ struct Variable {
     /// If set, evaluation will have side effects on other variables
     uint32_t side_effect : 1;
 
-    // =========== Entries that are temporarily used in jitc_eval() ============
-
-    /// Argument type
-    uint32_t param_type : 2;
-
-    /// Is this variable marked as an output?
-    uint32_t output_flag : 1;
+    /// Does this scatter operation have unique indices? (jit_var_scatter_unique())
+    uint32_t unique_index : 1;
 
     /// Unused for now
-    uint32_t unused_2 : 6;
-
-    /// Offset of the argument in the list of kernel parameters
-    uint32_t param_offset;
-
-    /// Register index
-    uint32_t reg_index;
+    uint32_t unused_2 : 9;
 
     // ========================  Side effect tracking  =========================
 
@@ -249,55 +238,71 @@ struct Variable {
 
     bool is_data()    const { return kind == (uint32_t) VarKind::Data;    }
     bool is_literal() const { return kind == (uint32_t) VarKind::Literal; }
-    bool is_stmt()    const { return kind == (uint32_t) VarKind::Stmt;    }
     bool is_node()    const { return (uint32_t) kind > VarKind::Literal; }
     bool is_dirty()   const { return ref_count_se > 0; }
+
+    /**
+     * \brief Return the entries that are only used during kernel assembly
+     *
+     * Only valid for variables that reside in 'State::variables'.
+     */
+    VariableCold &cold() const;
+};
+
+/**
+ * \brief Entries of a variable that are temporarily used in jitc_eval()
+ *
+ * These are kept apart from the 'Variable' record so that graph traversal and
+ * reference counting touch fewer cache lines (see \ref VariableTable).
+ */
+struct VariableCold {
+    /// Offset of the argument in the list of kernel parameters
+    uint32_t param_offset;
+
+    /// Register index
+    uint32_t reg_index;
+
+    /// Argument type
+    uint32_t param_type : 2;
+
+    /// Is this variable marked as an output?
+    uint32_t output_flag : 1;
+
+    /// Unused for now
+    uint32_t unused : 29;
+
+    /// Epoch of the last graph traversal that visited this variable
+    uint32_t visit_epoch;
 };
 
 /// Abbreviated version of the Variable data structure
 struct VariableKey {
-    uint32_t size;
+    uint64_t size;
     uint32_t scope;
     uint32_t dep[4];
     uint32_t kind      : 8;
     uint32_t backend   : 2;
     uint32_t type      : 4;
     uint32_t write_ptr : 1;
-    uint32_t free_stmt : 1;
-    uint32_t unused    : 16;
-
-    union {
-        uint64_t literal;
-        char *stmt;
-    };
+    uint32_t unused    : 17;
+    uint64_t literal;
 
     VariableKey(const Variable &v) {
         size = v.size;
         scope = v.scope;
         for (int i = 0; i < 4; ++i)
             dep[i] = v.dep[i];
-        if (v.is_stmt())
-            stmt = v.stmt;
-        else
-            literal = v.literal;
-
+        literal = v.literal;
         kind = v.kind;
         backend = v.backend;
         type = v.type;
         write_ptr = v.write_ptr;
-        free_stmt = v.free_stmt;
         unused = 0;
     }
 
     bool operator==(const VariableKey &v) const {
-        if (memcmp(this, &v, 7 * sizeof(uint32_t)) != 0)
-            return false;
-        if ((VarKind) kind != VarKind::Stmt)
-            return literal == v.literal;
-        else if (!free_stmt)
-            return stmt == v.stmt;
-        else
-            return stmt == v.stmt || strcmp(stmt, v.stmt) == 0;
+        return memcmp(this, &v, 8 * sizeof(uint32_t)) == 0 &&
+               literal == v.literal;
     }
 };
 
@@ -306,18 +311,10 @@ struct VariableKey {
 /// Helper class to hash VariableKey instances
 struct VariableKeyHasher {
     size_t operator()(const VariableKey &k) const {
-        uint64_t hash_1;
-        if ((VarKind) k.kind != VarKind::Stmt)
-            hash_1 = k.literal;
-        else if (!k.free_stmt)
-            hash_1 = (uintptr_t) k.stmt;
-        else
-            hash_1 = hash_str(k.stmt);
-
-        uint32_t buf[7];
-        size_t size = 7 * sizeof(uint32_t);
+        uint32_t buf[8];
+        size_t size = 8 * sizeof(uint32_t);
         memcpy(buf, &k, size);
-        return hash(buf, size, hash_1);
+        return hash(buf, size, k.literal);
     }
 };
 
@@ -510,12 +507,95 @@ struct ThreadState {
 #endif
 };
 
-/// Maps from variable ID to a Variable instance
-using VariableMap =
-    tsl::robin_map<uint32_t, Variable, UInt32Hasher,
-                   std::equal_to<uint32_t>,
-                   aligned_allocator<std::pair<uint32_t, Variable>, 64>,
-                   /* StoreHash = */ false>;
+/**
+ * \brief Dense storage that maps variable IDs to Variable instances
+ *
+ * Variable IDs are handed out sequentially by 'State::variable_index' and are
+ * not reused until the counter wraps around. Loops and virtual function calls
+ * rely on this: they determine the variables created while recording from ID
+ * ranges and detect freed variables via failed lookups. The table is
+ * therefore indexed directly by ID, without hashing.
+ *
+ * Storage is organized in chunks of 'ChunkSize' consecutive IDs. Each chunk
+ * is a single allocation that is aligned to its size and holds the 'Variable'
+ * records followed by the corresponding 'VariableCold' records, which lets
+ * 'Variable::cold()' find the latter using pointer arithmetic. Once all
+ * variables of a chunk have been freed, its storage goes to a small free list
+ * for reuse by later chunks.
+ */
+class VariableTable {
+public:
+    static constexpr uint32_t ChunkShift = 12;
+    static constexpr uint32_t ChunkSize = 1u << ChunkShift;
+    static constexpr uint32_t FreeListSize = 8;
+
+    struct Chunk {
+        Variable hot[ChunkSize];
+        VariableCold cold[ChunkSize];
+    };
+
+    VariableTable() = default;
+    VariableTable(const VariableTable &) = delete;
+    VariableTable &operator=(const VariableTable &) = delete;
+    ~VariableTable() { clear(); }
+
+    /// Look up a variable, returns \c nullptr if it does not exist
+    Variable *find(uint32_t index) const {
+        uint32_t chunk = index >> ChunkShift;
+        if (unlikely(chunk >= m_chunks.size() || !m_chunks[chunk]))
+            return nullptr;
+        Variable *v = &m_chunks[chunk]->hot[index & (ChunkSize - 1)];
+        return v->kind != (uint32_t) VarKind::Invalid ? v : nullptr;
+    }
+
+    /// Insert a copy of 'v', returns \c nullptr if 'index' is already taken
+    Variable *insert(uint32_t index, const Variable &v);
+
+    /// Remove a variable
+    void erase(uint32_t index);
+
+    /// Number of variables
+    size_t size() const { return m_size; }
+
+    /// Are there no variables?
+    bool empty() const { return m_size == 0; }
+
+    /// Memory used by the table (in bytes)
+    size_t memory() const;
+
+    /// Remove all variables and release the underlying memory
+    void clear();
+
+    /// Invoke 'func(index, variable)' for every variable
+    template <typename Func> void for_each(Func func) const {
+        for (size_t i = 0; i < m_chunks.size(); ++i) {
+            Chunk *chunk = m_chunks[i];
+            if (!chunk)
+                continue;
+            for (uint32_t j = 0; j < ChunkSize; ++j) {
+                Variable &v = chunk->hot[j];
+                if (v.kind != (uint32_t) VarKind::Invalid)
+                    func((uint32_t) ((i << ChunkShift) + j), v);
+            }
+        }
+    }
+
+private:
+    void release(uint32_t chunk_id);
+
+private:
+    std::vector<Chunk *> m_chunks;
+    std::vector<uint32_t> m_chunk_size;
+    std::vector<Chunk *> m_free;
+    size_t m_size = 0;
+};
+
+inline VariableCold &Variable::cold() const {
+    constexpr uintptr_t Mask = sizeof(VariableTable::Chunk) - 1;
+    uintptr_t base = (uintptr_t) this & ~Mask;
+    uint32_t slot = (uint32_t) (((uintptr_t) this & Mask) / sizeof(Variable));
+    return ((VariableTable::Chunk *) base)->cold[slot];
+}
 
 /// Key data structure for kernel source code & device ID
 struct KernelKey {
@@ -661,7 +741,7 @@ struct State {
     Lock alloc_free_lock;
 
     /// Stores the mapping from variable indices to variables
-    VariableMap variables;
+    VariableTable variables;
 
     /// Counter to create variable scopes that enforce a variable ordering
     uint32_t scope_ctr = 0;
@@ -716,12 +796,40 @@ struct State {
     /// Limit the output of jit_var_str()?
     uint32_t print_limit = 20;
 
+    /// Split kernels with more operations than this (0: disabled)
+    uint32_t kernel_split_ops = 100000;
+
+    /// Split kernels with more simultaneously live values than this (0: disabled)
+    uint32_t kernel_split_live = 0;
+
+    /// Emit software prefetches for gathers in LLVM kernels?
+    bool llvm_prefetch = false;
+
+    /// Prefetch distance in packets (0: automatic)
+    uint32_t llvm_prefetch_distance = 0;
+
+    /// Divergence threshold of coherent vcall dispatch (0: disabled)
+    float llvm_vcall_coherence = 0.f;
+
+    /// Vector width of LLVM kernels (0: use the width of the target)
+    uint32_t llvm_kernel_width = 0;
+
+    /// Time LLVM kernels at two vector widths and keep the faster one?
+    bool llvm_autotune = false;
+
+    /// Number of packets processed per loop iteration of LLVM kernels
+    uint32_t llvm_unroll = 1;
+
     /// Statistics on kernel launches
     size_t kernel_hard_misses = 0;
     size_t kernel_soft_misses = 0;
     size_t kernel_hits = 0;
     size_t kernel_launches = 0;
 
+    /// Statistics on applied rewrite rules (see JitFlag::Simplify). Atomic,
+    /// since FMA contraction is counted during parallel callable assembly
+    std::atomic<size_t> rewrite_count[(int) JitRewrite::Count] { };
+
     /// Cache of previously compiled kernels
     KernelCache kernel_cache;
 
@@ -925,4 +1033,19 @@ inline bool jitc_is_one(Variable *v) {
     return v->literal == one;
 }
 
+inline bool jitc_is_two(Variable *v) {
+    if (!v->is_literal())
+        return false;
+
+    uint64_t two;
+    switch ((VarType) v->type) {
+        case VarType::Float16: two = 0x4000ull; break;
+        case VarType::Float32: two = 0x40000000ull; break;
+        case VarType::Float64: two = 0x4000000000000000ull; break;
+        default: two = 2; break;
+    }
+
+    return v->literal == two;
+}
+
 extern const char *var_kind_name[(int) VarKind::Count];
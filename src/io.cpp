@@ -368,7 +368,9 @@ bool jitc_kernel_write(const char *source, uint32_t source_size,
         uintptr_t *reloc_out = (uintptr_t *) (temp_in + header.source_size + 
                                               header.kernel_size + padding_size);
         for (uint32_t i = 0; i < kernel.llvm.n_reloc; ++i)
-            reloc_out[i] = (uintptr_t) kernel.llvm.reloc[i] - (uintptr_t) kernel.data;
+            reloc_out[i] = kernel.llvm.reloc[i]
+                ? (uintptr_t) kernel.llvm.reloc[i] - (uintptr_t) kernel.data
+                : 0; // unresolved library callable, see jitc_llvm_link()
     }
 
     LZ4_stream_t stream;
@@ -477,4 +479,5 @@ void jitc_flush_kernel_cache() {
     }
 
     state.kernel_cache.clear();
+    jitc_llvm_free_library();
 }
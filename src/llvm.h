@@ -70,18 +70,34 @@ extern bool jitc_llvm_orcv2_init();
 extern void jitc_llvm_mcjit_shutdown();
 extern void jitc_llvm_orcv2_shutdown();
 
-/// Run the MCJIT/ORCv2-based compiler on the given module
-extern void jitc_llvm_mcjit_compile(void *llvm_module,
+/**
+ * \brief Run the MCJIT/ORCv2-based compiler on the given module
+ *
+ * Resolves the function `name` and, if `callables` is set, the `@callables`
+ * table along with all callables of the kernel being compiled.
+ */
+extern void jitc_llvm_mcjit_compile(void *llvm_module, const char *name,
+                                    bool callables,
                                     std::vector<uint8_t *> &symbols);
-extern void jitc_llvm_orcv2_compile(void *llvm_module,
+extern void jitc_llvm_orcv2_compile(void *llvm_module, const char *name,
+                                    bool callables,
                                     std::vector<uint8_t *> &symbols);
 
 /// Compile the current IR string and store the resulting kernel into `kernel`
 extern void jitc_llvm_compile(Kernel &kernel);
 
+/// Fill the `@callables` table of `kernel` with separately compiled callables
+extern void jitc_llvm_link(Kernel &kernel);
+
+/// Release all separately compiled callables
+extern void jitc_llvm_free_library();
+
 /// Dump disassembly for the given kernel
 extern void jitc_llvm_disasm(const Kernel &kernel);
 
+/// Change the vector width used by code generation (see jitc_assemble())
+extern void jitc_llvm_set_width(uint32_t width);
+
 /// Override the target architecture
 extern void jitc_llvm_set_target(const char *target_cpu,
                                  const char *target_features,
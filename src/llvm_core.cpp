@@ -22,6 +22,7 @@
 #include "var.h"
 #include "eval.h"
 #include "profiler.h"
+#include "io.h"
 
 static bool jitc_llvm_init_attempted  = false;
 static bool jitc_llvm_init_success    = false;
@@ -31,6 +32,12 @@ static LLVMPassManagerRef jitc_llvm_pass_manager = nullptr;
 static LLVMDisasmContextRef jitc_llvm_disasm_ctx = nullptr;
 static LLVMContextRef jitc_llvm_context = nullptr;
 
+/// Separately compiled callables, indexed by the hash of their module
+static std::map<XXH128_hash_t, Kernel, XXH128Cmp> jitc_llvm_library;
+
+/// Scratch space for assembling library modules
+static StringBuffer jitc_llvm_library_buffer { 1000 };
+
 /// String describing the LLVM target
 char *jitc_llvm_target_triple = nullptr;
 
@@ -275,6 +282,13 @@ void jitc_llvm_set_target(const char *target_cpu,
     jitc_llvm_update_strings();
 }
 
+void jitc_llvm_set_width(uint32_t width) {
+    if (width == jitc_llvm_vector_width)
+        return;
+    jitc_llvm_vector_width = width;
+    jitc_llvm_update_strings();
+}
+
 /// Dump assembly representation
 void jitc_llvm_disasm(const Kernel &kernel) {
     if (std::max(state.log_level_stderr, state.log_level_callback) <
@@ -284,7 +298,9 @@ void jitc_llvm_disasm(const Kernel &kernel) {
     for (uint32_t i = 0; i < kernel.llvm.n_reloc; ++i) {
         uint8_t *func_base = (uint8_t *) kernel.llvm.reloc[i],
                 *ptr = func_base;
-        if (i == 1)
+        // Skip the @callables table and separately compiled callables
+        if (i == 1 || func_base < (uint8_t *) kernel.data ||
+            func_base >= (uint8_t *) kernel.data + kernel.size)
             continue;
         char ins_buf[256];
         bool last_nop = false;
@@ -320,13 +336,16 @@ void jitc_llvm_disasm(const Kernel &kernel) {
 
 static ProfilerRegion profiler_region_llvm_compile("jit_llvm_compile");
 
-void jitc_llvm_compile(Kernel &kernel) {
+/// Compile the module 'ir' and resolve the function 'name' (+ callables)
+static void jitc_llvm_compile_module(const char *ir, size_t size,
+                                     const char *name, bool callables,
+                                     Kernel &kernel) {
     ProfilerPhase phase(profiler_region_llvm_compile);
 
-    jitc_llvm_memmgr_prepare(buffer.size());
+    jitc_llvm_memmgr_prepare(size);
 
     LLVMMemoryBufferRef llvm_buf = LLVMCreateMemoryBufferWithMemoryRange(
-        buffer.get(), buffer.size(), kernel_name, 0);
+        ir, size, name, 0);
     if (unlikely(!llvm_buf))
         jitc_fail("jit_run_compile(): could not create memory buffer!");
 
@@ -336,7 +355,7 @@ void jitc_llvm_compile(Kernel &kernel) {
     LLVMParseIRInContext(jitc_llvm_context, llvm_buf, &llvm_module, &error);
     if (unlikely(error))
         jitc_fail("jit_llvm_compile(): parsing failed. Please see the LLVM "
-                  "IR and error message below:\n\n%s\n\n%s", buffer.get(), error);
+                  "IR and error message below:\n\n%s\n\n%s", ir, error);
     LLVMDisposeMessage(error);
 
 #if !defined(NDEBUG)
@@ -344,19 +363,18 @@ void jitc_llvm_compile(Kernel &kernel) {
     if (unlikely(status))
         jitc_fail("jit_llvm_compile(): module could not be verified! Please "
                   "see the LLVM IR and error message below:\n\n%s\n\n%s",
-                  buffer.get(), error);
+                  ir, error);
 #endif
     LLVMDisposeMessage(error);
 
     LLVMRunPassManager(jitc_llvm_pass_manager, llvm_module);
 
-    std::vector<uint8_t *> reloc(
-        callable_count_unique ? (callable_count_unique + 2) : 1);
+    std::vector<uint8_t *> reloc(callables ? (callable_count_unique + 2) : 1);
 
     if (jitc_llvm_use_orcv2)
-        jitc_llvm_orcv2_compile(llvm_module, reloc);
+        jitc_llvm_orcv2_compile(llvm_module, name, callables, reloc);
     else
-        jitc_llvm_mcjit_compile(llvm_module, reloc);
+        jitc_llvm_mcjit_compile(llvm_module, name, callables, reloc);
 
     if (jitc_llvm_memmgr_got)
         jitc_fail(
@@ -365,7 +383,7 @@ void jitc_llvm_compile(Kernel &kernel) {
             "by the target architecture. DrJit cannot handle this case "
             "and will terminate the application now. For reference, the "
             "following kernel code was responsible for this problem:\n\n%s",
-            buffer.get());
+            ir);
 
 #if !defined(_WIN32)
     void *ptr = mmap(nullptr, jitc_llvm_memmgr_offset, PROT_READ | PROT_WRITE,
@@ -386,16 +404,18 @@ void jitc_llvm_compile(Kernel &kernel) {
     kernel.llvm.n_reloc = (uint32_t) reloc.size();
     kernel.llvm.reloc = (void **) malloc_check(sizeof(void *) * reloc.size());
 
-    // Relocate function pointers
+    // Relocate function pointers (library callables are filled in later)
     for (size_t i = 0; i < reloc.size(); ++i)
-        kernel.llvm.reloc[i] = (uint8_t *) ptr + (reloc[i] - jitc_llvm_memmgr_data);
+        kernel.llvm.reloc[i] =
+            reloc[i] ? (uint8_t *) ptr + (reloc[i] - jitc_llvm_memmgr_data)
+                     : nullptr;
 
     // Write address of @callables
     if (kernel.llvm.n_reloc > 1)
         *((void **) kernel.llvm.reloc[1]) = kernel.llvm.reloc + 1;
 
 #if defined(DRJIT_ENABLE_ITTNOTIFY)
-    kernel.llvm.itt = __itt_string_handle_create(kernel_name);
+    kernel.llvm.itt = __itt_string_handle_create(name);
 #endif
 
 #if !defined(_WIN32)
@@ -407,3 +427,192 @@ void jitc_llvm_compile(Kernel &kernel) {
         jitc_fail("jit_llvm_compile(): VirtualProtect() failed: %u", GetLastError());
 #endif
 }
+
+void jitc_llvm_compile(Kernel &kernel) {
+    jitc_llvm_compile_module(buffer.get(), buffer.size(), kernel_name,
+                             callable_count_unique != 0, kernel);
+}
+
+/// Append the metadata and function attributes referenced by LLVM modules
+void jitc_llvm_render_attributes(StringBuffer &out) {
+    out.put("\n"
+            "!0 = !{!0}\n"
+            "!1 = !{!1, !0}\n"
+            "!2 = !{!1}\n"
+            "!3 = !{i32 1}\n"
+            "!4 = !{!\"llvm.loop.unroll.disable\", !\"llvm.loop.vectorize.enable\", i1 0}\n\n");
+
+    out.fmt_llvm(1,
+                 "attributes #0 = ${ norecurse nounwind \"frame-pointer\"=\"none\" "
+                 "\"no-builtins\" \"no-stack-arg-probe\" \"target-cpu\"=\"$s\" "
+                 "\"target-features\"=\"", jitc_llvm_target_cpu);
+
+#if !defined(__aarch64__)
+    out.put("-vzeroupper");
+    if (jitc_llvm_target_features)
+        out.put(",");
+#endif
+
+    if (jitc_llvm_target_features)
+        out.put(jitc_llvm_target_features, strlen(jitc_llvm_target_features));
+
+    out.put("\" }");
+}
+
+/// Collect the names of functions and variables defined by a global
+static void jitc_llvm_defined_names(const char *str, size_t length,
+                                    std::vector<std::string> &names) {
+    const char *end = str + length;
+    while (str < end) {
+        const char *eol = (const char *) memchr(str, '\n', end - str);
+        if (!eol)
+            eol = end;
+
+        if (*str == '@' || strncmp(str, "define", 6) == 0 ||
+            strncmp(str, "declare", 7) == 0) {
+            const char *p = (const char *) memchr(str, '@', eol - str);
+            if (p) {
+                const char *q = ++p;
+                while (q < eol && (isalnum(*q) || *q == '_' || *q == '.' || *q == '$'))
+                    ++q;
+                names.emplace_back(p, q - p);
+            }
+        }
+
+        str = eol + 1;
+    }
+}
+
+/// Does 'str' refer to the global '@name'?
+static bool jitc_llvm_references(const char *str, size_t length,
+                                 const std::string &name) {
+    const char *end = str + length;
+    while (str < end) {
+        const char *p = (const char *) memchr(str, '@', end - str);
+        if (!p)
+            break;
+        p++;
+        if ((size_t) (end - p) >= name.size() &&
+            memcmp(p, name.data(), name.size()) == 0) {
+            const char *q = p + name.size();
+            if (q == end ||
+                !(isalnum(*q) || *q == '_' || *q == '.' || *q == '$'))
+                return true;
+        }
+        str = p;
+    }
+    return false;
+}
+
+/// Assemble a standalone module containing the given callable
+static void jitc_llvm_assemble_library(const GlobalValue &value,
+                                       StringBuffer &out) {
+    struct Entry {
+        const GlobalValue *value;
+        std::vector<std::string> names;
+        bool used;
+    };
+
+    std::vector<Entry> entries;
+    for (auto const &it : globals_map) {
+        if (it.first.callable)
+            continue;
+        Entry e { &it.second, { }, false };
+        jitc_llvm_defined_names(globals.get() + it.second.start,
+                                it.second.length, e.names);
+        entries.push_back(std::move(e));
+    }
+
+    // Transitive closure of the globals referenced by the callable
+    std::vector<const GlobalValue *> todo { &value };
+    while (!todo.empty()) {
+        const GlobalValue *cur = todo.back();
+        todo.pop_back();
+        const char *str = globals.get() + cur->start;
+
+        for (Entry &e : entries) {
+            if (e.used)
+                continue;
+            for (const std::string &name : e.names) {
+                if (jitc_llvm_references(str, cur->length, name)) {
+                    e.used = true;
+                    todo.push_back(e.value);
+                    break;
+                }
+            }
+        }
+    }
+
+    for (const Entry &e : entries) {
+        if (!e.used)
+            continue;
+        out.put('\n');
+        out.put(globals.get() + e.value->start, e.value->length);
+        out.put('\n');
+    }
+
+    out.put('\n');
+    out.put(globals.get() + value.start, value.length);
+    out.put('\n');
+
+    jitc_llvm_render_attributes(out);
+}
+
+/// Return the address of a library callable, compiling it if needed
+static void *jitc_llvm_library_get(const GlobalKey &key,
+                                   const GlobalValue &value) {
+    StringBuffer &buf = jitc_llvm_library_buffer;
+    buf.clear();
+    jitc_llvm_assemble_library(value, buf);
+
+    /* The module also encodes the target CPU/features, which is why it is
+       used as the key instead of the callable hash */
+    XXH128_hash_t hash = XXH128(buf.get(), buf.size(), 0);
+
+    auto it = jitc_llvm_library.find(hash);
+    if (it != jitc_llvm_library.end())
+        return it->second.llvm.reloc[0];
+
+    Kernel kernel;
+    memset(&kernel, 0, sizeof(Kernel));
+
+    bool cache_hit = jitc_kernel_load(buf.get(), (uint32_t) buf.size(),
+                                      JitBackend::LLVM, hash, kernel);
+
+    char name[38];
+    snprintf(name, sizeof(name), "func_%016llx%016llx",
+             (unsigned long long) key.hash.high64,
+             (unsigned long long) key.hash.low64);
+
+    if (!cache_hit) {
+        jitc_llvm_compile_module(buf.get(), buf.size(), name, false, kernel);
+        jitc_kernel_write(buf.get(), (uint32_t) buf.size(), JitBackend::LLVM,
+                          hash, kernel);
+    }
+
+    jitc_log(Debug, "jit_llvm_link(): %s library callable %s (%u bytes).",
+             cache_hit ? "loaded" : "compiled", name, kernel.size);
+
+    jitc_llvm_library.emplace(hash, kernel);
+    return kernel.llvm.reloc[0];
+}
+
+void jitc_llvm_link(Kernel &kernel) {
+    if (kernel.llvm.n_reloc < 2)
+        return;
+
+    uint32_t index = 2;
+    for (auto const &kv : globals_map) {
+        if (!kv.first.callable)
+            continue;
+        if (kv.second.library)
+            kernel.llvm.reloc[index] = jitc_llvm_library_get(kv.first, kv.second);
+        index++;
+    }
+}
+
+void jitc_llvm_free_library() {
+    for (auto &kv : jitc_llvm_library)
+        jitc_kernel_free(-1, kv.second);
+    jitc_llvm_library.clear();
+}
@@ -64,6 +64,7 @@
 #include "var.h"
 #include "vcall.h"
 #include "op.h"
+#include <tsl/robin_set.h>
 
 #define put(...)                                                               \
     buffer.put(__VA_ARGS__)
@@ -79,137 +80,248 @@
         buffer.rewind_to(tmpoff);                                              \
     } while (0)
 
+/// Scratch space for code generated by jitc_llvm_render_math()
+static thread_local StringBuffer math_buffer { 1000 };
+
+/// Prefetch distance (in packets) of gathers in the current kernel, 0: disabled
+static uint32_t prefetch_distance = 0;
+
+/// Uniform variables that are computed in the prologue of the current kernel
+static tsl::robin_set<uint32_t, UInt32Hasher> hoisted;
+
 // Forward declaration
-static void jitc_llvm_render_stmt(uint32_t index, const Variable *v, bool in_function);
 static void jitc_llvm_render_var(uint32_t index, Variable *v);
 static void jitc_llvm_render_scatter(const Variable *v, const Variable *ptr,
                                      const Variable *value, const Variable *index,
                                      const Variable *mask);
 static void jitc_llvm_render_scatter_kahan(const Variable *v, uint32_t index);
+static void jitc_llvm_private_scan(const ScheduledGroup &group);
+static void jitc_llvm_render_coherent_lanes();
+static void jitc_llvm_render_coherent_load(const Variable *v);
+static void jitc_llvm_render_coherent_store(const Variable *v);
+static uint32_t jitc_llvm_stride(const Variable *index);
+static void jitc_llvm_render_prefetch(const Variable *v, const Variable *ptr,
+                                      const Variable *index);
+static bool jitc_llvm_render_gather_table(const Variable *v,
+                                          const Variable *ptr,
+                                          const Variable *index,
+                                          const Variable *mask);
+static void jitc_llvm_render_gather_affine(const Variable *v, const Variable *ptr,
+                                           const Variable *index,
+                                           const Variable *mask, uint32_t stride,
+                                           const char *suffix);
 static void jitc_llvm_render_printf(uint32_t index, const Variable *v,
                                     const Variable *mask, const Variable *target);
 static void jitc_llvm_render_trace(uint32_t index, const Variable *v,
                                    const Variable *func,
                                    const Variable *scene);
+static void jitc_llvm_render_math(const Variable *v, const Variable *a0);
 
-void jitc_llvm_assemble(ThreadState *ts, ScheduledGroup group) {
-    bool print_labels = std::max(state.log_level_stderr,
-                                 state.log_level_callback) >= LogLevel::Trace ||
-                        (jitc_flags() & (uint32_t) JitFlag::PrintIR);
+/// Generate code for a variable of the kernel being assembled
+static void jitc_llvm_render_scheduled(uint32_t index, bool coherent,
+                                       bool print_labels) {
+    Variable *v = jitc_var(index);
+    uint32_t vti = v->type;
+    VarType vt = (VarType) vti;
+    uint64_t size = v->size;
+
+    /// If a variable has a custom code generation hook, call it
+    if (unlikely(v->extra)) {
+        auto it = state.extra.find(index);
+        if (it == state.extra.end())
+            jitc_fail("jit_assemble_llvm(): internal error: 'extra' entry not found!");
+
+        const Extra &extra = it->second;
+        if (print_labels && vt != VarType::Void) {
+            const char *label =  jitc_var_label(index);
+            if (label && label[0])
+                fmt("    ; $s\n", label);
+        }
 
-    fmt("define void @drjit_^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^(i64 %start, i64 "
-        "%end, {i8**} noalias %params) #0 ${\n"
-        "entry:\n"
-        "    br label %body\n"
-        "\n"
-        "body:\n"
-        "    %index = phi i64 [ %index_next, %suffix ], [ %start, %entry ]\n");
+        if (extra.assemble) {
+            extra.assemble(v, extra);
+            return;
+        }
+    }
 
-    for (uint32_t gi = group.start; gi != group.end; ++gi) {
-        uint32_t index = schedule[gi].index;
-        Variable *v = jitc_var(index);
-        uint32_t vti = v->type;
-        VarType vt = (VarType) vti;
-        uint32_t size = v->size;
+    /// Determine source/destination address of input/output parameters
+    if (v->cold().param_type == ParamType::Input && size == 1 && vt == VarType::Pointer) {
+        // Case 1: load a pointer address from the parameter array
+        fmt("    $v_p1 = getelementptr inbounds {i8*}, {i8**} %params, i32 $o\n"
+            "    $v = load {i8*}, {i8**} $v_p1, align 8, !alias.scope !2\n",
+            v, v, v, v);
+    } else if (v->cold().param_type != ParamType::Register) {
+        // Case 2: read an input/output parameter
+
+        fmt( "    $v_p1 = getelementptr inbounds {i8*}, {i8**} %params, i32 $o\n"
+             "    $v_p{2|3} = load {i8*}, {i8**} $v_p1, align 8, !alias.scope !2\n"
+            "{    $v_p3 = bitcast i8* $v_p2 to $m*\n|}",
+            v, v, v, v, v, v, v);
+
+        // For output parameters and non-scalar inputs
+        if ((v->cold().param_type != ParamType::Input || size != 1) && coherent)
+            fmt("    $v_p5 = getelementptr inbounds $m, {$m*} $v_p3, <$w x i64> %lane_64\n",
+                v, v, v, v);
+        else if (v->cold().param_type != ParamType::Input || size != 1)
+            fmt( "    $v_p{4|5} = getelementptr inbounds $m, {$m*} $v_p3, i64 %index\n"
+                "{    $v_p5 = bitcast $m* $v_p4 to $M*\n|}",
+                v, v, v, v, v, v, v, v);
+    }
 
-        /// If a variable has a custom code generation hook, call it
-        if (unlikely(v->extra)) {
-            auto it = state.extra.find(index);
-            if (it == state.extra.end())
-                jitc_fail("jit_assemble_llvm(): internal error: 'extra' entry not found!");
+    if (likely(v->cold().param_type == ParamType::Input)) {
+        if (v->is_literal())
+            return;
+
+        if (size != 1 && coherent) {
+            // Gather a packet of values from the permuted lanes
+            jitc_llvm_render_coherent_load(v);
+        } else if (size != 1) {
+            // Load a packet of values
+            fmt("    $v$s = load $M, {$M*} $v_p5, align $A, !alias.scope !2, !nontemporal !3\n",
+                v, vt == VarType::Bool ? "_0" : "", v, v, v, v);
+            if (vt == VarType::Bool)
+                fmt("    $v = trunc $M $v_0 to $T\n", v, v, v, v);
+        } else {
+            // Load a scalar value and broadcast it
+            fmt("    $v_0 = load $m, {$m*} $v_p3, align $a, !alias.scope !2\n",
+                v, v, v, v, v);
 
-            const Extra &extra = it->second;
-            if (print_labels && vt != VarType::Void) {
-                const char *label =  jitc_var_label(index);
-                if (label && label[0])
-                    fmt("    ; $s\n", label);
-            }
+            if (vt == VarType::Bool)
+                fmt("    $v_1 = trunc i8 $v_0 to i1\n", v, v);
 
-            if (extra.assemble) {
-                extra.assemble(v, extra);
-                continue;
-            }
+            uint32_t src = vt == VarType::Bool ? 1 : 0,
+                     dst = vt == VarType::Bool ? 2 : 1;
+
+            fmt("    $v_$u = insertelement $T undef, $t $v_$u, i32 0\n"
+                "    $v = shufflevector $T $v_$u, $T undef, <$w x i32> $z\n",
+                v, dst, v, v, v, src,
+                v, v, v, dst, v);
         }
+    } else if (v->is_literal()) {
+        fmt("    $v_1 = insertelement $T undef, $t $l, i32 0\n"
+            "    $v = shufflevector $T $v_1, $T undef, <$w x i32> $z\n",
+            v, v, v, v,
+            v, v, v, v);
+    } else {
+        jitc_llvm_render_var(index, v);
+    }
 
-        /// Determine source/destination address of input/output parameters
-        if (v->param_type == ParamType::Input && size == 1 && vt == VarType::Pointer) {
-            // Case 1: load a pointer address from the parameter array
-            fmt("    $v_p1 = getelementptr inbounds {i8*}, {i8**} %params, i32 $o\n"
-                "    $v = load {i8*}, {i8**} $v_p1, align 8, !alias.scope !2\n",
+    v = jitc_var(index); // `v` might have been invalidated during its assembly
+
+    if (v->cold().param_type == ParamType::Output && coherent) {
+        jitc_llvm_render_coherent_store(v);
+    } else if (v->cold().param_type == ParamType::Output) {
+        if (vt != VarType::Bool) {
+            fmt("    store $V, {$T*} $v_p5, align $A, !noalias !2, !nontemporal !3\n",
                 v, v, v, v);
-        } else if (v->param_type != ParamType::Register) {
-            // Case 2: read an input/output parameter
-
-            fmt( "    $v_p1 = getelementptr inbounds {i8*}, {i8**} %params, i32 $o\n"
-                 "    $v_p{2|3} = load {i8*}, {i8**} $v_p1, align 8, !alias.scope !2\n"
-                "{    $v_p3 = bitcast i8* $v_p2 to $m*\n|}",
-                v, v, v, v, v, v, v);
-
-            // For output parameters and non-scalar inputs
-            if (v->param_type != ParamType::Input || size != 1)
-                fmt( "    $v_p{4|5} = getelementptr inbounds $m, {$m*} $v_p3, i64 %index\n"
-                    "{    $v_p5 = bitcast $m* $v_p4 to $M*\n|}",
-                    v, v, v, v, v, v, v, v);
+        } else {
+            fmt("    $v_e = zext $V to $M\n"
+                "    store $M $v_e, {$M*} $v_p5, align $A, !noalias !2, !nontemporal !3\n",
+                v, v, v, v, v, v, v, v);
         }
+    }
+}
 
-        if (likely(v->param_type == ParamType::Input)) {
-            if (v->is_literal())
-                continue;
+/**
+ * Can the (scalar) variable 'v' be computed once before the main loop of the
+ * kernel? This is the case for scalar inputs, literals, and arithmetic that
+ * only depends on other hoisted variables. Memory operations, side effects,
+ * and nodes with custom code generation stay in the loop.
+ */
+static bool jitc_llvm_hoistable(uint32_t index, const Variable *v) {
+    if (v->size != 1 || v->side_effect ||
+        v->cold().param_type == ParamType::Output)
+        return false;
+
+    if (unlikely(v->extra)) {
+        auto it = state.extra.find(index);
+        if (it != state.extra.end() && it->second.assemble)
+            return false;
+    }
 
-            if (size != 1) {
-                // Load a packet of values
-                fmt("    $v$s = load $M, {$M*} $v_p5, align $A, !alias.scope !2, !nontemporal !3\n",
-                    v, vt == VarType::Bool ? "_0" : "", v, v, v, v);
-                if (vt == VarType::Bool)
-                    fmt("    $v = trunc $M $v_0 to $T\n", v, v, v, v);
-            } else {
-                // Load a scalar value and broadcast it
-                fmt("    $v_0 = load $m, {$m*} $v_p3, align $a, !alias.scope !2\n",
-                    v, v, v, v, v);
+    if (v->cold().param_type == ParamType::Input || v->is_literal())
+        return true;
 
-                if (vt == VarType::Bool)
-                    fmt("    $v_1 = trunc i8 $v_0 to i1\n", v, v);
+    if (v->kind < (uint32_t) VarKind::Neg || v->kind > (uint32_t) VarKind::Bitcast)
+        return false;
 
-                uint32_t src = vt == VarType::Bool ? 1 : 0,
-                         dst = vt == VarType::Bool ? 2 : 1;
+    for (uint32_t i = 0; i < 4; ++i) {
+        if (v->dep[i] && hoisted.count(v->dep[i]) == 0)
+            return false;
+    }
 
-                fmt("    $v_$u = insertelement $T undef, $t $v_$u, i32 0\n"
-                    "    $v = shufflevector $T $v_$u, $T undef, <$w x i32> $z\n",
-                    v, dst, v, v, v, src,
-                    v, v, v, dst, v);
-            }
-        } else if (v->is_literal()) {
-            fmt("    $v_1 = insertelement $T undef, $t $l, i32 0\n"
-                "    $v = shufflevector $T $v_1, $T undef, <$w x i32> $z\n",
-                v, v, v, v,
-                v, v, v, v);
-        } else if (!v->is_stmt()) {
-            jitc_llvm_render_var(index, v);
-        } else {
-            jitc_llvm_render_stmt(index, v, false);
+    return true;
+}
+
+void jitc_llvm_assemble(ThreadState *ts, ScheduledGroup group) {
+    bool print_labels = std::max(state.log_level_stderr,
+                                 state.log_level_callback) >= LogLevel::Trace ||
+                        (jitc_flags() & (uint32_t) JitFlag::PrintIR);
+
+    /* With coherent dispatch, packets are composed of arbitrary lanes of the
+       block (see jitc_run_coherent()). Affine accesses and prefetching
+       assume consecutive lanes, privatization a static schedule. */
+    bool coherent = coherent_dispatch.perm_slot != 0;
+
+    prefetch_distance = 0;
+    if (state.llvm_prefetch && !coherent) {
+        prefetch_distance = state.llvm_prefetch_distance;
+
+        /* Automatic mode: aim to issue prefetches a few hundred cycles before
+           the data is needed, assuming ~1 cycle per operation and packet */
+        if (prefetch_distance == 0) {
+            uint32_t ops = std::max(group.end - group.start, 1u);
+            prefetch_distance = std::max(1u, std::min(16u, 256u / ops));
         }
+    }
 
-        v = jitc_var(index); // `v` might have been invalidated during its assembly
+    if (coherent)
+        private_scatters.clear();
+    else
+        jitc_llvm_private_scan(group);
 
-        if (v->param_type == ParamType::Output) {
-            if (vt != VarType::Bool) {
-                fmt("    store $V, {$T*} $v_p5, align $A, !noalias !2, !nontemporal !3\n",
-                    v, v, v, v);
-            } else {
-                fmt("    $v_e = zext $V to $M\n"
-                    "    store $M $v_e, {$M*} $v_p5, align $A, !noalias !2, !nontemporal !3\n",
-                    v, v, v, v, v, v, v, v);
-            }
+    fmt("define void @drjit_^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^(i64 %start, i64 "
+        "%end, {i8**} noalias %params) #0 ${\n"
+        "entry:\n");
+
+    // Compute uniform variables once in the prologue
+    hoisted.clear();
+    if (jitc_flags() & (uint32_t) JitFlag::HoistUniform) {
+        for (uint32_t gi = group.start; gi != group.end; ++gi) {
+            uint32_t index = schedule[gi].index;
+            if (!jitc_llvm_hoistable(index, jitc_var(index)))
+                continue;
+            jitc_llvm_render_scheduled(index, coherent, print_labels);
+            hoisted.insert(index);
         }
     }
 
+    put("    br label %body\n"
+        "\n"
+        "body:\n"
+        "    %index = phi i64 [ %index_next, %suffix ], [ %start, %entry ]\n");
+
+    if (coherent)
+        jitc_llvm_render_coherent_lanes();
+
+    for (uint32_t gi = group.start; gi != group.end; ++gi) {
+        uint32_t index = schedule[gi].index;
+        if (hoisted.empty() || hoisted.count(index) == 0)
+            jitc_llvm_render_scheduled(index, coherent, print_labels);
+    }
+
     put("    br label %suffix\n"
         "\n"
         "suffix:\n");
-    fmt("    %index_next = add i64 %index, $w\n");
-    put("    %cond = icmp uge i64 %index_next, %end\n"
-        "    br i1 %cond, label %done, label %body, !llvm.loop !4\n\n"
-        "done:\n"
+    /* Unrolling: the loop metadata !5 (see below) asks LLVM to process
+       several packets per iteration, with a remainder loop for the rest.
+       'nuw' lets it compute the trip count of the non-unit stride loop. */
+    uint32_t unroll = state.llvm_unroll;
+    fmt("    %index_next = add$s i64 %index, $w\n"
+        "    %cond = icmp uge i64 %index_next, %end\n"
+        "    br i1 %cond, label %done, label %body, !llvm.loop !$u\n\n",
+        unroll > 1 ? " nuw" : "", unroll > 1 ? 5u : 4u);
+    put("done:\n"
         "    ret void\n"
         "}\n");
 
@@ -232,34 +344,26 @@ void jitc_llvm_assemble(ThreadState *ts, ScheduledGroup group) {
     uint32_t ctr = 0;
     for (auto &it : globals_map) {
         put('\n');
-        put(globals.get() + it.second.start, it.second.length);
-        put('\n');
+        if (it.second.library) {
+            // Compiled separately, only record the name (for the kernel hash)
+            fmt("; @func_$Q$Q: library callable\n", it.first.hash.high64,
+                it.first.hash.low64);
+        } else {
+            put(globals.get() + it.second.start, it.second.length);
+            put('\n');
+        }
         if (!it.first.callable)
             continue;
         it.second.callable_index = 1 + ctr++;
     }
 
-    put("\n"
-        "!0 = !{!0}\n"
-        "!1 = !{!1, !0}\n"
-        "!2 = !{!1}\n"
-        "!3 = !{i32 1}\n"
-        "!4 = !{!\"llvm.loop.unroll.disable\", !\"llvm.loop.vectorize.enable\", i1 0}\n\n");
-
-    fmt("attributes #0 = ${ norecurse nounwind \"frame-pointer\"=\"none\" "
-        "\"no-builtins\" \"no-stack-arg-probe\" \"target-cpu\"=\"$s\" "
-        "\"target-features\"=\"", jitc_llvm_target_cpu);
-
-#if !defined(__aarch64__)
-    put("-vzeroupper");
-    if (jitc_llvm_target_features)
-        put(",");
-#endif
-
-    if (jitc_llvm_target_features)
-        put(jitc_llvm_target_features, strlen(jitc_llvm_target_features));
+    jitc_llvm_render_attributes(buffer);
 
-    put("\" }");
+    if (unroll > 1) {
+        put("\n\n!5 = distinct !{!5, !6, !7}\n");
+        fmt("!6 = !${!\"llvm.loop.unroll.count\", i32 $u$}\n", unroll);
+        put("!7 = !{!\"llvm.loop.vectorize.enable\", i1 0}");
+    }
 
     jitc_vcall_upload(ts);
 }
@@ -268,7 +372,8 @@ void jitc_llvm_assemble_func(const char *name, uint32_t inst_id,
                              uint32_t in_size, uint32_t data_offset,
                              const tsl::robin_map<uint64_t, uint32_t, UInt64Hasher> &data_map,
                              uint32_t n_out, const uint32_t *out_nested,
-                             bool use_self) {
+                             bool use_self,
+                             const std::vector<ScheduledVariable> &func_schedule) {
     bool print_labels = std::max(state.log_level_stderr,
                                  state.log_level_callback) >= LogLevel::Trace ||
                         (jitc_flags() & (uint32_t) JitFlag::PrintIR);
@@ -293,7 +398,7 @@ void jitc_llvm_assemble_func(const char *name, uint32_t inst_id,
 
     alloca_size = alloca_align = -1;
 
-    for (ScheduledVariable &sv : schedule) {
+    for (const ScheduledVariable &sv : func_schedule) {
         Variable *v = jitc_var(sv.index);
         VarType vt = (VarType) v->type;
 
@@ -320,7 +425,7 @@ void jitc_llvm_assemble_func(const char *name, uint32_t inst_id,
             fmt( "    $v_i{0|1} = getelementptr inbounds i8, {i8*} %params, i64 $u\n"
                 "{    $v_i1 = bitcast i8* $v_i0 to $M*\n|}"
                  "    $v$s = load $M, {$M*} $v_i1, align $A\n",
-                v, v->param_offset * width,
+                v, v->cold().param_offset * width,
                 v, v, v,
                 v, vt == VarType::Bool ? "_i2" : "", v, v, v, v);
 
@@ -364,10 +469,8 @@ void jitc_llvm_assemble_func(const char *name, uint32_t inst_id,
             else if (vt == VarType::Bool)
                 fmt("    $v = trunc <$w x i8> $v_p4 to <$w x i1>\n",
                     v, v);
-        } else if (!v->is_stmt()) {
-            jitc_llvm_render_var(sv.index, v);
         } else {
-            jitc_llvm_render_stmt(sv.index, v, true);
+            jitc_llvm_render_var(sv.index, v);
         }
     }
 
@@ -471,10 +574,23 @@ static void jitc_llvm_render_var(uint32_t index, Variable *v) {
             }
             break;
 
-        case VarKind::Add:
-            fmt(jitc_is_float(v) ? "    $v = fadd $V, $v\n"
-                                 : "    $v = add $V, $v\n",
-                v, a0, a1);
+        case VarKind::Add: {
+                const Variable *other, *m = jitc_fma_contract(v, a0, a1, other);
+                if (!m) {
+                    fmt(jitc_is_float(v) ? "    $v = fadd $V, $v\n"
+                                         : "    $v = add $V, $v\n",
+                        v, a0, a1);
+                    break;
+                }
+
+                // The product itself becomes dead code
+                const Variable *b0 = jitc_var(m->dep[0]),
+                               *b1 = jitc_var(m->dep[1]);
+                fmt_intrinsic("declare $T @llvm.fma.v$w$h($T, $T, $T)\n",
+                    v, v, b0, b1, other);
+                fmt("    $v = call $T @llvm.fma.v$w$h($V, $V, $V)\n",
+                    v, v, v, b0, b1, other);
+            }
             break;
 
         case VarKind::Sub:
@@ -591,6 +707,13 @@ static void jitc_llvm_render_var(uint32_t index, Variable *v) {
             fmt("    $v = call $T @llvm.trunc.v$w$h($V)\n", v, v, v, a0);
             break;
 
+        case VarKind::Sin:
+        case VarKind::Cos:
+        case VarKind::Exp2:
+        case VarKind::Log2:
+            jitc_llvm_render_math(v, a0);
+            break;
+
         case VarKind::Eq:
             fmt(jitc_is_float(a0) ? "    $v = fcmp oeq $V, $v\n"
                                   : "    $v = icmp eq $V, $v\n", v, a0, a1);
@@ -755,20 +878,29 @@ static void jitc_llvm_render_var(uint32_t index, Variable *v) {
                 if (is_bool) // Temporary change
                     v->type = (uint32_t) VarType::UInt8;
 
-                fmt_intrinsic(
-                    "declare $T @llvm.masked.gather.v$w$h(<$w x {$t*}>, i32, $T, $T)",
-                    v, v, v, a2, v);
-
-                fmt("{    $v_0 = bitcast $<i8*$> $v to $<$t*$>\n|}"
-                     "    $v_1 = getelementptr $t, $<{$t*}$> {$v_0|$v}, $V\n"
-                     "    $v$s = call $T @llvm.masked.gather.v$w$h(<$w x {$t*}> $v_1, i32 $a, $V, $T $z)\n",
-                     v, a0, v,
-                     v, v, v, v, a0, a1,
-                     v, is_bool ? "_2" : "", v, v, v, v, v, a2, v);
+                uint32_t stride = jitc_llvm_stride(a1);
+                if (stride) {
+                    jitc_llvm_render_gather_affine(v, a0, a1, a2, stride,
+                                                   is_bool ? "_2" : "");
+                } else if (!jitc_llvm_render_gather_table(v, a0, a1, a2)) {
+                    if (prefetch_distance && callable_depth == 0)
+                        jitc_llvm_render_prefetch(v, a0, a1);
+
+                    fmt_intrinsic(
+                        "declare $T @llvm.masked.gather.v$w$h(<$w x {$t*}>, i32, $T, $T)",
+                        v, v, v, a2, v);
+
+                    fmt("{    $v_0 = bitcast $<i8*$> $v to $<$t*$>\n|}"
+                         "    $v_1 = getelementptr $t, $<{$t*}$> {$v_0|$v}, $V\n"
+                         "    $v$s = call $T @llvm.masked.gather.v$w$h(<$w x {$t*}> $v_1, i32 $a, $V, $T $z)\n",
+                         v, a0, v,
+                         v, v, v, v, a0, a1,
+                         v, is_bool ? "_2" : "", v, v, v, v, v, a2, v);
+                }
 
                 if (is_bool) { // Restore
                     v->type = (uint32_t) VarType::Bool;
-                    fmt("    $v = trunc <$w x i8> %b$u_2 to <$w x i1>\n", v, v->reg_index);
+                    fmt("    $v = trunc <$w x i8> %b$u_2 to <$w x i1>\n", v, v->cold().reg_index);
                 }
             }
             break;
@@ -790,21 +922,38 @@ static void jitc_llvm_render_var(uint32_t index, Variable *v) {
             break;
 
         case VarKind::Counter:
-            fmt("    $v_0 = trunc i64 %index to $t\n"
-                "    $v_1 = insertelement $T undef, $t $v_0, i32 0\n"
-                "    $v_2 = shufflevector $V_1, $T undef, <$w x i32> $z\n"
+            if (coherent_dispatch.perm_slot && callable_depth == 0) {
+                // The lane permutation stores the original counter values
+                fmt("    $v = bitcast <$w x i32> %lane to $T\n", v, v);
+                break;
+            }
+
+            // Counters of arrays with 2^32 or more entries are 64 bit
+            if ((VarType) v->type == VarType::UInt64)
+                fmt("    $v_1 = insertelement $T undef, i64 %index, i32 0\n",
+                    v, v);
+            else
+                fmt("    $v_0 = trunc i64 %index to $t\n"
+                    "    $v_1 = insertelement $T undef, $t $v_0, i32 0\n",
+                    v, v, v, v, v, v);
+            fmt("    $v_2 = shufflevector $V_1, $T undef, <$w x i32> $z\n"
                 "    $v = add $V_2, <",
-                v, v, v, v, v, v, v, v, v, v, v);
+                v, v, v, v, v);
             for (uint32_t i = 0; i < jitc_llvm_vector_width; ++i)
-                fmt("i32 $u$s", i, i + 1 < jitc_llvm_vector_width ? ", " : ">\n");
+                fmt("$t $u$s", v, i, i + 1 < jitc_llvm_vector_width ? ", " : ">\n");
             break;
 
         case VarKind::DefaultMask:
-            fmt("    $v_0 = trunc i64 %end to i32\n"
-                "    $v_1 = insertelement <$w x i32> undef, i32 $v_0, i32 0\n"
-                "    $v_2 = shufflevector <$w x i32> $v_1, <$w x i32> undef, <$w x i32> zeroinitializer\n"
-                "    $v = icmp ult <$w x i32> $v, $v_2\n",
-                v, v, v, v, v, v, a0, v);
+            if ((VarType) a0->type == VarType::UInt64)
+                fmt("    $v_1 = insertelement <$w x i64> undef, i64 %end, i32 0\n",
+                    v);
+            else
+                fmt("    $v_0 = trunc i64 %end to i32\n"
+                    "    $v_1 = insertelement <$w x i32> undef, i32 $v_0, i32 0\n",
+                    v, v, v);
+            fmt("    $v_2 = shufflevector $T $v_1, $T undef, <$w x i32> zeroinitializer\n"
+                "    $v = icmp ult $V, $v_2\n",
+                v, a0, v, a0, v, a0, v);
             break;
 
         case VarKind::Printf:
@@ -813,8 +962,8 @@ static void jitc_llvm_render_var(uint32_t index, Variable *v) {
 
         case VarKind::Dispatch:
             jitc_var_vcall_assemble((VCall *) state.extra[index].callback_data,
-                                    a0->reg_index, a1->reg_index, a2->reg_index,
-                                    a3 ? a3->reg_index : 0);
+                                    a0->cold().reg_index, a1->cold().reg_index, a2->cold().reg_index,
+                                    a3 ? a3->cold().reg_index : 0);
             break;
 
         case VarKind::TraceRay:
@@ -826,22 +975,1109 @@ static void jitc_llvm_render_var(uint32_t index, Variable *v) {
                 (uint32_t) v->literal, v);
             break;
 
+        case VarKind::Copy:
+            fmt("    $v = bitcast $V to $T\n", v, a0, v);
+            break;
+
+        case VarKind::LoopStart:
+        case VarKind::LoopCond:
+        case VarKind::LoopEnd:
+            break; // Code is generated by the loop's 'Extra::assemble' hook
+
+        case VarKind::LoopPhi: {
+                uint32_t loop_reg = a1->cold().reg_index;
+                if (v->literal) // Loop-invariant variable
+                    fmt("    $v = phi $T [ $v, %l_$u_tail ], [ $v, %l_$u_start ]\n",
+                        v, v, v, loop_reg, a0, loop_reg);
+                else
+                    fmt("    $v = phi $T [ $v_final, %l_$u_tail ], [ $v, %l_$u_start ]\n",
+                        v, v, v, loop_reg, a0, loop_reg);
+            }
+            break;
+
         default:
             jitc_fail("jitc_llvm_render_var(): unhandled node kind \"%s\"!",
                       var_kind_name[(uint32_t) v->kind]);
     }
 }
 
+// --------------------------------------------------------------------------
+//  Vectorized transcendental functions
+// --------------------------------------------------------------------------
+
+/**
+ * The following helper generates internal IR functions (e.g. `@math_sin_f32`)
+ * that evaluate 'Sin', 'Cos', 'Exp2' and 'Log2' using range reduction and
+ * polynomial approximations. They only involve basic arithmetic, which LLVM
+ * vectorizes without calling into libm (the resulting relocations against the
+ * global offset table would be rejected by jitc_llvm_memmgr_allocate()).
+ *
+ * Maximum measured error (relative to a correctly rounded result, rounded
+ * up to 0.1 ulp; half precision is computed in single precision):
+ *
+ *  Function   Domain                       float32    float64
+ * --------------------------------------------------------------------------
+ *  sin, cos   all finite x                 2.1 ulp    2.4 ulp
+ *  exp2       all finite x                 1.2 ulp    1.1 ulp
+ *  log2       all x > 0 (incl. denormals)  1.9 ulp    1.8 ulp
+ * --------------------------------------------------------------------------
+ *
+ * Special values (NaN, infinities, zero, negative arguments of log2) follow
+ * IEEE-754 semantics. Sin/cos use a Cody-Waite range reduction for
+ * |x| < 8192 (f32) or 1e9 (f64), and a slower Payne-Hanek style reduction
+ * beyond this point, which keeps the result accurate for all finite inputs.
+ */
+struct LLVMMath {
+    StringBuffer &buf;
+    bool dbl;
+    uint32_t ctr = 1;
+    char t[8], T[32], I[32], M[32];
+
+    LLVMMath(StringBuffer &buf, bool dbl) : buf(buf), dbl(dbl) {
+        uint32_t w = jitc_llvm_vector_width;
+        snprintf(t, sizeof(t), "%s", dbl ? "double" : "float");
+        snprintf(T, sizeof(T), "<%u x %s>", w, t);
+        snprintf(I, sizeof(I), "<%u x i%u>", w, dbl ? 64 : 32);
+        snprintf(M, sizeof(M), "<%u x i1>", w);
+    }
+
+    /// Append a printf-style formatted string to the output
+#if defined(__GNUC__)
+    __attribute__((__format__ (__printf__, 2, 3)))
+#endif
+    void emit(const char *format, ...) {
+        va_list args;
+        va_start(args, format);
+        buf.vfmt(format, args);
+        va_end(args);
+    }
+
+    uint32_t mant_bits() const { return dbl ? 52 : 23; }
+    int64_t bias() const { return dbl ? 1023 : 127; }
+
+    /// Broadcast a scalar (in LLVM IR syntax) into a vector of type 'type'
+    uint32_t splat(const char *type, const char *scalar_type, const char *value) {
+        uint32_t r = ctr++;
+        emit("    %%m%u_0 = insertelement %s undef, %s %s, i32 0\n"
+                "    %%m%u = shufflevector %s %%m%u_0, %s undef, <%u x i32> "
+                "zeroinitializer\n",
+                r, type, scalar_type, value, r, type, r, type,
+                jitc_llvm_vector_width);
+        return r;
+    }
+
+    /// Floating point constant
+    uint32_t c(double value) {
+        if (!dbl)
+            value = (double) (float) value;
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(double));
+        char tmp[32];
+        snprintf(tmp, sizeof(tmp), "0x%016llx", (unsigned long long) bits);
+        return splat(T, t, tmp);
+    }
+
+    /// Integer constant
+    uint32_t ci(int64_t value) {
+        char tmp[32];
+        snprintf(tmp, sizeof(tmp), "%lld", (long long) value);
+        return splat(I, dbl ? "i64" : "i32", tmp);
+    }
+
+    /// Integer constant matching the bit representation of a float. constant
+    uint32_t cbits(double value) {
+        int64_t bits;
+        if (dbl) {
+            memcpy(&bits, &value, sizeof(double));
+        } else {
+            float f = (float) value;
+            int32_t bits32;
+            memcpy(&bits32, &f, sizeof(float));
+            bits = bits32;
+        }
+        return ci(bits);
+    }
+
+    /// Binary operation, 'type' is the type of the operands
+    uint32_t op(const char *name, const char *type, uint32_t a, uint32_t b) {
+        uint32_t r = ctr++;
+        emit("    %%m%u = %s %s %%m%u, %%m%u\n", r, name, type, a, b);
+        return r;
+    }
+
+    uint32_t fop(const char *name, uint32_t a, uint32_t b) { return op(name, T, a, b); }
+    uint32_t iop(const char *name, uint32_t a, uint32_t b) { return op(name, I, a, b); }
+
+    /// Type conversion
+    uint32_t conv(const char *name, const char *from, uint32_t a, const char *to) {
+        uint32_t r = ctr++;
+        emit("    %%m%u = %s %s %%m%u to %s\n", r, name, from, a, to);
+        return r;
+    }
+
+    uint32_t select(uint32_t m, uint32_t a, uint32_t b, bool is_int = false) {
+        const char *type = is_int ? I : T;
+        uint32_t r = ctr++;
+        emit("    %%m%u = select %s %%m%u, %s %%m%u, %s %%m%u\n", r, M, m,
+                type, a, type, b);
+        return r;
+    }
+
+    /// Evaluate a polynomial (coefficients ordered from high to low degree)
+    uint32_t poly(uint32_t x, const double *coeffs, size_t n) {
+        uint32_t r = c(coeffs[0]);
+        for (size_t i = 1; i < n; ++i)
+            r = fop("fadd", fop("fmul", r, x), c(coeffs[i]));
+        return r;
+    }
+
+    /// Round to the nearest integer (valid for |x| < 2^22 / 2^51), returns
+    /// the rounded value and its integer representation
+    std::pair<uint32_t, uint32_t> round(uint32_t x) {
+        double magic = 1.5 * (dbl ? 4503599627370496.0 : 8388608.0);
+        uint32_t m = fop("fadd", x, c(magic)),
+                 f = fop("fsub", m, c(magic)),
+                 i = iop("sub", conv("bitcast", T, m, I), cbits(magic));
+        return { f, i };
+    }
+
+    uint32_t exp2(uint32_t x) {
+        uint32_t lo = c(dbl ? -1100.0 : -150.0),
+                 hi = c(dbl ? 1025.0 : 128.0);
+
+        // Clamp the argument (NaNs pass through)
+        x = select(op("fcmp olt", T, x, lo), lo, x);
+        x = select(op("fcmp ogt", T, x, hi), hi, x);
+
+        auto [kf, k] = round(x);
+        uint32_t r = fop("fsub", x, kf);
+
+        // Taylor series of 2^r = exp(r * log(2)) for |r| <= 1/2
+        double coeffs[14], ln2 = 0.693147180559945309417232121458176568;
+        size_t n = dbl ? 14 : 8;
+        coeffs[n - 1] = 1.0;
+        for (size_t i = 1; i < n; ++i)
+            coeffs[n - 1 - i] = coeffs[n - i] * ln2 / (double) i;
+        uint32_t p = poly(r, coeffs, n);
+
+        // Scale by 2^k in two steps, which also handles denormal results
+        uint32_t k1 = iop("ashr", k, ci(1)),
+                 k2 = iop("sub", k, k1),
+                 s1 = conv("bitcast", I, iop("shl", iop("add", k1, ci(bias())), ci(mant_bits())), T),
+                 s2 = conv("bitcast", I, iop("shl", iop("add", k2, ci(bias())), ci(mant_bits())), T);
+
+        return fop("fmul", fop("fmul", p, s1), s2);
+    }
+
+    uint32_t log2(uint32_t x) {
+        uint32_t mb = mant_bits();
+
+        // Normalize denormals
+        uint32_t is_sub = op("fcmp olt", T, x, c(dbl ? 2.2250738585072014e-308
+                                                      : 1.17549435e-38)),
+                 xs = select(is_sub, fop("fmul", x, c((double) (1ull << mb))), x),
+                 e_adj = select(is_sub, ci(-(int64_t) mb), ci(0), true);
+
+        // Split into exponent and mantissa m in [sqrt(1/2), sqrt(2))
+        uint32_t bits = conv("bitcast", T, xs, I),
+                 e = iop("add", iop("sub", iop("lshr", bits, ci(mb)), ci(bias())), e_adj),
+                 mant = iop("or", iop("and", bits, ci((int64_t) ((1ull << mb) - 1))), cbits(1.0)),
+                 m = conv("bitcast", I, mant, T),
+                 big = op("fcmp ogt", T, m, c(1.41421356237309504880));
+        m = select(big, fop("fmul", m, c(0.5)), m);
+        e = iop("add", e, conv("zext", M, big, I));
+
+        // log(1 + f) = f - (hfsq - s * (hfsq + R)), where s = f / (2 + f)
+        uint32_t f = fop("fsub", m, c(1.0)),
+                 s = fop("fdiv", f, fop("fadd", f, c(2.0))),
+                 z = fop("fmul", s, s);
+
+        double coeffs[11];
+        size_t n = dbl ? 11 : 4;
+        for (size_t i = 0; i < n; ++i)
+            coeffs[i] = 2.0 / (double) (2 * (n - i) + 1);
+
+        uint32_t R = fop("fmul", z, poly(z, coeffs, n)),
+                 hfsq = fop("fmul", fop("fmul", c(0.5), f), f),
+                 l = fop("fsub", f, fop("fsub", hfsq, fop("fmul", s, fop("fadd", hfsq, R))));
+
+        // Multiply by 1/log(2), represented as the sum of two constants
+        l = fop("fadd", fop("fmul", l, c(dbl ? 1.4426950408889634 : 1.4426950216293335)),
+                        fop("fmul", l, c(dbl ? 2.0355273740931033e-17 : 1.9259629911266175e-08)));
+
+        uint32_t result = fop("fadd", conv("sitofp", I, e, T), l);
+
+        // Special cases
+        double inf = std::numeric_limits<double>::infinity();
+        result = select(op("fcmp oeq", T, x, c(inf)), x, result);
+        result = select(op("fcmp oeq", T, x, c(0.0)), c(-inf), result);
+        result = select(op("fcmp ult", T, x, c(0.0)),
+                        c(std::numeric_limits<double>::quiet_NaN()), result);
+        return result;
+    }
+
+    /**
+     * Payne-Hanek style range reduction for arguments where the Cody-Waite
+     * scheme in sincos() runs out of precision. The argument is multiplied by
+     * 2/pi stored as a sequence of 24-bit chunks. Each partial product is
+     * exact in double precision, and its integer part (mod 4) and fraction are
+     * accumulated separately. The computation is skipped unless some lane of
+     * 'x' lies in the affected range, in which case 'r' and 'q' are replaced.
+     */
+    void reduce_large(uint32_t x, uint32_t &r, uint32_t &q) {
+        // Digits of 2/pi in chunks of 24 bits
+        static const uint32_t two_over_pi[] = {
+            0xA2F983, 0x6E4E44, 0x1529FC, 0x2757D1, 0xF534DD, 0xC0DB62,
+            0x95993C, 0x439041, 0xFE5163, 0xABDEBB, 0xC561B7, 0x246E3A,
+            0x424DD2, 0xE00649, 0x2EEA09, 0xD1921C, 0xFE1DEB, 0x1CB129,
+            0xA73EE8, 0x8235F5, 0x2EBB44, 0x84E99C, 0x7026B4, 0x5F7E41,
+            0x3991D6, 0x398353, 0x39F49C, 0x845F8B, 0xBDF928, 0x3B1FF8,
+            0x97FFDE, 0x05980F, 0xEF2F11, 0x8B5A0A, 0x6D1F6D, 0x367ECF,
+            0x27CB09, 0xB74F46, 0x3F669E, 0x5FEA2D, 0x7527BA, 0xC7EBE5,
+            0xF17B3D, 0x0739F7, 0x8A5292, 0xEA6BFB, 0x5FB11F, 0x8D5D08
+        };
+
+        /* Table of pairs (chunk, scale). Chunk 'i' has the value
+           D_i * 2^(-24*(i+1)). Entries that would be denormal are stored
+           multiplied by 2^600 and scaled down when forming the product. */
+        const uint32_t n_table = sizeof(two_over_pi) / sizeof(uint32_t),
+                       n_chunks = dbl ? n_table : 10,
+                       w = jitc_llvm_vector_width;
+        const char *ptr_t = jitc_llvm_opaque_pointers ? "ptr" : "double*";
+        char table_ptr_t[32] = "ptr";
+        if (!jitc_llvm_opaque_pointers)
+            snprintf(table_ptr_t, sizeof(table_ptr_t), "[%u x double]*", n_table * 2);
+
+        StringBuffer table;
+        LLVMMath g(table, true);
+        g.emit("@math_2_over_pi = private unnamed_addr constant [%u x double] [",
+               n_table * 2);
+        for (uint32_t i = 0; i < n_table; ++i) {
+            bool scaled = i >= 40;
+            double values[2] = {
+                std::ldexp((double) two_over_pi[i],
+                           -24 * (int) (i + 1) + (scaled ? 600 : 0)),
+                scaled ? std::ldexp(1.0, -600) : 1.0
+            };
+            for (uint32_t j = 0; j < 2; ++j) {
+                uint64_t bits;
+                memcpy(&bits, &values[j], sizeof(double));
+                g.emit("%sdouble 0x%016llx", (i || j) ? ", " : "",
+                       (unsigned long long) bits);
+            }
+        }
+        g.emit("], align 8");
+        jitc_register_global(table.get());
+
+        table.clear();
+        g.emit("declare i1 @llvm.experimental.vector.reduce.or.v%ui1(<%u x i1>)",
+               w, w);
+        jitc_register_global(table.get());
+
+        double limit = dbl ? 1e9 : 8192.0,
+               inf = std::numeric_limits<double>::infinity();
+
+        // Check if any lane requires the slow path
+        uint32_t ax = conv("bitcast", I, iop("and", conv("bitcast", T, x, I),
+                                             ci(dbl ? INT64_MAX : INT32_MAX)), T);
+        uint32_t big = op("and", M, op("fcmp oge", T, ax, c(limit)),
+                                    op("fcmp olt", T, ax, c(inf))),
+                 any = ctr++;
+        emit("    br label %%reduce\n\n"
+             "reduce:\n"
+             "    %%m%u = call i1 @llvm.experimental.vector.reduce.or.v%ui1(%s %%m%u)\n"
+             "    br i1 %%m%u, label %%reduce_large, label %%reduce_done\n\n"
+             "reduce_large:\n",
+             any, w, M, big, any);
+
+        // The slow path runs in double precision
+        uint32_t xs = select(big, x, c(0.0));
+        LLVMMath d(buf, true);
+        if (!dbl)
+            xs = conv("fpext", T, xs, d.T);
+        d.ctr = ctr;
+
+        // Split the argument into two parts with at most 27 significant bits
+        uint32_t xh = d.conv("bitcast", d.I, d.iop("and", d.conv("bitcast", d.T, xs, d.I),
+                                                   d.ci(~(int64_t) ((1 << 27) - 1))), d.T),
+                 xl = d.fop("fsub", xs, xh);
+
+        /* Generate the loop body into a separate buffer, since the phi nodes
+           at its beginning refer to values computed within it */
+        StringBuffer body;
+        LLVMMath l(body, true);
+        uint32_t i = d.ctr++, ni = d.ctr++, sh = d.ctr++, sl = d.ctr++;
+        l.ctr = d.ctr;
+
+        // Fetch the current table entry
+        uint32_t ti = l.ctr++;
+        l.emit("    %%m%u_0 = shl i64 %%m%u, 1\n"
+               "    %%m%u_1 = getelementptr inbounds [%u x double], %s @math_2_over_pi, i64 0, i64 %%m%u_0\n"
+               "    %%m%u_2 = getelementptr inbounds double, %s %%m%u_1, i64 1\n"
+               "    %%m%u_3 = load double, %s %%m%u_1, align 8\n"
+               "    %%m%u_4 = load double, %s %%m%u_2, align 8\n",
+               ti, i,
+               ti, n_table * 2, table_ptr_t, ti,
+               ti, ptr_t, ti,
+               ti, ptr_t, ti,
+               ti, ptr_t, ti);
+        char tmp[32];
+        snprintf(tmp, sizeof(tmp), "%%m%u_3", ti);
+        uint32_t chunk = l.splat(l.T, "double", tmp);
+        snprintf(tmp, sizeof(tmp), "%%m%u_4", ti);
+        uint32_t scale = l.splat(l.T, "double", tmp);
+
+        uint32_t ni_next = ni, sh_next = sh, sl_next = sl;
+        for (uint32_t part : { xh, xl }) {
+            // Exact product, whose integer part is only needed modulo 4
+            uint32_t p = l.fop("fmul", l.fop("fmul", part, scale), chunk),
+                     ap = l.conv("bitcast", l.I, l.iop("and", l.conv("bitcast", l.T, p, l.I),
+                                                       l.ci(INT64_MAX)), l.T);
+            p = l.select(l.op("fcmp oge", l.T, ap, l.c(4503599627370496.0)), l.c(0.0), p);
+            uint32_t m = l.fop("fsub", p, l.fop("fmul", l.round(l.fop("fmul", p, l.c(0.25))).first, l.c(4.0))),
+                     n = l.round(m).first,
+                     f = l.fop("fsub", m, n);
+
+            // Accumulate the integer part and the fraction (using TwoSum)
+            uint32_t s  = l.fop("fadd", sh_next, f),
+                     bb = l.fop("fsub", s, sh_next),
+                     e  = l.fop("fadd", l.fop("fsub", sh_next, l.fop("fsub", s, bb)),
+                                        l.fop("fsub", f, bb));
+            ni_next = l.fop("fadd", ni_next, n);
+            sh_next = s;
+            sl_next = l.fop("fadd", sl_next, e);
+        }
+
+        uint32_t i_next = l.ctr++, again = l.ctr++;
+        l.emit("    %%m%u = add i64 %%m%u, 1\n"
+               "    %%m%u = icmp ult i64 %%m%u, %u\n"
+               "    br i1 %%m%u, label %%reduce_loop, label %%reduce_large_done\n\n"
+               "reduce_large_done:\n",
+               i_next, i, again, i_next, n_chunks, again);
+        d.ctr = l.ctr;
+
+        d.emit("    br label %%reduce_loop\n\n"
+               "reduce_loop:\n"
+               "    %%m%u = phi i64 [ 0, %%reduce_large ], [ %%m%u, %%reduce_loop ]\n",
+               i, i_next);
+        uint32_t phis[3][2] = { { ni, ni_next }, { sh, sh_next }, { sl, sl_next } };
+        for (auto [phi, next] : phis)
+            d.emit("    %%m%u = phi %s [ zeroinitializer, %%reduce_large ], "
+                   "[ %%m%u, %%reduce_loop ]\n", phi, d.T, next);
+        emit("%s", body.get());
+
+        // Move integer part of the fraction into 'ni' and renormalize
+        uint32_t k = d.round(sh_next).first,
+                 fh0 = d.fop("fsub", sh_next, k),
+                 nf = d.fop("fadd", ni_next, k),
+                 fh = d.fop("fadd", fh0, sl_next),
+                 fl = d.fop("fsub", sl_next, d.fop("fsub", fh, fh0));
+
+        // Multiply by pi/2 in double-double arithmetic
+        uint32_t rd = d.fop("fadd", d.fop("fmul", fh, d.c(1.5707963267948966)),
+                            d.fop("fadd", d.fop("fmul", fh, d.c(6.123233995736766e-17)),
+                                          d.fop("fmul", fl, d.c(1.5707963267948966)))),
+                 qd = d.conv("fptosi", d.T, nf, d.I);
+        ctr = d.ctr;
+
+        if (!dbl) {
+            rd = conv("fptrunc", d.T, rd, T);
+            qd = conv("trunc", d.I, qd, I);
+        }
+
+        uint32_t r_large = select(big, rd, r),
+                 q_large = select(big, qd, q, true),
+                 r_out = ctr++, q_out = ctr++;
+
+        emit("    br label %%reduce_done\n\n"
+             "reduce_done:\n"
+             "    %%m%u = phi %s [ %%m%u, %%reduce ], [ %%m%u, %%reduce_large_done ]\n"
+             "    %%m%u = phi %s [ %%m%u, %%reduce ], [ %%m%u, %%reduce_large_done ]\n",
+             r_out, T, r, r_large, q_out, I, q, q_large);
+        r = r_out;
+        q = q_out;
+    }
+
+    uint32_t sincos(uint32_t x, bool is_cos) {
+        auto [kf, q] = round(fop("fmul", x, c(0.636619772367581343075535053490057448)));
+
+        // Cody-Waite reduction: r = x - k * pi/2 using a multi-part pi/2
+        static const double pio2_f32[] = { 1.5703125, 4.837512969970703e-4,
+                                           7.549533620476723e-08,
+                                           2.5633440682570896e-12 },
+                            pio2_f64[] = { 1.57079625129699707031,
+                                           7.54978941586159635335e-8,
+                                           5.39030285815811905290e-15 };
+        const double *pio2 = dbl ? pio2_f64 : pio2_f32;
+        uint32_t r = x;
+        for (size_t i = 0; i < (dbl ? 3 : 4); ++i)
+            r = fop("fsub", r, fop("fmul", kf, c(pio2[i])));
+
+        // Large arguments require a more careful reduction
+        reduce_large(x, r, q);
+
+        // Minimax polynomials for |r| <= pi/4 (from Cephes)
+        static const double sin_f32[] = { -1.9515295891e-4, 8.3321608736e-3,
+                                          -1.6666654611e-1 },
+                            cos_f32[] = { 2.443315711809948e-5, -1.388731625493765e-3,
+                                          4.166664568298827e-2 },
+                            sin_f64[] = { 1.58962301576546568060e-10, -2.50507477628578072866e-8,
+                                          2.75573136213857245213e-6, -1.98412698295895385996e-4,
+                                          8.33333333332211858878e-3, -1.66666666666666307295e-1 },
+                            cos_f64[] = { -1.13585365213876817300e-11, 2.08757008419747316778e-9,
+                                          -2.75573141792967388112e-7, 2.48015872888517045348e-5,
+                                          -1.38888888888730564116e-3, 4.16666666666665929218e-2 };
+
+        uint32_t z = fop("fmul", r, r),
+                 ps = poly(z, dbl ? sin_f64 : sin_f32, dbl ? 6 : 3),
+                 pc = poly(z, dbl ? cos_f64 : cos_f32, dbl ? 6 : 3),
+                 s = fop("fadd", r, fop("fmul", fop("fmul", r, z), ps)),
+                 cv = fop("fadd", fop("fsub", c(1.0), fop("fmul", c(0.5), z)),
+                                  fop("fmul", fop("fmul", z, z), pc));
+
+        // Select the result based on the quadrant
+        uint32_t swap = op("icmp ne", I, iop("and", q, ci(1)), ci(0)),
+                 q2 = is_cos ? iop("add", q, ci(1)) : q,
+                 neg = op("icmp ne", I, iop("and", q2, ci(2)), ci(0)),
+                 result = is_cos ? select(swap, s, cv) : select(swap, cv, s),
+                 result_neg = ctr++;
+        emit("    %%m%u = fneg %s %%m%u\n", result_neg, T, result);
+        result = select(neg, result_neg, result);
+
+        // Preserve the sign of zero
+        if (!is_cos)
+            result = select(op("fcmp oeq", T, x, c(0.0)), x, result);
+        return result;
+    }
+};
+
+static void jitc_llvm_render_math(const Variable *v, const Variable *a0) {
+    const char *name;
+    switch ((VarKind) v->kind) {
+        case VarKind::Sin:  name = "sin"; break;
+        case VarKind::Cos:  name = "cos"; break;
+        case VarKind::Exp2: name = "exp2"; break;
+        case VarKind::Log2: name = "log2"; break;
+        default: jitc_fail("jitc_llvm_render_math(): unsupported operation!");
+    }
+
+    bool dbl = (VarType) v->type == VarType::Float64,
+         half = (VarType) v->type == VarType::Float16;
+
+    StringBuffer &tmp = math_buffer;
+    tmp.clear();
+    LLVMMath m(tmp, dbl);
+    m.emit("define internal %s @math_%s_%s(%s %%m0) #0 {\n", m.T, name,
+            dbl ? "f64" : "f32", m.T);
+
+    uint32_t result;
+    switch ((VarKind) v->kind) {
+        case VarKind::Sin:  result = m.sincos(0, false); break;
+        case VarKind::Cos:  result = m.sincos(0, true); break;
+        case VarKind::Exp2: result = m.exp2(0); break;
+        default:            result = m.log2(0); break;
+    }
+
+    m.emit("    ret %s %%m%u\n}", m.T, result);
+    jitc_register_global(tmp.get());
+
+    if (half) {
+        fmt("    $v_0 = fpext $V to $s\n"
+            "    $v_1 = call $s @math_$s_f32($s $v_0)\n"
+            "    $v = fptrunc $s $v_1 to $T\n",
+            v, a0, m.T,
+            v, m.T, name, m.T, v,
+            v, m.T, v, v);
+    } else {
+        fmt("    $v = call $T @math_$s_$h($V)\n", v, v, name, v, a0);
+    }
+}
+
+/// Largest gather source (in elements) that is handled using permutations
+#define DRJIT_LLVM_MAX_TABLE 64
+
+/**
+ * Render a gather from a small table of 32-bit values without accessing
+ * memory per lane. The table is loaded as a whole (this load is loop-invariant
+ * and typically hoisted out of the kernel's main loop), split into chunks of
+ * one packet, and each chunk is permuted using a sequence of variable
+ * 'extractelement' operations. LLVM recognizes this pattern and generates
+ * instructions like 'vpermps'/'vpermd' on x86. Chunks are combined based on
+ * the high bits of the index. Returns 'false' if the gather does not qualify.
+ */
+static bool jitc_llvm_render_gather_table(const Variable *v,
+                                          const Variable *ptr,
+                                          const Variable *index,
+                                          const Variable *mask) {
+    uint32_t width = jitc_llvm_vector_width;
+
+    // Subroutines receive a separate pointer per lane
+    if (callable_depth != 0 || !ptr->is_literal() || !ptr->dep[3] ||
+        type_size[v->type] != 4 || type_size[index->type] != 4)
+        return false;
+
+    uint32_t n = (uint32_t) jitc_var(ptr->dep[3])->size,
+             chunks = (n + width - 1) / width;
+
+    if (n < 2 || n > DRJIT_LLVM_MAX_TABLE || chunks > 4)
+        return false;
+
+    fmt("{    $v_0 = bitcast i8* $v to <$u x $t>*\n|}"
+        "    $v_l0 = load <$u x $t>, {<$u x $t>*} {$v_0|$v}, align $a, !alias.scope !2\n"
+        "    $v_l1 = and $V, <",
+        v, ptr, n, v,
+        v, n, v, n, v, v, ptr, v,
+        v, index);
+    for (uint32_t i = 0; i < width; ++i)
+        fmt("$t $u$s", index, width - 1, i + 1 < width ? ", " : ">\n");
+
+    for (uint32_t i = 0; i < width; ++i)
+        fmt("    $v_l2_$u = extractelement $T $v_l1, i32 $u\n", v, i, index,
+            v, i);
+
+    for (uint32_t c = 0; c < chunks; ++c) {
+        // Entries past the end of the table are zero-filled
+        fmt("    $v_l3_$u = shufflevector <$u x $t> $v_l0, <$u x $t> $z, "
+            "<$w x i32> <", v, c, n, v, v, n, v);
+        for (uint32_t i = 0; i < width; ++i)
+            fmt("i32 $u$s", std::min(c * width + i, n),
+                i + 1 < width ? ", " : ">\n");
+
+        for (uint32_t i = 0; i < width; ++i) {
+            fmt("    $v_l4_$u_$u = extractelement $T $v_l3_$u, $t $v_l2_$u\n",
+                v, c, i, v, v, c, index, v, i);
+            if (i == 0)
+                fmt("    $v_l5_$u_0 = insertelement $T undef, $t $v_l4_$u_0, i32 0\n",
+                    v, c, v, v, v, c);
+            else
+                fmt("    $v_l5_$u_$u = insertelement $T $v_l5_$u_$u, $t $v_l4_$u_$u, i32 $u\n",
+                    v, c, i, v, v, c, i - 1, v, v, c, i, i);
+        }
+    }
+
+    // Select the chunk based on the high bits of the index
+    fmt("    $v_l6_0 = bitcast $T $v_l5_0_$u to $T\n", v, v, v, width - 1, v);
+    for (uint32_t c = 1; c < chunks; ++c) {
+        fmt("    $v_l7_$u = icmp uge $V, <", v, c, index);
+        for (uint32_t i = 0; i < width; ++i)
+            fmt("$t $u$s", index, c * width, i + 1 < width ? ", " : ">\n");
+        fmt("    $v_l6_$u = select <$w x i1> $v_l7_$u, $T $v_l5_$u_$u, $T $v_l6_$u\n",
+            v, c, v, c, v, v, c, width - 1, v, v, c - 1);
+    }
+
+    fmt("    $v = select $V, $T $v_l6_$u, $T $z\n", v, mask, v, v, chunks - 1, v);
+
+    return true;
+}
+
+/// Largest lane stride that is turned into a (wide) vector load or store
+#define DRJIT_LLVM_MAX_STRIDE 4
+
+/**
+ * Try to express the index 'v' of a gather or scatter as an affine function
+ * 'base + stride * i' of the lane 'i' within the current packet. Uniform
+ * terms (literals and scalar variables) have a stride of zero. Returns
+ * 'false' when this cannot be established. Like the gather/scatter
+ * operations themselves, this assumes that index arithmetic does not
+ * overflow.
+ */
+static bool jitc_llvm_affine(const Variable *v, int64_t &stride,
+                             uint32_t depth = 0) {
+    if (v->is_literal() || (v->size == 1 && !v->placeholder)) {
+        stride = 0;
+        return true;
+    }
+
+    if (depth == 8 || !jitc_is_int(v))
+        return false;
+
+    const Variable *a0 = v->dep[0] ? jitc_var(v->dep[0]) : nullptr,
+                   *a1 = v->dep[1] ? jitc_var(v->dep[1]) : nullptr;
+    int64_t s0 = 0, s1 = 0;
+
+    switch ((VarKind) v->kind) {
+        case VarKind::Counter:
+            stride = 1;
+            return true;
+
+        case VarKind::Add:
+        case VarKind::Sub:
+            if (!jitc_llvm_affine(a0, s0, depth + 1) ||
+                !jitc_llvm_affine(a1, s1, depth + 1))
+                return false;
+            stride = (VarKind) v->kind == VarKind::Add ? s0 + s1 : s0 - s1;
+            break;
+
+        case VarKind::Neg:
+            if (!jitc_llvm_affine(a0, s0, depth + 1))
+                return false;
+            stride = -s0;
+            break;
+
+        case VarKind::Mul:
+        case VarKind::Fma:
+            // One of the factors must be a small positive literal
+            if (a0->is_literal())
+                std::swap(a0, a1);
+            if (!a1->is_literal() || a1->literal > DRJIT_LLVM_MAX_STRIDE ||
+                !jitc_llvm_affine(a0, s0, depth + 1))
+                return false;
+            stride = s0 * (int64_t) a1->literal;
+
+            // Fused multiply-adds additionally include the third operand
+            if ((VarKind) v->kind == VarKind::Fma) {
+                if (!jitc_llvm_affine(jitc_var(v->dep[2]), s1, depth + 1))
+                    return false;
+                stride += s1;
+            }
+            break;
+
+        case VarKind::Shl:
+            if (!a1->is_literal() || a1->literal > 2 ||
+                !jitc_llvm_affine(a0, s0, depth + 1))
+                return false;
+            stride = s0 * ((int64_t) 1 << a1->literal);
+            break;
+
+        case VarKind::Cast:
+            // Integer casts that don't discard information
+            if (!jitc_is_int(a0) || type_size[a0->type] > type_size[v->type])
+                return false;
+            return jitc_llvm_affine(a0, stride, depth + 1);
+
+        default:
+            return false;
+    }
+
+    return stride >= -DRJIT_LLVM_MAX_STRIDE && stride <= DRJIT_LLVM_MAX_STRIDE;
+}
+
+/// Lane stride of a gather/scatter index if it can use vector loads/stores, else 0
+static uint32_t jitc_llvm_stride(const Variable *index) {
+    int64_t stride = 0;
+
+    // Subroutines receive a separate pointer per lane, and the lanes of
+    // kernels with coherent dispatch are permuted
+    if (callable_depth != 0 || coherent_dispatch.perm_slot ||
+        !jitc_llvm_affine(index, stride) || stride < 1)
+        return 0;
+
+    return (uint32_t) stride;
+}
+
+/**
+ * Issue prefetches for the addresses that the gather 'v' will access
+ * 'prefetch_distance' iterations of the kernel's main loop later. This is
+ * only possible when the index is loaded from an evaluated array, in which
+ * case the future indices can simply be read ahead of time. Lookahead
+ * positions past the end of the current block fall back to the current
+ * packet, which is known to be valid.
+ */
+static void jitc_llvm_render_prefetch(const Variable *v, const Variable *ptr,
+                                      const Variable *index) {
+    if (index->cold().param_type != ParamType::Input || index->size == 1 ||
+        index->is_literal() || !jitc_is_int(index))
+        return;
+
+    fmt_intrinsic("declare void @llvm.prefetch({i8*}, i32, i32, i32)");
+
+    fmt("    $v_q0 = add i64 %index, $u\n"
+        "    $v_q1 = icmp ult i64 $v_q0, %end\n"
+        "    $v_q2 = select i1 $v_q1, i64 $v_q0, i64 %index\n"
+        "    $v_q3 = getelementptr inbounds $t, {$t*} $v_p3, i64 $v_q2\n"
+        "{    $v_q4 = bitcast $t* $v_q3 to $T*\n|}"
+        "    $v_q5 = load $T, {$T*} {$v_q4|$v_q3}, align $A, !alias.scope !2\n"
+        "{    $v_q6 = bitcast i8* $v to $t*\n|}"
+        "    $v_q7 = getelementptr $t, {$t*} {$v_q6|$v}, $T $v_q5\n"
+        "{    $v_q8 = bitcast <$w x $t*> $v_q7 to <$w x i8*>\n|}",
+        v, prefetch_distance * jitc_llvm_vector_width,
+        v, v,
+        v, v, v,
+        v, index, index, index, v,
+        v, index, v, index,
+        v, index, index, v, v, index,
+        v, ptr, v,
+        v, v, v, v, ptr, index, v,
+        v, v, v);
+
+    for (uint32_t i = 0; i < jitc_llvm_vector_width; ++i)
+        fmt("    $v_q9_$u = extractelement <$w x {i8*}> {$v_q8|$v_q7}, i32 $u\n"
+            "    call void @llvm.prefetch({i8*} $v_q9_$u, i32 0, i32 3, i32 1)\n",
+            v, i, v, v, i, v, i);
+}
+
+/// Scalar pointer to the first lane of an affine gather/scatter (in '$v_4/5')
+static void jitc_llvm_render_affine_ptr(const Variable *v, const Variable *ptr,
+                                        const Variable *type,
+                                        const Variable *index, uint32_t count) {
+    fmt("{    $v_0 = bitcast i8* $v to $t*\n|}"
+        "    $v_3 = extractelement $V, i32 0\n"
+        "    $v_4 = getelementptr $t, {$t*} {$v_0|$v}, $t $v_3\n"
+        "{    $v_5 = bitcast $t* $v_4 to <$u x $t>*\n|}",
+        v, ptr, type,
+        v, index,
+        v, type, type, v, ptr, index, v,
+        v, type, v, count, type);
+}
+
+/// Expand the mask of a strided access to all covered elements (in '$v_6')
+static void jitc_llvm_render_affine_mask(const Variable *v, const Variable *mask,
+                                         uint32_t stride) {
+    uint32_t width = jitc_llvm_vector_width, count = width * stride;
+    fmt("    $v_6 = shufflevector $V, <$w x i1> $z, <$u x i32> <",
+        v, mask, count);
+    for (uint32_t i = 0; i < count; ++i)
+        fmt("i32 $u$s", i % stride == 0 ? i / stride : width,
+            i + 1 < count ? ", " : ">\n");
+}
+
+/**
+ * Render a gather whose index has a constant lane stride as a masked vector
+ * load. Strided accesses load the covered range (masking the elements in
+ * between) and extract the relevant entries using a shuffle.
+ */
+static void jitc_llvm_render_gather_affine(const Variable *v,
+                                           const Variable *ptr,
+                                           const Variable *index,
+                                           const Variable *mask,
+                                           uint32_t stride,
+                                           const char *suffix) {
+    uint32_t count = jitc_llvm_vector_width * stride;
+
+    fmt_intrinsic("declare <$u x $t> @llvm.masked.load.v$u$h({<$u x $t>*}, "
+                  "i32, <$u x i1>, <$u x $t>)",
+                  count, v, count, v, count, v, count, count, v);
+
+    jitc_llvm_render_affine_ptr(v, ptr, v, index, count);
+
+    if (stride == 1) {
+        fmt("    $v$s = call $T @llvm.masked.load.v$w$h({$T*} {$v_5|$v_4}, "
+            "i32 $a, $V, $T $z)\n",
+            v, suffix, v, v, v, v, v, v, mask, v);
+        return;
+    }
+
+    jitc_llvm_render_affine_mask(v, mask, stride);
+
+    fmt("    $v_7 = call <$u x $t> @llvm.masked.load.v$u$h({<$u x $t>*} "
+        "{$v_5|$v_4}, i32 $a, <$u x i1> $v_6, <$u x $t> $z)\n"
+        "    $v$s = shufflevector <$u x $t> $v_7, <$u x $t> undef, <$w x i32> <",
+        v, count, v, count, v, count, v, v, v, v, count, v, count, v,
+        v, suffix, count, v, v, count, v);
+    for (uint32_t i = 0; i < jitc_llvm_vector_width; ++i)
+        fmt("i32 $u$s", i * stride,
+            i + 1 < jitc_llvm_vector_width ? ", " : ">\n");
+}
+
+/// Scatter counterpart of \ref jitc_llvm_render_gather_affine()
+static void jitc_llvm_render_scatter_affine(const Variable *v,
+                                            const Variable *ptr,
+                                            const Variable *value,
+                                            const Variable *index,
+                                            const Variable *mask,
+                                            uint32_t stride) {
+    uint32_t count = jitc_llvm_vector_width * stride;
+
+    fmt_intrinsic("declare void @llvm.masked.store.v$u$h(<$u x $t>, "
+                  "{<$u x $t>*}, i32, <$u x i1>)",
+                  count, value, count, value, count, value, count);
+
+    jitc_llvm_render_affine_ptr(v, ptr, value, index, count);
+
+    if (stride == 1) {
+        fmt("    call void @llvm.masked.store.v$w$h($V, {$T*} {$v_5|$v_4}, "
+            "i32 $a, $V)\n",
+            value, value, value, v, v, value, mask);
+        return;
+    }
+
+    jitc_llvm_render_affine_mask(v, mask, stride);
+
+    // Entries between the strided elements are masked, their value is irrelevant
+    fmt("    $v_7 = shufflevector $V, $T undef, <$u x i32> <",
+        v, value, value, count);
+    for (uint32_t i = 0; i < count; ++i)
+        fmt("i32 $u$s", i / stride, i + 1 < count ? ", " : ">\n");
+
+    fmt("    call void @llvm.masked.store.v$u$h(<$u x $t> $v_7, {<$u x $t>*} "
+        "{$v_5|$v_4}, i32 $a, <$u x i1> $v_6)\n",
+        count, value, count, value, v, count, value, v, v, value, count, v);
+}
+
+/**
+ * \brief Load the lane permutation of the current packet (coherent dispatch)
+ *
+ * Defines \c %lane and \c %lane_64 with the original index of each lane,
+ * and the mask \c %lane_active used by the gathers and scatters below.
+ */
+static void jitc_llvm_render_coherent_lanes() {
+    fmt( "    %lane_p1 = getelementptr inbounds {i8*}, {i8**} %params, i32 $u\n"
+         "    %lane_p{2|3} = load {i8*}, {i8**} %lane_p1, align 8, !alias.scope !2\n"
+        "{    %lane_p3 = bitcast i8* %lane_p2 to i32*\n|}"
+         "    %lane_offset = sub i64 %index, %start\n"
+         "    %lane_p{4|5} = getelementptr inbounds i32, {i32*} %lane_p3, i64 %lane_offset\n"
+        "{    %lane_p5 = bitcast i32* %lane_p4 to <$w x i32>*\n|}"
+         "    %lane = load <$w x i32>, {<$w x i32>*} %lane_p5, align 4, !alias.scope !2\n"
+         "    %lane_64 = zext <$w x i32> %lane to <$w x i64>\n"
+         "    %lane_active_0 = insertelement <$w x i1> undef, i1 true, i32 0\n"
+         "    %lane_active = shufflevector <$w x i1> %lane_active_0, <$w x i1> undef, <$w x i32> $z\n",
+        coherent_dispatch.perm_slot);
+}
+
+/// Gather a packet of an input array from the permuted lanes
+static void jitc_llvm_render_coherent_load(const Variable *v) {
+    bool is_bool = (VarType) v->type == VarType::Bool;
+    const char *suffix = is_bool ? "i8" : type_name_llvm_abbrev[v->type];
+
+    fmt_intrinsic("declare $M @llvm.masked.gather.v$w$s(<$w x {$m*}>, i32, <$w x i1>, $M)",
+                  v, suffix, v, v);
+    fmt("    $v$s = call $M @llvm.masked.gather.v$w$s(<$w x {$m*}> $v_p5, i32 $a, <$w x i1> %lane_active, $M undef), !alias.scope !2\n",
+        v, is_bool ? "_0" : "", v, suffix, v, v, v, v);
+
+    if (is_bool)
+        fmt("    $v = trunc $M $v_0 to $T\n", v, v, v, v);
+}
+
+/// Scatter a packet of an output array to the permuted lanes
+static void jitc_llvm_render_coherent_store(const Variable *v) {
+    bool is_bool = (VarType) v->type == VarType::Bool;
+    const char *suffix = is_bool ? "i8" : type_name_llvm_abbrev[v->type];
+
+    fmt_intrinsic("declare void @llvm.masked.scatter.v$w$s($M, <$w x {$m*}>, i32, <$w x i1>)",
+                  suffix, v, v);
+
+    if (!is_bool) {
+        fmt("    call void @llvm.masked.scatter.v$w$s($V, <$w x {$m*}> $v_p5, i32 $a, <$w x i1> %lane_active), !noalias !2\n",
+            suffix, v, v, v, v);
+    } else {
+        fmt("    $v_e = zext $V to $M\n"
+            "    call void @llvm.masked.scatter.v$w$s($M $v_e, <$w x {$m*}> $v_p5, i32 $a, <$w x i1> %lane_active), !noalias !2\n",
+            v, v, v, suffix, v, v, v, v, v);
+    }
+}
+
+/// Targets of privatized scatter-reductions have at most this many entries
+#define DRJIT_LLVM_PRIVATE_SCATTER_SIZE 16384
+
+/**
+ * \brief Determine scatter-reductions of the current kernel that should be
+ * privatized (see \ref jitc_run_private())
+ *
+ * Privatization pays off when a large kernel reduces into a small array,
+ * where atomic operations of different threads frequently collide. Every
+ * target must be exclusively accessed by scatter-reductions of a single type
+ * and operation, since the kernel never observes the actual array.
+ */
+static void jitc_llvm_private_scan(const ScheduledGroup &group) {
+    private_scatters.clear();
+
+    if (!(jitc_flags() & (uint32_t) JitFlag::AtomicReduceLocal) ||
+        group.size < 4 * DRJIT_POOL_BLOCK_SIZE || pool_size() < 2)
+        return;
+
+    for (uint32_t gi = group.start; gi != group.end; ++gi) {
+        const Variable *v = jitc_var(schedule[gi].index);
+        if (v->kind != (uint32_t) VarKind::Scatter &&
+            v->kind != (uint32_t) VarKind::Gather)
+            continue;
+
+        const Variable *ptr = jitc_var(v->dep[0]);
+        if (!ptr->is_literal() || !ptr->dep[3] ||
+            ptr->cold().param_type != ParamType::Input)
+            continue;
+
+        uint32_t slot = ptr->cold().param_offset / (uint32_t) sizeof(void *),
+                 size = (uint32_t) jitc_var(ptr->dep[3])->size;
+        VarType vt = (VarType) jitc_var(v->dep[1])->type;
+        ReduceOp op = (ReduceOp) v->literal;
+        uint32_t tsize = type_size[(int) vt];
+
+        bool eligible =
+            v->kind == (uint32_t) VarKind::Scatter && op != ReduceOp::None &&
+            !v->unique_index && (tsize == 4 || tsize == 8) &&
+            size <= DRJIT_LLVM_PRIVATE_SCATTER_SIZE && 16 * size <= group.size;
+
+        if (jitc_is_float(vt))
+            eligible &= op != ReduceOp::And && op != ReduceOp::Or;
+        else if (op == ReduceOp::Min || op == ReduceOp::Max)
+            eligible &= jitc_llvm_version_major >= 12;
+
+        PrivateScatter *ps = nullptr;
+        for (PrivateScatter &ps2 : private_scatters) {
+            if (ps2.slot == slot)
+                ps = &ps2;
+        }
+
+        if (!ps) {
+            // Ineligible targets are recorded with size 0 and removed below
+            private_scatters.push_back(
+                PrivateScatter{ slot, eligible ? size : 0, vt, op });
+        } else if (!eligible || ps->type != vt || ps->op != op) {
+            ps->size = 0;
+        }
+    }
+
+    private_scatters.erase(
+        std::remove_if(private_scatters.begin(), private_scatters.end(),
+                       [](const PrivateScatter &ps) { return ps.size == 0; }),
+        private_scatters.end());
+}
+
+/// Does 'ptr' refer to a privatized scatter-reduction target?
+static bool jitc_llvm_is_private(const Variable *ptr) {
+    if (callable_depth > 0 || !ptr->is_literal() ||
+        ptr->cold().param_type != ParamType::Input)
+        return false;
+
+    uint32_t slot = ptr->cold().param_offset / (uint32_t) sizeof(void *);
+    for (const PrivateScatter &ps : private_scatters) {
+        if (ps.slot == slot)
+            return true;
+    }
+    return false;
+}
+
+/**
+ * \brief Return the LLVM instruction (or intrinsic, in which case 'intrinsic'
+ * is set to \c true) that combines two values of a scatter-reduction
+ */
+static const char *jitc_llvm_reduce_combine(ReduceOp op, const Variable *value,
+                                            bool &intrinsic) {
+    bool is_float = jitc_is_float(value),
+         is_uint = jitc_is_uint(value);
+
+    intrinsic = op == ReduceOp::Min || op == ReduceOp::Max;
+
+    switch (op) {
+        case ReduceOp::Add: return is_float ? "fadd" : "add";
+        case ReduceOp::Mul: return is_float ? "fmul" : "mul";
+
+        case ReduceOp::Min:
+            if (is_float)
+                return "minnum";
+            if (jitc_llvm_version_major < 12)
+                return nullptr;
+            return is_uint ? "umin" : "smin";
+
+        case ReduceOp::Max:
+            if (is_float)
+                return "maxnum";
+            if (jitc_llvm_version_major < 12)
+                return nullptr;
+            return is_uint ? "umax" : "smax";
+
+        case ReduceOp::And: return is_float ? nullptr : "and";
+        case ReduceOp::Or:  return is_float ? nullptr : "or";
+        default: return nullptr;
+    }
+}
+
+/// Scatter-reduction with unique indices: gather, combine, and scatter
+static void jitc_llvm_render_scatter_unique(const Variable *v,
+                                            const Variable *value,
+                                            const Variable *mask,
+                                            const char *op, bool intrinsic) {
+    fmt_intrinsic("declare $T @llvm.masked.gather.v$w$h(<$w x {$t*}>, i32, $T, $T)",
+                  value, value, value, mask, value);
+    fmt("    $v_2 = call $T @llvm.masked.gather.v$w$h(<$w x {$t*}> $v_1, i32 $a, $V, $T $z)\n",
+        v, value, value, value, v, value, mask, value);
+
+    if (intrinsic) {
+        fmt_intrinsic("declare $T @llvm.$s.v$w$h($T, $T)",
+                      value, op, value, value, value);
+        fmt("    $v_3 = call $T @llvm.$s.v$w$h($T $v_2, $V)\n",
+            v, value, op, value, value, v, value);
+    } else {
+        fmt("    $v_3 = $s $T $v_2, $v\n", v, op, value, v, value);
+    }
+
+    fmt_intrinsic("declare void @llvm.masked.scatter.v$w$h($T, <$w x {$t*}>, i32, $T)",
+                  value, value, value, mask);
+    fmt("    call void @llvm.masked.scatter.v$w$h($T $v_3, <$w x {$t*}> $v_1, i32 $a, $V)\n",
+        value, value, v, value, v, value, mask);
+}
+
+/**
+ * \brief Scatter-reduction into a privatized target. Other threads cannot
+ * access the target, hence the lanes are combined using plain loads and
+ * stores in sequence (which also handles lanes with identical indices).
+ */
+static void jitc_llvm_render_scatter_private(const Variable *v,
+                                             const Variable *value,
+                                             const Variable *mask,
+                                             const char *op, bool intrinsic) {
+    if (intrinsic)
+        fmt_intrinsic("declare $t @llvm.$s.$h($t, $t)",
+                      value, op, value, value, value);
+
+    size_t offset = buffer.size();
+    fmt("define internal void @reduce_private_$s_$h(<$w x {$t*}> %ptr, $T %value, <$w x i1> %active) #0 ${\n"
+        "L0:\n"
+        "   br label %L1\n\n"
+        "L1:\n"
+        "   %index = phi i32 [ 0, %L0 ], [ %index_next, %L3 ]\n"
+        "   %active_i = extractelement <$w x i1> %active, i32 %index\n"
+        "   br i1 %active_i, label %L2, label %L3\n\n"
+        "L2:\n"
+        "   %ptr_i = extractelement <$w x {$t*}> %ptr, i32 %index\n"
+        "   %value_i = extractelement $T %value, i32 %index\n"
+        "   %prev = load $t, {$t*} %ptr_i, align $a\n",
+        op, value, value, value, value, value, value, value, value);
+
+    if (intrinsic)
+        fmt("   %next = call $t @llvm.$s.$h($t %prev, $t %value_i)\n",
+            value, op, value, value, value);
+    else
+        fmt("   %next = $s $t %prev, %value_i\n", op, value);
+
+    fmt("   store $t %next, {$t*} %ptr_i, align $a\n"
+        "   br label %L3\n\n"
+        "L3:\n"
+        "   %index_next = add nuw nsw i32 %index, 1\n"
+        "   %done = icmp eq i32 %index_next, $w\n"
+        "   br i1 %done, label %L4, label %L1\n\n"
+        "L4:\n"
+        "   ret void\n"
+        "$}",
+        value, value, value);
+
+    jitc_register_global(buffer.get() + offset);
+    buffer.rewind_to(offset);
+
+    fmt("    call void @reduce_private_$s_$h(<$w x {$t*}> $v_1, $V, $V)\n",
+        op, value, value, v, value, mask);
+}
+
 static void jitc_llvm_render_scatter(const Variable *v,
                                      const Variable *ptr,
                                      const Variable *value,
                                      const Variable *index,
                                      const Variable *mask) {
+    if (!v->literal) {
+        uint32_t stride = jitc_llvm_stride(index);
+        if (stride) {
+            jitc_llvm_render_scatter_affine(v, ptr, value, index, mask, stride);
+            return;
+        }
+    }
     fmt("{    $v_0 = bitcast $<i8*$> $v to $<$t*$>\n|}"
          "    $v_1 = getelementptr $t, $<{$t*}$> {$v_0|$v}, $V\n",
         v, ptr, value,
         v, value, value, v, ptr, index);
 
+    if (v->literal && (VarType) value->type != VarType::Bool) {
+        bool intrinsic;
+        const char *op = jitc_llvm_reduce_combine((ReduceOp) v->literal,
+                                                  value, intrinsic);
+        if (op && v->unique_index) {
+            jitc_llvm_render_scatter_unique(v, value, mask, op, intrinsic);
+            return;
+        } else if (op && jitc_llvm_is_private(ptr)) {
+            jitc_llvm_render_scatter_private(v, value, mask, op, intrinsic);
+            return;
+        }
+    }
+
     if (!v->literal) {
         fmt_intrinsic("declare void @llvm.masked.scatter.v$w$h($T, <$w x {$t*}>, i32, $T)",
              value, value, value, mask);
@@ -1049,7 +2285,7 @@ static void jitc_llvm_render_printf(uint32_t index, const Variable *v,
     jitc_register_global(buffer.get() + buffer_offset);
     buffer.rewind_to(buffer_offset);
 
-    uint32_t idx = v->reg_index;
+    uint32_t idx = v->cold().reg_index;
 
     fmt("    br label %l$u_start\n\n"
         "l$u_start: ; ---- printf_async() ----\n"
@@ -1103,82 +2339,6 @@ static void jitc_llvm_render_printf(uint32_t index, const Variable *v,
         idx, idx, v, v, v, v, v, idx, idx, idx);
 }
 
-/// Convert an IR template with '$' expressions into valid IR
-static void jitc_llvm_render_stmt(uint32_t index, const Variable *v, bool in_function) {
-    const char *s = v->stmt;
-    if (unlikely(!s || *s == '\0'))
-        return;
-    put("    ");
-    char c;
-    size_t intrinsic_start = 0;
-    do {
-        const char *start = s;
-        while (c = *s, c != '\0' && c != '$')
-            s++;
-        put(start, s - start);
-
-        if (c == '$') {
-            s++;
-            const char **prefix_table = nullptr, tname = *s++;
-            switch (tname) {
-                case '[':
-                    intrinsic_start = buffer.size();
-                    continue;
-
-                case ']':
-                    jitc_register_global(buffer.get() + intrinsic_start);
-                    buffer.rewind_to(intrinsic_start);
-                    continue;
-
-                case 'n': put("\n    "); continue;
-                case 'z': put("zeroinitializer"); continue;
-                case 'w': buffer.put_u32(jitc_llvm_vector_width); continue;
-                case 't': prefix_table = type_name_llvm; break;
-                case 'T': prefix_table = type_name_llvm_big; break;
-                case 'b': prefix_table = type_name_llvm_bin; break;
-                case 'a': prefix_table = type_name_llvm_abbrev; break;
-                case 's': prefix_table = type_size_str; break;
-                case 'r': prefix_table = type_prefix; break;
-                case 'i': prefix_table = nullptr; break;
-                case '<': if (in_function) {
-                              put('<');
-                              buffer.put_u32(jitc_llvm_vector_width);
-                              put(" x ");
-                           }
-                           continue;
-                case '>': if (in_function)
-                              put('>');
-                           continue;
-                case 'o': prefix_table = (const char **) jitc_llvm_ones_str; break;
-                default:
-                    jitc_fail("jit_render_stmt_llvm(): encountered invalid \"$\" "
-                              "expression (unknown character \"%c\") in \"%s\"!", tname, v->stmt);
-            }
-
-            uint32_t arg_id = *s++ - '0';
-            if (unlikely(arg_id > 4))
-                jitc_fail("jit_render_stmt_llvm(%s): encountered invalid \"$\" "
-                          "expression (argument out of bounds)!", v->stmt);
-
-            uint32_t dep_id = arg_id == 0 ? index : v->dep[arg_id - 1];
-            if (unlikely(dep_id == 0))
-                jitc_fail("jit_render_stmt_llvm(%s): encountered invalid \"$\" "
-                          "expression (referenced variable %u is missing)!", v->stmt, arg_id);
-
-            const Variable *dep = jitc_var(dep_id);
-            if (likely(prefix_table)) {
-                const char *prefix = prefix_table[(int) dep->type];
-                put(prefix, strlen(prefix));
-            }
-
-            if (tname == 'r' || tname == 'i')
-                buffer.put_u32(dep->reg_index);
-        }
-    } while (c != '\0');
-
-    put('\n');
-}
-
 void jitc_llvm_ray_trace(uint32_t func, uint32_t scene, int shadow_ray,
                          const uint32_t *in, uint32_t *out) {
     const uint32_t n_args = 14;
@@ -1191,7 +2351,7 @@ void jitc_llvm_ray_trace(uint32_t func, uint32_t scene, int shadow_ray,
                      VarType::UInt32, VarType::UInt32 };
 
     bool placeholder = false, dirty = false;
-    uint32_t size = 0;
+    uint64_t size = 0;
     for (uint32_t i = 0; i < n_args; ++i) {
         const Variable *v = jitc_var(in[i]);
         if ((VarType) v->type != types[i])
@@ -1215,7 +2375,7 @@ void jitc_llvm_ray_trace(uint32_t func, uint32_t scene, int shadow_ray,
     }
 
     if (dirty) {
-        jitc_eval(thread_state(JitBackend::LLVM));
+        jitc_eval_dirty(thread_state(JitBackend::LLVM), in, n_args);
         dirty = false;
 
         for (uint32_t i = 0; i < n_args; ++i)
@@ -1237,7 +2397,7 @@ void jitc_llvm_ray_trace(uint32_t func, uint32_t scene, int shadow_ray,
         valid = steal(jitc_var_select(valid, minus_one, zero));
     }
 
-    jitc_log(InfoSym, "jitc_llvm_ray_trace(): tracing %u %sray%s%s", size,
+    jitc_log(InfoSym, "jitc_llvm_ray_trace(): tracing %zu %sray%s%s", (size_t) size,
              shadow_ray ? "shadow " : "", size != 1 ? "s" : "",
              placeholder ? " (part of a recorded computation)" : "");
 
@@ -1388,9 +2548,9 @@ static void jitc_llvm_render_trace(uint32_t index, const Variable *v,
              "    $v_func_ptr = inttoptr i64 $v_func_i64 to {i8*}\n"
              "    $v_tfar_{0|1} = getelementptr inbounds i8, {i8*} %buffer, i32 $u\n"
             "{    $v_tfar_1 = bitcast i8* $v_tfar_0 to <$w x $s> *\n|}",
-            v->reg_index,
-            v->reg_index,
-            v, func->reg_index,
+            v->cold().reg_index,
+            v->cold().reg_index,
+            v, func->cold().reg_index,
             v, v,
             v, offset_tfar,
             v, v, tname_tfar);
@@ -1403,7 +2563,7 @@ static void jitc_llvm_render_trace(uint32_t index, const Variable *v,
         // Get original mask, to be overwritten at every iteration
         fmt("    $v_mask_value = load <$w x i32>, {<$w x i32>*} $v_in_0_1, align 64\n"
             "    br label %l$u_check\n",
-            v, v, v->reg_index);
+            v, v, v->cold().reg_index);
 
         // =====================================================
         // 2. Move on to the next instance & check if finished
@@ -1416,13 +2576,13 @@ static void jitc_llvm_render_trace(uint32_t index, const Variable *v,
             "    $v_next = inttoptr i64 $v_next_i64 to {i8*}\n"
             "    $v_valid = icmp ne {i8*} $v_next, null\n"
             "    br i1 $v_valid, label %l$u_call, label %l$u_end\n",
-            v->reg_index,
-            v, scene->reg_index, v->reg_index, v, v->reg_index,
+            v->cold().reg_index,
+            v, scene->cold().reg_index, v->cold().reg_index, v, v->cold().reg_index,
             v, v,
             v, v,
             v, v,
             v, v,
-            v, v->reg_index, v->reg_index);
+            v, v->cold().reg_index, v->cold().reg_index);
 
         // =====================================================
         // 3. Perform ray tracing call to each unique instance
@@ -1436,7 +2596,7 @@ static void jitc_llvm_render_trace(uint32_t index, const Variable *v,
             "    $v_active = icmp eq <$w x {i8*}> $v_scene, $v_bcast_2\n"
             "    $v_active_2 = select <$w x i1> $v_active, <$w x i32> $v_mask_value, <$w x i32> $z\n"
             "    store <$w x i32> $v_active_2, {<$w x i32>*} $v_in_0_1, align 64\n",
-            v->reg_index,
+            v->cold().reg_index,
             v, tname_tfar, tname_tfar, v, float_size * width,
             v, v,
             v, v,
@@ -1462,7 +2622,7 @@ static void jitc_llvm_render_trace(uint32_t index, const Variable *v,
             v, v, tname_tfar, v, tname_tfar, v,
             tname_tfar, v, tname_tfar, v, float_size * width,
             v, v, v,
-            v->reg_index, v->reg_index);
+            v->cold().reg_index, v->cold().reg_index);
     }
 
     offset = (8 * float_size + 4) * width;
@@ -1548,10 +2708,9 @@ void jitc_var_vcall_assemble_llvm(VCall *vcall, uint32_t vcall_reg,
     uint32_t offset = 0;
     for (uint32_t i = 0; i < (uint32_t) vcall->in.size(); ++i) {
         uint32_t index = vcall->in[i];
-        auto it = state.variables.find(index);
-        if (it == state.variables.end())
+        const Variable *v2 = state.variables.find(index);
+        if (!v2)
             continue;
-        const Variable *v2 = &it->second;
 
         fmt(
              "    %u$u_in_$u_{0|1} = getelementptr inbounds i8, {i8*} %buffer, i32 $u\n"
@@ -1580,10 +2739,9 @@ void jitc_var_vcall_assemble_llvm(VCall *vcall, uint32_t vcall_reg,
     offset = 0;
     for (uint32_t i = 0; i < n_out; ++i) {
         uint32_t index = vcall->out_nested[i];
-        auto it = state.variables.find(index);
-        if (it == state.variables.end())
+        const Variable *v2 = state.variables.find(index);
+        if (!v2)
             continue;
-        const Variable *v2 = &it->second;
 
         fmt( "    %u$u_tmp_$u_{0|1} = getelementptr inbounds i8, {i8*} %u$u_out, i64 $u\n"
             "{    %u$u_tmp_$u_1 = bitcast i8* %u$u_tmp_$u_0 to $M*\n|}"
@@ -1669,20 +2827,18 @@ void jitc_var_vcall_assemble_llvm(VCall *vcall, uint32_t vcall_reg,
     for (uint32_t i = 0; i < n_out; ++i) {
         uint32_t index = vcall->out_nested[i],
                  index_2 = vcall->out[i];
-        auto it = state.variables.find(index);
-        if (it == state.variables.end())
+        const Variable *v = state.variables.find(index);
+        if (!v)
             continue;
-        uint32_t size = type_size[it->second.type],
+        uint32_t size = type_size[v->type],
                  load_offset = offset;
         offset += size * width;
 
         // Skip if outer access expired
-        auto it2 = state.variables.find(index_2);
-        if (it2 == state.variables.end())
+        const Variable *v2 = state.variables.find(index_2);
+        if (!v2)
             continue;
-
-        const Variable *v2 = &it2.value();
-        if (v2->reg_index == 0 || v2->param_type == ParamType::Input)
+        if (v2->cold().reg_index == 0 || v2->cold().param_type == ParamType::Input)
             continue;
 
         VarType vt = (VarType) v2->type;
@@ -100,23 +100,24 @@ void jitc_llvm_mcjit_shutdown() {
     jitc_llvm_patch_loc = 0;
 }
 
-void jitc_llvm_mcjit_compile(void *llvm_module,
+void jitc_llvm_mcjit_compile(void *llvm_module, const char *name,
+                             bool callables,
                              std::vector<uint8_t*> &symbols) {
     LLVMExecutionEngineRef engine = jitc_llvm_engine_create((LLVMModuleRef) llvm_module);
 
-    auto resolve = [&](const char *name) -> uint8_t * {
-        uint8_t *p = (uint8_t *) LLVMGetFunctionAddress(engine, name);
+    auto resolve = [&](const char *symbol) -> uint8_t * {
+        uint8_t *p = (uint8_t *) LLVMGetFunctionAddress(engine, symbol);
         if (unlikely(!p))
             jitc_fail("jit_llvm_compile(): internal error: could not resolve "
-                      "symbol \"%s\"!\n", name);
+                      "symbol \"%s\"!\n", symbol);
         return p;
     };
 
     size_t symbol_pos = 0;
-    symbols[symbol_pos++] = resolve(kernel_name);
+    symbols[symbol_pos++] = resolve(name);
 
     /// Does the kernel perform virtual function calls via @callables?
-    if (callable_count_unique) {
+    if (callables) {
         symbols[symbol_pos++] = resolve("callables");
 
         for (auto const &kv: globals_map) {
@@ -128,7 +129,9 @@ void jitc_llvm_mcjit_compile(void *llvm_module,
                      (unsigned long long) kv.first.hash.high64,
                      (unsigned long long) kv.first.hash.low64);
 
-            symbols[symbol_pos++] = resolve(name_buf);
+            // Library callables are linked later (see jitc_llvm_link())
+            symbols[symbol_pos++] =
+                kv.second.library ? nullptr : resolve(name_buf);
         }
     }
 
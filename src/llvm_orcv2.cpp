@@ -72,7 +72,8 @@ void jitc_llvm_orcv2_shutdown() {
     jitc_llvm_lljit_dylib = nullptr;
 }
 
-void jitc_llvm_orcv2_compile(void *llvm_module,
+void jitc_llvm_orcv2_compile(void *llvm_module, const char *name,
+                             bool callables,
                              std::vector<uint8_t*> &symbols) {
     LLVMErrorRef err = LLVMOrcJITDylibClear(jitc_llvm_lljit_dylib);
     if (err)
@@ -91,9 +92,9 @@ void jitc_llvm_orcv2_compile(void *llvm_module,
         jitc_fail("jit_llvm_compile(): could not add module: %s",
                   LLVMGetErrorMessage(err));
 
-    auto resolve = [&](const char *name) -> uint8_t * {
+    auto resolve = [&](const char *symbol) -> uint8_t * {
         LLVMOrcExecutorAddress p;
-        LLVMErrorRef err = LLVMOrcLLJITLookup(jitc_llvm_lljit, &p, name);
+        LLVMErrorRef err = LLVMOrcLLJITLookup(jitc_llvm_lljit, &p, symbol);
         if (err)
             jitc_fail("jit_llvm_compile(): could not resolve symbol: %s",
                       LLVMGetErrorMessage(err));
@@ -101,10 +102,10 @@ void jitc_llvm_orcv2_compile(void *llvm_module,
     };
 
     size_t symbol_pos = 0;
-    symbols[symbol_pos++] = resolve(kernel_name);
+    symbols[symbol_pos++] = resolve(name);
 
     /// Does the kernel perform virtual function calls via @callables?
-    if (callable_count_unique) {
+    if (callables) {
         symbols[symbol_pos++] = resolve("callables");
 
         for (auto const &kv: globals_map) {
@@ -115,7 +116,9 @@ void jitc_llvm_orcv2_compile(void *llvm_module,
             snprintf(name_buf, sizeof(name_buf), "func_%016llx%016llx",
                      (unsigned long long) kv.first.hash.high64,
                      (unsigned long long) kv.first.hash.low64);
-            symbols[symbol_pos++] = resolve(name_buf);
+            // Library callables are linked later (see jitc_llvm_link())
+            symbols[symbol_pos++] =
+                kv.second.library ? nullptr : resolve(name_buf);
         }
     }
 }
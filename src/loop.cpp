@@ -68,15 +68,16 @@ uint32_t jitc_var_loop_init(size_t n_indices, uint32_t **indices) {
 
     // Determine the variable size
     JitBackend backend = (JitBackend) jitc_var(*indices[0])->backend;
-    uint32_t size = 0;
+    uint64_t size = 0;
     bool dirty = false;
 
     for (size_t i = 0; i < n_indices; ++i) {
         const Variable *v = jitc_var(*indices[i]);
-        uint32_t vsize = v->size;
+        uint64_t vsize = v->size;
         if (size != 0 && vsize != 1 && size != 1 && vsize != size)
             jitc_raise("jit_var_loop_init(): loop state variables have an "
-                       "inconsistent size (%u vs %u)!", vsize, size);
+                       "inconsistent size (%zu vs %zu)!", (size_t) vsize,
+                       (size_t) size);
         if (vsize > size)
             size = vsize;
 
@@ -85,7 +86,10 @@ uint32_t jitc_var_loop_init(size_t n_indices, uint32_t **indices) {
 
     // Ensure side effects are fully processed
     if (dirty) {
-        jitc_eval(thread_state(backend));
+        std::vector<uint32_t> inputs(n_indices);
+        for (size_t i = 0; i < n_indices; ++i)
+            inputs[i] = *indices[i];
+        jitc_eval_dirty(thread_state(backend), inputs.data(), n_indices);
         dirty = false;
         for (size_t i = 0; i < n_indices; ++i)
             dirty |= jitc_var(*indices[i])->is_dirty();
@@ -95,7 +99,6 @@ uint32_t jitc_var_loop_init(size_t n_indices, uint32_t **indices) {
     }
 
     Variable v;
-    v.kind = (uint32_t) VarKind::Stmt;
     v.size = size;
     v.placeholder = 1;
     v.backend = (uint32_t) backend;
@@ -103,7 +106,7 @@ uint32_t jitc_var_loop_init(size_t n_indices, uint32_t **indices) {
     // Copy loop state before entering loop (CUDA)
     if (backend == JitBackend::CUDA) {
         jitc_new_scope(backend);
-        v.stmt = (char *) "mov.$t0 $r0, $r1";
+        v.kind = (uint32_t) VarKind::Copy;
         for (size_t i = 0; i < n_indices; ++i)
             wrap(v, *indices[i]);
     }
@@ -111,15 +114,14 @@ uint32_t jitc_var_loop_init(size_t n_indices, uint32_t **indices) {
     jitc_new_scope(backend);
 
     // Create a special node indicating the loop start
-    Ref result = steal(jitc_var_stmt(backend, VarType::Void, "", 1, 0, nullptr));
-    jitc_var(result)->size = size;
+    Ref result = steal(jitc_var_new_node_0(backend, VarKind::LoopStart,
+                                           VarType::Void, size, false));
 
     jitc_new_scope(backend);
 
     // Create Phi nodes (LLVM)
     if (backend == JitBackend::LLVM) {
-        v.stmt = (char *) "$r0 = phi <$w x $t0> [ $r0_final, %l_$i2_tail ], "
-                           "[ $r1, %l_$i2_start ]";
+        v.kind = (uint32_t) VarKind::LoopPhi;
         for (size_t i = 0; i < n_indices; ++i)
             wrap(v, *indices[i], result);
 
@@ -127,15 +129,15 @@ uint32_t jitc_var_loop_init(size_t n_indices, uint32_t **indices) {
     }
 
 
-    jitc_log(Debug, "jit_var_loop_init(r%u, n_indices=%zu, size=%u)",
-             (uint32_t) result, n_indices, size);
+    jitc_log(Debug, "jit_var_loop_init(r%u, n_indices=%zu, size=%zu)",
+             (uint32_t) result, n_indices, (size_t) size);
 
     return result.release();
 }
 
 uint32_t jitc_var_loop_cond(uint32_t loop_init, uint32_t cond,
                             size_t n_indices, uint32_t **indices) {
-    uint32_t size;
+    uint64_t size;
     JitBackend backend;
     {
         Variable *v = jitc_var(loop_init);
@@ -145,24 +147,26 @@ uint32_t jitc_var_loop_cond(uint32_t loop_init, uint32_t cond,
 
     jitc_new_scope(backend);
 
-    uint32_t dep[2] = { cond, loop_init };
-
-    Ref result =
-        steal(jitc_var_stmt(backend, VarType::Void, "", 1, 2, dep));
+    Ref result;
+    {
+        Variable *v_cond = jitc_var(cond), *v_init = jitc_var(loop_init);
+        result = steal(jitc_var_new_node_2(
+            backend, VarKind::LoopCond, VarType::Void,
+            std::max(v_cond->size, v_init->size),
+            v_cond->placeholder || v_init->placeholder, cond, v_cond,
+            loop_init, v_init));
+    }
 
     jitc_new_scope(backend);
 
+    /* Copy the loop state to represent it at the beginning of the loop body.
+       The loop start is retained as an ordering-only dependency. */
     Variable v;
-    v.kind = (uint32_t) VarKind::Stmt;
+    v.kind = (uint32_t) VarKind::Copy;
     v.size = size;
     v.placeholder = 1;
     v.backend = (uint32_t) backend;
 
-    // Create Phi nodes to represent state at the beginning of the loop body
-    v.stmt = (char *) (backend == JitBackend::LLVM
-                 ? "$r0 = phi <$w x $t0> [ $r1, %l_$i2_cond ]"
-                 : "mov.$t0 $r0, $r1");
-
     for (size_t i = 0; i < n_indices; ++i)
         wrap(v, *indices[i], loop_init);
 
@@ -210,7 +214,8 @@ uint32_t jitc_var_loop(const char *name, uint32_t loop_init,
     // =====================================================
 
     bool placeholder = false;
-    uint32_t size = 1, n_invariant = 0;
+    uint64_t size = 1;
+    uint32_t n_invariant = 0;
     {
         const Variable *v = jitc_var(loop->cond);
         if ((VarType) v->type != VarType::Bool)
@@ -264,15 +269,15 @@ uint32_t jitc_var_loop(const char *name, uint32_t loop_init,
 
         if (size != v1->size && size != 1 && v1->size != 1)
             jitc_raise("jit_var_loop(): initial shape of loop state variable %zu (r%u) "
-                       "is incompatible with the loop (%u vs %u entries)!",
-                       i, index_1, size, v1->size);
+                       "is incompatible with the loop (%zu vs %zu entries)!",
+                       i, index_1, (size_t) size, (size_t) v1->size);
 
         size = std::max(size, v1->size);
 
         if (size != vo->size && size != 1 && vo->size != 1)
             jitc_raise("jit_var_loop(): final shape of loop state variable %zu (r%u) "
-                       "is incompatible with the loop (%u vs %u entries)!",
-                       i, index_o, size, vo->size);
+                       "is incompatible with the loop (%zu vs %zu entries)!",
+                       i, index_o, (size_t) size, (size_t) vo->size);
         size = std::max(size, vo->size);
 
         // =========== 1.3. Optimizations ============
@@ -284,11 +289,10 @@ uint32_t jitc_var_loop(const char *name, uint32_t loop_init,
 
             if (eq_value || unchanged) {
                 if (backend == JitBackend::LLVM) {
-                    // Rewrite the previously generated phi expression. Needed
-                    // in case the loop condition depends on a loop-invariant
-                    // variable (see loop test 09_optim_cond)
-                    v2->stmt = (char *) "$r0 = phi <$w x $t0> [ $r0, "
-                                         "%l_$i2_tail ], [ $r1, %l_$i2_start ]";
+                    // Turn the previously generated phi node into a loop
+                    // invariant. Needed in case the loop condition depends on
+                    // a loop-invariant variable (see loop test 09_optim_cond)
+                    v2->literal = 1;
                 }
                 jitc_var_inc_ref(index_3);
                 jitc_var_dec_ref(index_1);
@@ -310,9 +314,9 @@ uint32_t jitc_var_loop(const char *name, uint32_t loop_init,
 
     jitc_log(InfoSym,
              "jit_var_loop(loop_init=r%u, loop_cond=r%u): loop (\"%s\") with "
-             "%zu loop variable%s, %u side effect%s, %u elements%s%s",
+             "%zu loop variable%s, %u side effect%s, %zu elements%s%s",
              loop_init, loop_cond, name, n_indices, n_indices == 1 ? "" : "s",
-             loop->se_count, loop->se_count == 1 ? "" : "s", size, temp,
+             loop->se_count, loop->se_count == 1 ? "" : "s", (size_t) size, temp,
              placeholder ? " (part of a recorded computation)" : "");
 
     if (n_invariant && first_round) {
@@ -381,9 +385,15 @@ uint32_t jitc_var_loop(const char *name, uint32_t loop_init,
 
     jitc_new_scope(backend);
 
-    uint32_t loop_end_dep[2] = { loop_init, loop_cond };
-    Ref loop_end = steal(
-        jitc_var_stmt(backend, VarType::Void, "", 1, 2, loop_end_dep));
+    Ref loop_end;
+    {
+        Variable *v_init = jitc_var(loop_init), *v_cond = jitc_var(loop_cond);
+        loop_end = steal(jitc_var_new_node_2(
+            backend, VarKind::LoopEnd, VarType::Void,
+            std::max(v_init->size, v_cond->size),
+            v_init->placeholder || v_cond->placeholder, loop_init, v_init,
+            loop_cond, v_cond));
+    }
     loop->end = loop_end;
 
     jitc_new_scope(backend);
@@ -442,15 +452,13 @@ uint32_t jitc_var_loop(const char *name, uint32_t loop_init,
         }
         se.resize(checkpoint);
 
-        uint32_t loop_se_dep[1] = { loop_end };
-        loop_se = steal(
-            jitc_var_stmt(backend, VarType::Void, "", 1, 1, loop_se_dep));
+        loop_se = steal(jitc_var_new_node_1(backend, VarKind::Nop,
+                                            VarType::Void, size, placeholder,
+                                            loop_end, jitc_var(loop_end)));
 
         // Set a label and custom code generation hook
         Variable *v = jitc_var(loop_se);
         v->extra = 1;
-        v->size = size;
-        v->placeholder = placeholder;
         Extra &e = state.extra[loop_se];
         e.n_dep = loop->se_count;
         e.dep = dep;
@@ -466,11 +474,7 @@ uint32_t jitc_var_loop(const char *name, uint32_t loop_init,
 
     {
         Variable v2;
-        v2.kind = (uint32_t) VarKind::Stmt;
-        if (backend == JitBackend::CUDA)
-            v2.stmt = (char *) "mov.$t0 $r0, $r1";
-        else
-            v2.stmt = (char *) "$r0 = bitcast <$w x $t1> $r1 to <$w x $t0>";
+        v2.kind = (uint32_t) VarKind::Copy;
         v2.size = size;
         v2.placeholder = placeholder;
         v2.backend = (uint32_t) backend;
@@ -566,36 +570,63 @@ static void jitc_var_loop_callback(uint32_t index, int free, void *ptr) {
     loop->simplify = true;
 }
 
-static void jitc_var_loop_dfs(tsl::robin_set<uint32_t, UInt32Hasher> &set, uint32_t lowest_index, uint32_t index) {
-    if (!set.insert(index).second)
+/// Work stack and visit counter used by jitc_var_loop_dfs()
+static std::vector<uint32_t> loop_dfs_stack;
+static size_t loop_dfs_visited = 0;
+
+/// Mark 'index' with 'epoch', returns 'false' if this already happened before
+static bool jitc_var_loop_visit(uint32_t epoch, uint32_t index) {
+    uint32_t &mark = jitc_var(index)->cold().visit_epoch;
+    if (mark == epoch)
+        return false;
+    mark = epoch;
+    loop_dfs_visited++;
+    return true;
+}
+
+static bool jitc_var_loop_visited(uint32_t epoch, uint32_t index) {
+    return jitc_var(index)->cold().visit_epoch == epoch;
+}
+
+static void jitc_var_loop_dfs(uint32_t epoch, uint32_t lowest_index, uint32_t index) {
+    if (!index || !jitc_var_loop_visit(epoch, index))
         return;
-    // jitc_trace("jitc_var_dfs(r%u)", index);
 
-    const Variable *v = jitc_var(index);
-    for (uint32_t i = 0; i < 4; ++i) {
-        uint32_t index_2 = v->dep[i];
-        if (index_2 >= lowest_index)
-            jitc_var_loop_dfs(set, lowest_index, index_2);
-    }
+    loop_dfs_stack.push_back(index);
 
-    if (unlikely(v->extra)) {
-        auto it = state.extra.find(index);
-        if (unlikely(it == state.extra.end()))
-            jitc_fail("jit_var_loop_dfs(): could not find matching 'extra' record!");
+    while (!loop_dfs_stack.empty()) {
+        index = loop_dfs_stack.back();
+        loop_dfs_stack.pop_back();
+        // jitc_trace("jitc_var_dfs(r%u)", index);
 
-        const Extra &extra = it->second;
-        for (uint32_t i = 0; i < extra.n_dep; ++i) {
-            uint32_t index_2 = extra.dep[i];
-            if (index_2 >= lowest_index)
-                jitc_var_loop_dfs(set, lowest_index, index_2);
+        const Variable *v = jitc_var(index);
+        for (uint32_t i = 0; i < 4; ++i) {
+            uint32_t index_2 = v->dep[i];
+            if (index_2 >= lowest_index && index_2 &&
+                jitc_var_loop_visit(epoch, index_2))
+                loop_dfs_stack.push_back(index_2);
+        }
+
+        if (unlikely(v->extra)) {
+            auto it = state.extra.find(index);
+            if (unlikely(it == state.extra.end()))
+                jitc_fail("jit_var_loop_dfs(): could not find matching 'extra' record!");
+
+            const Extra &extra = it->second;
+            for (uint32_t i = 0; i < extra.n_dep; ++i) {
+                uint32_t index_2 = extra.dep[i];
+                if (index_2 >= lowest_index && index_2 &&
+                    jitc_var_loop_visit(epoch, index_2))
+                    loop_dfs_stack.push_back(index_2);
+            }
         }
     }
 }
 
-static size_t jitc_var_loop_simplify(Loop *loop, tsl::robin_set<uint32_t, UInt32Hasher> &visited) {
+static size_t jitc_var_loop_simplify(Loop *loop) {
     loop->simplify = false;
 
-    if (state.variables.find(loop->end) == state.variables.end())
+    if (!state.variables.find(loop->end))
         return 0;
 
     const uint32_t n = (uint32_t) loop->in.size();
@@ -614,22 +645,22 @@ static size_t jitc_var_loop_simplify(Loop *loop, tsl::robin_set<uint32_t, UInt32
             highest_index = std::max(highest_index, index);
     }
 
-    visited.clear();
-    if (highest_index > lowest_index)
-        visited.reserve(highest_index - lowest_index);
+    uint32_t epoch = jitc_var_epoch_new();
+    loop_dfs_visited = 0;
 
     // Find all inputs that are reachable from the outputs that are still alive
     for (uint32_t i = 0; i < n; ++i) {
         if (!loop->out[i] || !loop->out_body[i])
             continue;
         // jitc_trace("jit_var_loop_simplify(): DFS from %u (r%u)", i, loop->out_body[i]);
-        visited.insert(loop->in_cond[i]);
-        jitc_var_loop_dfs(visited, lowest_index, loop->out_body[i]);
+        if (loop->in_cond[i])
+            jitc_var_loop_visit(epoch, loop->in_cond[i]);
+        jitc_var_loop_dfs(epoch, lowest_index, loop->out_body[i]);
     }
 
     // Also search from loop condition
     // jitc_trace("jit_var_loop_simplify(): DFS from loop condition (r%u)", loop->cond);
-    jitc_var_loop_dfs(visited, lowest_index, loop->cond);
+    jitc_var_loop_dfs(epoch, lowest_index, loop->cond);
 
     // Find all inputs that are reachable from the side effects
     if (loop->se) {
@@ -638,7 +669,7 @@ static size_t jitc_var_loop_simplify(Loop *loop, tsl::robin_set<uint32_t, UInt32
             const Extra &e = it->second;
             for (uint32_t i = 0; i < e.n_dep; ++i) {
                 // jitc_trace("jit_var_loop_simplify(): DFS from side effect %u (r%u)", i, e.dep[i]);
-                jitc_var_loop_dfs(visited, lowest_index, e.dep[i]);
+                jitc_var_loop_dfs(epoch, lowest_index, e.dep[i]);
             }
         }
     }
@@ -649,9 +680,9 @@ static size_t jitc_var_loop_simplify(Loop *loop, tsl::robin_set<uint32_t, UInt32
         again = false;
         for (uint32_t i = 0; i < n; ++i) {
             if (loop->in_cond[i] &&
-                visited.find(loop->in_cond[i]) != visited.end() &&
-                visited.find(loop->out_body[i]) == visited.end()) {
-                jitc_var_loop_dfs(visited, lowest_index, loop->out_body[i]);
+                jitc_var_loop_visited(epoch, loop->in_cond[i]) &&
+                !jitc_var_loop_visited(epoch, loop->out_body[i])) {
+                jitc_var_loop_dfs(epoch, lowest_index, loop->out_body[i]);
                 again = true;
             }
         }
@@ -660,7 +691,7 @@ static size_t jitc_var_loop_simplify(Loop *loop, tsl::robin_set<uint32_t, UInt32
     /// Remove loop variables that are never referenced
     for (uint32_t i = 0; i < n; ++i) {
         uint32_t index = loop->in_cond[i];
-        if (index == 0 || visited.find(index) != visited.end())
+        if (index == 0 || jitc_var_loop_visited(epoch, index))
             continue;
         n_freed++;
 
@@ -684,7 +715,7 @@ static size_t jitc_var_loop_simplify(Loop *loop, tsl::robin_set<uint32_t, UInt32
     jitc_log(InfoSym,
              "jit_var_loop_simplify(\"%s\"): freed %u loop variables, visited "
              "%zu variables.",
-             loop->name, n_freed, visited.size());
+             loop->name, n_freed, loop_dfs_visited);
 
     return n_freed;
 }
@@ -692,8 +723,6 @@ static size_t jitc_var_loop_simplify(Loop *loop, tsl::robin_set<uint32_t, UInt32
 static ProfilerRegion profiler_region_var_loop_simplify("jit_var_loop_simplify");
 
 void jitc_var_loop_simplify() {
-    tsl::robin_set<uint32_t, UInt32Hasher> visited;
-
     ProfilerPhase profiler(profiler_region_var_loop_simplify);
     bool progress;
     do {
@@ -701,14 +730,14 @@ void jitc_var_loop_simplify() {
         for (size_t i = 0; i < loops.size(); ++i) {
             Loop *loop = loops[i];
             if (loop->simplify)
-                progress |= jitc_var_loop_simplify(loop, visited) > 0;
+                progress |= jitc_var_loop_simplify(loop) > 0;
         }
     } while (progress);
 }
 
 static void jitc_var_loop_assemble_init(const Variable *, const Extra &extra) {
     Loop *loop = (Loop *) extra.callback_data;
-    uint32_t loop_reg = jitc_var(loop->init)->reg_index;
+    uint32_t loop_reg = jitc_var(loop->init)->cold().reg_index;
 
     if (loop->backend == JitBackend::LLVM) {
         buffer.fmt("    br label %%l_%u_start\n", loop_reg);
@@ -723,8 +752,8 @@ static void jitc_var_loop_assemble_init(const Variable *, const Extra &extra) {
 
 static void jitc_var_loop_assemble_cond(const Variable *, const Extra &extra) {
     Loop *loop = (Loop *) extra.callback_data;
-    uint32_t loop_reg = jitc_var(loop->init)->reg_index,
-             mask_reg = jitc_var(loop->cond)->reg_index,
+    uint32_t loop_reg = jitc_var(loop->init)->cold().reg_index,
+             mask_reg = jitc_var(loop->cond)->cold().reg_index,
              width = jitc_llvm_vector_width;
 
     if (loop->backend == JitBackend::CUDA) {
@@ -747,8 +776,8 @@ static void jitc_var_loop_assemble_cond(const Variable *, const Extra &extra) {
 
 static void jitc_var_loop_assemble_end(const Variable *, const Extra &extra) {
     Loop *loop = (Loop *) extra.callback_data;
-    uint32_t loop_reg = jitc_var(loop->init)->reg_index,
-             mask_reg = jitc_var(loop->cond)->reg_index;
+    uint32_t loop_reg = jitc_var(loop->init)->cold().reg_index,
+             mask_reg = jitc_var(loop->cond)->cold().reg_index;
 
     if (loop->backend == JitBackend::LLVM)
         buffer.fmt("    br label %%l_%u_tail\n"
@@ -759,29 +788,27 @@ static void jitc_var_loop_assemble_end(const Variable *, const Extra &extra) {
 
     uint32_t width = jitc_llvm_vector_width;
     for (size_t i = 0; i < loop->in_body.size(); ++i) {
-        auto it_in = state.variables.find(loop->in_cond[i]),
-             it_out = state.variables.find(loop->out_body[i]);
+        const Variable *v_in = state.variables.find(loop->in_cond[i]),
+                       *v_out = state.variables.find(loop->out_body[i]);
 
-        if (it_in == state.variables.end())
+        if (!v_in)
             continue;
-        else if (it_out == state.variables.end())
+        else if (!v_out)
             jitc_fail("jit_var_loop_assemble_end(): internal error!");
 
-        const Variable *v_in = &it_in->second,
-                       *v_out = &it_out->second;
-        uint32_t vti = it_in->second.type;
+        uint32_t vti = v_in->type;
 
         if (loop->backend == JitBackend::LLVM) {
             buffer.fmt("    %s%u_final = select <%u x i1> %%p%u, <%u x %s> %s%u, "
                        "<%u x %s> %s%u\n",
-                       type_prefix[vti], v_in->reg_index, width, mask_reg, width,
-                       type_name_llvm[vti], type_prefix[vti], v_out->reg_index,
+                       type_prefix[vti], v_in->cold().reg_index, width, mask_reg, width,
+                       type_name_llvm[vti], type_prefix[vti], v_out->cold().reg_index,
                        width, type_name_llvm[vti], type_prefix[vti],
-                       v_in->reg_index);
+                       v_in->cold().reg_index);
         } else {
             buffer.fmt("    mov.%s %s%u, %s%u;\n", type_name_ptx[vti],
-                       type_prefix[vti], v_in->reg_index, type_prefix[vti],
-                       v_out->reg_index);
+                       type_prefix[vti], v_in->cold().reg_index, type_prefix[vti],
+                       v_out->cold().reg_index);
         }
 
         n_variables++;
@@ -11,6 +11,7 @@
 #include "log.h"
 #include "util.h"
 #include "profiler.h"
+#include "numa.h"
 
 #if !defined(_WIN32)
 #  include <sys/mman.h>
@@ -105,10 +106,26 @@ static void aligned_free(void *ptr, size_t size) {
 #endif
 }
 
-void* jitc_malloc(AllocType type, size_t size) {
+/// Is an allocation of the given type and (rounded) size an anonymous mapping?
+static bool jitc_malloc_is_mapping(AllocType type, size_t size) {
+#if !defined(_WIN32)
+    return (type == AllocType::Host || type == AllocType::HostAsync) &&
+           size >= DRJIT_HUGEPAGE_SIZE;
+#else
+    (void) type; (void) size;
+    return false;
+#endif
+}
+
+void* jitc_malloc(AllocType type, size_t size, bool *zero) {
+    if (zero)
+        *zero = false;
+
     if (size == 0)
         return nullptr;
 
+    size_t size_req = size;
+
     if ((type != AllocType::Host && type != AllocType::HostAsync) ||
         jitc_llvm_vector_width < 16) {
         // Round up to the next multiple of 64 bytes
@@ -182,6 +199,14 @@ void* jitc_malloc(AllocType type, size_t size) {
         }
         descr = "new allocation";
 
+        // Establish the NUMA page placement policy before the first touch
+        if (ptr && type == AllocType::HostAsync)
+            jitc_numa_place(ptr, size_req, size);
+
+        // Fresh anonymous mappings are backed by the zero page
+        if (zero)
+            *zero = jitc_malloc_is_mapping(type, size);
+
         size_t &allocated = state.alloc_allocated[(int) type],
                &watermark = state.alloc_watermark[(int) type];
 
@@ -207,6 +232,28 @@ void* jitc_malloc(AllocType type, size_t size) {
     return ptr;
 }
 
+size_t jitc_malloc_discardable(void *ptr) {
+    auto it = state.alloc_used.find((uintptr_t) ptr);
+    if (unlikely(it == state.alloc_used.end()))
+        jitc_raise("jit_malloc_discardable(): unknown address " DRJIT_PTR "!",
+                   (uintptr_t) ptr);
+    auto [size, type, device] = alloc_info_decode(it->second);
+    (void) device;
+
+    return jitc_malloc_is_mapping(type, size) ? size : 0;
+}
+
+void jitc_malloc_discard(void *ptr, size_t size) {
+#if !defined(_WIN32)
+    /* MADV_DONTNEED drops the pages of a private anonymous mapping. Later
+       reads observe the zero page, and writes fault in fresh zeroed pages. */
+    if (madvise(ptr, size, MADV_DONTNEED) != 0)
+        memset(ptr, 0, size);
+#else
+    memset(ptr, 0, size);
+#endif
+}
+
 void jitc_free(void *ptr) {
     if (!ptr)
         return;
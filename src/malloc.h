@@ -37,8 +37,29 @@ extern uint32_t round_pow2(uint32_t x);
 extern const char *alloc_type_name[(int) AllocType::Count];
 extern const char *alloc_type_name_short[(int) AllocType::Count];
 
-/// Allocate the given flavor of memory
-extern void *jitc_malloc(AllocType type, size_t size) JIT_MALLOC;
+/**
+ * \brief Allocate the given flavor of memory
+ *
+ * When \c zero is specified, it is set to \c true if the returned region is
+ * known to be zero-initialized (e.g. a fresh anonymous mapping).
+ */
+extern void *jitc_malloc(AllocType type, size_t size,
+                         bool *zero = nullptr) JIT_MALLOC;
+
+/**
+ * \brief Return the capacity of a host allocation whose pages can be
+ * released via \ref jitc_malloc_discard(), and zero otherwise
+ */
+extern size_t jitc_malloc_discardable(void *ptr);
+
+/**
+ * \brief Release the physical pages backing a large host allocation
+ *
+ * The region remains valid and reads as zero afterwards. Pages are lazily
+ * faulted in upon the next write. This function does not access any shared
+ * state and may be called from a worker thread.
+ */
+extern void jitc_malloc_discard(void *ptr, size_t size);
 
 /// Release the given pointer
 extern void jitc_free(void *ptr);
@@ -0,0 +1,213 @@
+/*
+    src/numa.cpp -- NUMA-aware page placement and block scheduling for the
+    LLVM backend
+
+    Copyright (c) 2021 Wenzel Jakob <wenzel.jakob@epfl.ch>
+
+    All rights reserved. Use of this source code is governed by a BSD-style
+    license that can be found in the LICENSE file.
+*/
+
+#include "numa.h"
+#include "internal.h"
+#include "log.h"
+
+#if defined(__linux__)
+#  include <sched.h>
+#  include <unistd.h>
+#  include <sys/syscall.h>
+#endif
+
+/* Placement uses the raw mbind() system call so that Dr.Jit does not acquire
+   a dependency on libnuma. The relevant constants from <numaif.h> follow. */
+#define DRJIT_MPOL_DEFAULT    0
+#define DRJIT_MPOL_BIND       2
+#define DRJIT_MPOL_INTERLEAVE 3
+
+/// Placement granularity (matches the huge page size used by malloc.cpp)
+#define DRJIT_NUMA_PAGE_SIZE (2 * 1024 * 1024)
+
+/// Nodes beyond this limit are ignored
+#define DRJIT_NUMA_MAX_NODES 64
+
+NUMAMode jitc_numa_mode = NUMAMode::Disabled;
+
+#if defined(__linux__)
+static bool jitc_numa_init_done = false;
+static std::vector<cpu_set_t> jitc_numa_cpus;
+
+/// Parse a CPU list such as "0-15,32-47" into a cpu_set_t
+static bool jitc_numa_parse_cpulist(const char *fname, cpu_set_t &set) {
+    FILE *f = fopen(fname, "r");
+    if (!f)
+        return false;
+
+    char buf[4096];
+    bool success = fgets(buf, sizeof(buf), f) != nullptr;
+    fclose(f);
+    if (!success)
+        return false;
+
+    CPU_ZERO(&set);
+    const char *p = buf;
+    while (*p && *p != '\n') {
+        char *end;
+        unsigned long first = strtoul(p, &end, 10), last = first;
+        if (end == p)
+            return false;
+        p = end;
+        if (*p == '-') {
+            last = strtoul(p + 1, &end, 10);
+            p = end;
+        }
+        for (unsigned long i = first; i <= last && i < CPU_SETSIZE; ++i)
+            CPU_SET(i, &set);
+        if (*p == ',')
+            ++p;
+    }
+
+    return CPU_COUNT(&set) > 0;
+}
+
+static void jitc_numa_init() {
+    if (jitc_numa_init_done)
+        return;
+    jitc_numa_init_done = true;
+
+    for (uint32_t i = 0; i < DRJIT_NUMA_MAX_NODES; ++i) {
+        char fname[128];
+        snprintf(fname, sizeof(fname),
+                 "/sys/devices/system/node/node%u/cpulist", i);
+        cpu_set_t set;
+        if (!jitc_numa_parse_cpulist(fname, set))
+            break;
+        jitc_numa_cpus.push_back(set);
+    }
+
+    jitc_log(Debug, "jit_numa_init(): detected %zu NUMA node%s.",
+             jitc_numa_cpus.size(), jitc_numa_cpus.size() == 1 ? "" : "s");
+}
+
+static void jitc_numa_mbind(void *ptr, size_t size, int mode,
+                            unsigned long nodemask) {
+    long rv = syscall(SYS_mbind, ptr, size, mode,
+                      mode == DRJIT_MPOL_DEFAULT ? nullptr : &nodemask,
+                      mode == DRJIT_MPOL_DEFAULT ? 0 : DRJIT_NUMA_MAX_NODES + 1,
+                      0);
+    if (rv != 0)
+        jitc_log(Debug, "jit_numa_place(): mbind() failed: %s.",
+                 strerror(errno));
+}
+#endif
+
+uint32_t jitc_numa_node_count() {
+#if defined(__linux__)
+    jitc_numa_init();
+    return std::max((uint32_t) jitc_numa_cpus.size(), 1u);
+#else
+    return 1;
+#endif
+}
+
+void jitc_numa_set_mode(NUMAMode mode) {
+    if (mode == jitc_numa_mode)
+        return;
+
+    if (mode != NUMAMode::Disabled && jitc_numa_node_count() < 2) {
+        jitc_log(Warn, "jit_llvm_set_numa_mode(): this machine has only a "
+                       "single NUMA node, ignoring request.");
+        return;
+    }
+
+    jitc_numa_mode = mode;
+
+    // Cached allocations were placed using the previous policy
+    jitc_flush_malloc_cache(false);
+}
+
+void jitc_numa_place(void *ptr, size_t size, size_t capacity) {
+#if defined(__linux__)
+    uint32_t nodes = jitc_numa_node_count();
+    if (jitc_numa_mode == NUMAMode::Disabled || nodes < 2 ||
+        size < 2 * DRJIT_NUMA_PAGE_SIZE)
+        return;
+
+    if (jitc_numa_mode == NUMAMode::Interleave) {
+        jitc_numa_mbind(ptr, capacity, DRJIT_MPOL_INTERLEAVE,
+                        nodes == 64 ? ~0ul : ((1ul << nodes) - 1));
+        return;
+    }
+
+    /* Partition mode: node 'i' owns the i-th contiguous fraction of the
+       requested range. This matches the block ranges that the static
+       scheduler hands to the workers of node 'i'. The slack at the end of the
+       (power-of-two sized) mapping is assigned to the last node. */
+    size_t offset = 0;
+    for (uint32_t i = 0; i < nodes; ++i) {
+        size_t end = (i + 1 == nodes) ? capacity : (size / nodes) * (i + 1);
+        end = (end + DRJIT_NUMA_PAGE_SIZE / 2) / DRJIT_NUMA_PAGE_SIZE * DRJIT_NUMA_PAGE_SIZE;
+        end = std::min(end, capacity);
+        if (end > offset)
+            jitc_numa_mbind((uint8_t *) ptr + offset, end - offset,
+                            DRJIT_MPOL_BIND, 1ul << i);
+        offset = std::max(offset, end);
+    }
+#else
+    (void) ptr; (void) size; (void) capacity;
+#endif
+}
+
+#if defined(__linux__)
+/// NUMA node of the calling pool thread, -1: not assigned yet
+static thread_local int jitc_numa_thread_node = -1;
+#endif
+
+uint32_t jitc_numa_pin_worker(uint32_t nodes) {
+    uint32_t id = pool_thread_id();
+
+    // Threads outside of the pool (e.g. the caller of task_wait()) stay as-is
+    if (id == 0 || nodes == 0)
+        return (uint32_t) -1;
+
+#if defined(__linux__)
+    if (jitc_numa_thread_node >= 0)
+        return (uint32_t) jitc_numa_thread_node;
+
+    // Spread the pool threads evenly across the nodes
+    uint32_t node = (id - 1) % nodes;
+    jitc_numa_thread_node = (int) node;
+
+    cpu_set_t cur, set;
+    if (sched_getaffinity(0, sizeof(cpu_set_t), &cur) != 0)
+        return node;
+
+    CPU_AND(&set, &cur, &jitc_numa_cpus[node]);
+    if (CPU_COUNT(&set) == 0)
+        return node;
+
+    // pid == 0 refers to the calling thread
+    if (sched_setaffinity(0, sizeof(cpu_set_t), &set) != 0)
+        jitc_log(Debug, "jit_numa_pin_worker(): sched_setaffinity() failed: %s.",
+                 strerror(errno));
+
+    return node;
+#else
+    return (id - 1) % nodes;
+#endif
+}
+
+bool jitc_numa_schedule(uint32_t blocks, NUMASchedule &sched) {
+    if (jitc_numa_mode != NUMAMode::Partition)
+        return false;
+
+    uint32_t nodes = jitc_numa_node_count();
+
+    // Not worth it for small launches, let the pool balance the load
+    if (nodes < 2 || blocks < 2 * nodes)
+        return false;
+
+    sched.nodes = nodes;
+    sched.workers = std::max(std::min(pool_size(nullptr), blocks), nodes);
+    sched.blocks = blocks;
+    return true;
+}
@@ -0,0 +1,78 @@
+/*
+    src/numa.h -- NUMA-aware page placement and block scheduling for the
+    LLVM backend
+
+    Copyright (c) 2021 Wenzel Jakob <wenzel.jakob@epfl.ch>
+
+    All rights reserved. Use of this source code is governed by a BSD-style
+    license that can be found in the LICENSE file.
+*/
+
+#pragma once
+
+#include <drjit-core/jit.h>
+
+/// Currently active NUMA mode (see \ref jit_llvm_set_numa_mode())
+extern NUMAMode jitc_numa_mode;
+
+/// Number of NUMA nodes detected on this machine (1 if detection failed)
+extern uint32_t jitc_numa_node_count();
+
+/// Change the NUMA mode (flushes the allocation cache when the mode changes)
+extern void jitc_numa_set_mode(NUMAMode mode);
+
+/**
+ * \brief Apply the page placement policy of the current NUMA mode to a fresh
+ * host-asynchronous allocation.
+ *
+ * Must be called before the memory is touched for the first time. \c size
+ * specifies the number of bytes requested by the caller, and \c capacity the
+ * (larger) size of the underlying mapping. Does nothing in
+ * <tt>NUMAMode::Disabled</tt> or when the allocation is too small to span
+ * multiple huge pages.
+ */
+extern void jitc_numa_place(void *ptr, size_t size, size_t capacity);
+
+/**
+ * \brief Pin the calling pool thread to the CPUs of a NUMA node.
+ *
+ * Pool threads are assigned to one of the \c nodes nodes in a round-robin
+ * fashion. The thread is pinned the first time that this function is called,
+ * and the pinning is kept afterwards so that subsequent calls are free. CPUs
+ * excluded by the process-wide affinity mask (e.g. via \c taskset) remain
+ * excluded. Returns the node of the calling thread, or <tt>(uint32_t) -1</tt>
+ * for threads that are not part of the pool (these are never pinned).
+ */
+extern uint32_t jitc_numa_pin_worker(uint32_t nodes);
+
+/// Per-launch work decomposition used by the static NUMA block scheduler
+struct NUMASchedule {
+    /// Number of NUMA nodes that participate
+    uint32_t nodes;
+
+    /// Number of work items (at least one per node)
+    uint32_t workers;
+
+    /// Total number of blocks
+    uint32_t blocks;
+
+    /**
+     * \brief Determine the range of blocks owned by node \c node
+     *
+     * Blocks are split into \c nodes contiguous ranges whose boundaries match
+     * the page partition established by \ref jitc_numa_place(). Work items
+     * claim blocks from the range of the node that their thread is pinned to,
+     * and then help with the ranges of the remaining nodes.
+     */
+    void node_range(uint32_t node, uint32_t &block_start,
+                    uint32_t &block_end) const {
+        block_start = (uint32_t) (((uint64_t) node * blocks) / nodes);
+        block_end   = (uint32_t) (((uint64_t) (node + 1) * blocks) / nodes);
+    }
+};
+
+/**
+ * \brief Check whether a kernel launch with \c blocks blocks should use the
+ * static NUMA scheduler and, if so, fill out \c sched accordingly.
+ */
+extern bool jitc_numa_schedule(uint32_t blocks, NUMASchedule &sched);
@@ -27,7 +27,7 @@ struct VarInfo {
     VarType type;
 
     /// Output size given the size of the operands
-    uint32_t size;
+    uint64_t size;
 
     /// Should Dr.Jit try to simplify the operation? (if some operands are literals)
     bool simplify;
@@ -72,7 +72,7 @@ auto jitc_var_check_impl(const char *name, std::index_sequence<Is...>, Args... a
 
     JitBackend backend = JitBackend::Invalid;
     VarType type = VarType::Void;
-    uint32_t size = 0;
+    uint64_t size = 0;
     const char *err = nullptr;
 
     for (uint32_t i = 0; i < Size; ++i) {
@@ -156,7 +156,7 @@ auto jitc_var_check_impl(const char *name, std::index_sequence<Is...>, Args... a
         for (uint32_t i = 0; i < Size; ++i) {
             if (unlikely(v[i]->size != size && v[i]->size != 1)) {
                 err = "operands have incompatible sizes";
-                size = (uint32_t) -1;
+                size = (uint64_t) -1;
                 goto fail;
             }
         }
@@ -177,10 +177,10 @@ fail:
         buffer.fmt("r%u%s", dep[i], i + 1 < Size ? ", " : "");
     buffer.fmt("): %s!", err);
 
-    if (size == (uint32_t) -1) {
+    if (size == (uint64_t) -1) {
         buffer.put(" (sizes: ");
         for (uint32_t i = 0; i < Size; ++i)
-            buffer.fmt("%u%s", dep[i] ? jitc_var(dep[i])->size : 0,
+            buffer.fmt("%zu%s", dep[i] ? (size_t) jitc_var(dep[i])->size : 0,
                        i + 1 < Size ? ", " : "");
         buffer.put(")");
     }
@@ -289,6 +289,216 @@ uint32_t jitc_var_shift(const VarInfo &info, uint32_t index, uint64_t amount) {
                : jitc_var_shr(index, shift);
 }
 
+// --------------------------------------------------------------------------
+// Rule-based rewrites (JitFlag::Simplify)
+// --------------------------------------------------------------------------
+
+size_t jitc_rewrite_count(JitRewrite rule) {
+    if ((uint32_t) rule >= (uint32_t) JitRewrite::Count)
+        jitc_raise("jit_rewrite_count(): invalid rule!");
+    return state.rewrite_count[(int) rule];
+}
+
+void jitc_rewrite_clear_statistics() {
+    for (std::atomic<size_t> &count : state.rewrite_count)
+        count = 0;
+}
+
+/// Should operations try the rewrite rules below?
+static bool jitc_rewrite_enabled() {
+    return jitc_flags() & (uint32_t) JitFlag::Simplify;
+}
+
+/// Count an application of a rewrite rule
+static void jitc_rewrite_applied(JitRewrite rule) {
+    state.rewrite_count[(int) rule].fetch_add(1, std::memory_order_relaxed);
+}
+
+static uint32_t jitc_make_literal(const VarInfo &info, uint64_t value) {
+    return jitc_var_literal(info.backend, info.type, &value, info.size, 0);
+}
+
+/// Compute floor((hi * 2^64 + lo) / d), where hi < d (bit-by-bit long division)
+static uint64_t jitc_div_wide(uint64_t hi, uint64_t lo, uint64_t d) {
+    uint64_t q = 0, r = hi;
+    for (int i = 63; i >= 0; --i) {
+        bool carry = (r >> 63) != 0;
+        r = (r << 1) | ((lo >> i) & 1);
+        q <<= 1;
+        if (carry || r >= d) {
+            r -= d;
+            q |= 1;
+        }
+    }
+    return q;
+}
+
+/**
+ * \brief Unsigned division by an invariant integer 'd' (2 <= d, not a power
+ * of two) using a multiply-high "magic number" (Granlund & Montgomery,
+ * round-up variant with an add-indicator so that every 'd' is supported):
+ *
+ *     t = mulhi(x, m),  q = (t + ((x - t) >> 1)) >> (l - 1)
+ */
+static uint32_t jitc_var_udiv_const(const VarInfo &info, uint32_t a0,
+                                    uint64_t d) {
+    uint32_t bits = type_size[(int) info.type] * 8,
+             l = (uint32_t) (64 - jitc_clz(d - 1)); // ceil(log2(d))
+
+    // m = floor(2^bits * (2^l - d) / d) + 1
+    uint64_t m, r = (l == 64 ? 0 : ((uint64_t) 1 << l)) - d;
+    if (bits == 32)
+        m = (r << 32) / d + 1;
+    else
+        m = jitc_div_wide(r, 0, d) + 1;
+
+    Ref m_v     = steal(jitc_make_literal(info, m)),
+        one_v   = steal(jitc_make_literal(info, 1)),
+        shift_v = steal(jitc_make_literal(info, l - 1)),
+        t       = steal(jitc_var_mulhi(a0, m_v)),
+        u       = steal(jitc_var_sub(a0, t)),
+        u2      = steal(jitc_var_shr(u, one_v)),
+        s       = steal(jitc_var_add(t, u2));
+
+    return jitc_var_shr(s, shift_v);
+}
+
+/**
+ * \brief Signed division by an invariant integer 'd' (|d| >= 2) using the
+ * magic number construction from "Hacker's Delight" (Figure 10-1), where all
+ * arithmetic is performed on 'bits'-wide unsigned integers.
+ */
+template <typename UInt>
+static uint32_t jitc_var_sdiv_const(const VarInfo &info, uint32_t a0, UInt d) {
+    constexpr uint32_t bits = sizeof(UInt) * 8;
+    const UInt two = (UInt) 1 << (bits - 1);
+    bool d_neg = (d >> (bits - 1)) != 0;
+
+    UInt ad  = d_neg ? (UInt) (0 - d) : d,
+         t   = two + (d >> (bits - 1)),
+         anc = t - 1 - t % ad,
+         q1  = two / anc, r1 = two - q1 * anc,
+         q2  = two / ad,  r2 = two - q2 * ad,
+         delta;
+    uint32_t p = bits - 1;
+
+    do {
+        p++;
+        q1 = 2 * q1; r1 = 2 * r1;
+        if (r1 >= anc) { q1++; r1 -= anc; }
+        q2 = 2 * q2; r2 = 2 * r2;
+        if (r2 >= ad) { q2++; r2 -= ad; }
+        delta = ad - r2;
+    } while (q1 < delta || (q1 == delta && r1 == 0));
+
+    UInt m = q2 + 1;
+    if (d_neg)
+        m = 0 - m;
+    bool m_neg = (m >> (bits - 1)) != 0;
+    uint32_t shift = p - bits;
+
+    Ref m_v = steal(jitc_make_literal(info, (uint64_t) m)),
+        q   = steal(jitc_var_mulhi(a0, m_v));
+
+    if (!d_neg && m_neg)
+        q = steal(jitc_var_add(q, a0));
+    else if (d_neg && !m_neg)
+        q = steal(jitc_var_sub(q, a0));
+
+    if (shift) {
+        Ref shift_v = steal(jitc_make_literal(info, shift));
+        q = steal(jitc_var_shr(q, shift_v));
+    }
+
+    // Add one to negative quotients (arithmetic shift yields 0 or -1)
+    Ref sign_v = steal(jitc_make_literal(info, bits - 1)),
+        sign   = steal(jitc_var_shr(q, sign_v));
+
+    return jitc_var_sub(q, sign);
+}
+
+/// Integer division by a literal, returns 0 if no rewrite applies
+static uint32_t jitc_var_div_const(const VarInfo &info, uint32_t a0,
+                                   uint64_t d) {
+    uint32_t isize = type_size[(int) info.type];
+    if (!jitc_is_int(info.type) || (isize != 4 && isize != 8))
+        return 0;
+
+    uint32_t result = 0;
+    if (jitc_is_uint(info.type)) {
+        if (d > 1 && !jitc_is_pow2(d))
+            result = jitc_var_udiv_const(info, a0, d);
+    } else if (isize == 4) {
+        int32_t ds = (int32_t) (uint32_t) d;
+        if (ds == -1)
+            result = jitc_var_neg(a0);
+        else if (ds != 0 && ds != 1)
+            result = jitc_var_sdiv_const<uint32_t>(info, a0, (uint32_t) d);
+    } else {
+        int64_t ds = (int64_t) d;
+        if (ds == -1)
+            result = jitc_var_neg(a0);
+        else if (ds != 0 && ds != 1)
+            result = jitc_var_sdiv_const<uint64_t>(info, a0, d);
+    }
+
+    if (result)
+        jitc_rewrite_applied(JitRewrite::DivConst);
+
+    return result;
+}
+
+/// Comparison whose outcome is known (e.g. unsigned 'x < 0')
+static uint32_t jitc_make_compare_fold(const VarInfo &info, bool value) {
+    jitc_rewrite_applied(JitRewrite::CompareFold);
+    return jitc_var_literal(info.backend, VarType::Bool, &value, info.size, 0);
+}
+
+/**
+ * Compare a mask against a literal: 'm == true' and 'm != false' reduce to
+ * 'm', while 'm == false' and 'm != true' reduce to '!m'. Returns 0 if neither
+ * operand is a literal.
+ */
+static uint32_t jitc_var_mask_compare(const VarInfo &info,
+                                      uint32_t a0, const Variable *v0,
+                                      uint32_t a1, const Variable *v1,
+                                      bool eq) {
+    const Variable *lit = v0->is_literal() ? v0 : v1;
+    if (!lit->is_literal())
+        return 0;
+
+    uint32_t other = lit == v0 ? a1 : a0;
+    jitc_rewrite_applied(JitRewrite::CompareFold);
+
+    if ((lit->literal != 0) == eq)
+        return jitc_var_resize(other, info.size);
+
+    Ref tmp = steal(jitc_var_not(other));
+    return jitc_var_resize(tmp, info.size);
+}
+
+/// Negate a comparison of integers, returns 0 if no rewrite applies
+static uint32_t jitc_var_not_compare(const Variable *v) {
+    uint32_t d0 = v->dep[0], d1 = v->dep[1];
+    VarKind kind = (VarKind) v->kind;
+
+    if (kind != VarKind::Eq && kind != VarKind::Neq && kind != VarKind::Lt &&
+        kind != VarKind::Le)
+        return 0;
+
+    // Not valid for floating point operands (NaNs are unordered)
+    if (jitc_is_float(jitc_var(d0)))
+        return 0;
+
+    jitc_rewrite_applied(JitRewrite::CompareFold);
+    switch (kind) {
+        case VarKind::Eq:  return jitc_var_neq(d0, d1);
+        case VarKind::Neq: return jitc_var_eq(d0, d1);
+        case VarKind::Lt:  return jitc_var_le(d1, d0);
+        default:           return jitc_var_lt(d1, d0);
+    }
+}
+
 // --------------------------------------------------------------------------
 
 template <typename T, enable_if_t<!std::is_signed_v<T>> = 0>
@@ -303,8 +513,12 @@ uint32_t jitc_var_neg(uint32_t a0) {
     auto [info, v0] = jitc_var_check<IsArithmetic>("jit_var_neg", a0);
 
     uint32_t result = 0;
-    if (info.simplify && info.literal)
+    if (info.simplify && info.literal) {
         result = jitc_eval_literal(info, [](auto l0) { return eval_neg(l0); }, v0);
+    } else if (info.size && v0->kind == VarKind::Neg && jitc_rewrite_enabled()) {
+        jitc_rewrite_applied(JitRewrite::DoubleNeg);
+        result = jitc_var_resize(v0->dep[0], info.size);
+    }
 
     if (!result && info.size)
         result = jitc_var_new_node_1(info.backend, VarKind::Neg, info.type,
@@ -327,8 +541,16 @@ uint32_t jitc_var_not(uint32_t a0) {
     auto [info, v0] = jitc_var_check<IsIntOrBool>("jit_var_not", a0);
 
     uint32_t result = 0;
-    if (info.simplify && info.literal)
+    if (info.simplify && info.literal) {
         result = jitc_eval_literal(info, [](auto l0) { return eval_not(l0); }, v0);
+    } else if (info.size && jitc_rewrite_enabled()) {
+        if (v0->kind == VarKind::Not) {
+            jitc_rewrite_applied(JitRewrite::DoubleNeg);
+            result = jitc_var_resize(v0->dep[0], info.size);
+        } else {
+            result = jitc_var_not_compare(v0);
+        }
+    }
 
     if (!result && info.size)
         result = jitc_var_new_node_1(info.backend, VarKind::Not, info.type,
@@ -442,17 +664,24 @@ uint32_t jitc_var_mul(uint32_t a0, uint32_t a1) {
 
     uint32_t result = 0;
     if (info.simplify) {
-        if (info.literal)
+        if (info.literal) {
             result = jitc_eval_literal(
                 info, [](auto l0, auto l1) { return l0 * l1; }, v0, v1);
-        else if (jitc_is_one(v0) || (jitc_is_zero(v1) && jitc_is_int(v0)))
+        } else if (jitc_is_one(v0) || (jitc_is_zero(v1) && jitc_is_int(v0))) {
             result = jitc_var_resize(a1, info.size);
-        else if (jitc_is_one(v1) || (jitc_is_zero(v0) && jitc_is_int(v0)))
+        } else if (jitc_is_one(v1) || (jitc_is_zero(v0) && jitc_is_int(v0))) {
             result = jitc_var_resize(a0, info.size);
-        else if (jitc_is_uint(info.type) && v0->is_literal() && jitc_is_pow2(v0->literal))
+        } else if ((jitc_is_two(v0) || jitc_is_two(v1)) && jitc_rewrite_enabled()) {
+            // x * 2 -> x + x
+            uint32_t x = jitc_is_two(v0) ? a1 : a0;
+            jitc_rewrite_applied(JitRewrite::MulTwo);
+            Ref tmp = steal(jitc_var_add(x, x));
+            result = jitc_var_resize(tmp, info.size);
+        } else if (jitc_is_uint(info.type) && v0->is_literal() && jitc_is_pow2(v0->literal)) {
             result = jitc_var_shift<true>(info, a1, v0->literal);
-        else if (jitc_is_uint(info.type) && v1->is_literal() && jitc_is_pow2(v1->literal))
+        } else if (jitc_is_uint(info.type) && v1->is_literal() && jitc_is_pow2(v1->literal)) {
             result = jitc_var_shift<true>(info, a0, v1->literal);
+        }
     }
 
     if (!result && info.size)
@@ -488,10 +717,13 @@ uint32_t jitc_var_div(uint32_t a0, uint32_t a1) {
         } else if (a0 == a1 && !jitc_is_float(v0)) {
             uint64_t value = 1;
             result = jitc_var_literal(info.backend, info.type, &value, info.size, 0);
+        } else if (v1->is_literal() && jitc_rewrite_enabled()) {
+            Ref tmp = steal(jitc_var_div_const(info, a0, v1->literal));
+            if (tmp)
+                result = jitc_var_resize(tmp, info.size);
         }
     }
 
-
     if (!result && info.size)
         result = jitc_var_new_node_2(info.backend, VarKind::Div, info.type,
                                      info.size, info.placeholder, a0, v0, a1, v1);
@@ -512,9 +744,27 @@ uint32_t jitc_var_mod(uint32_t a0, uint32_t a1) {
     auto [info, v0, v1] = jitc_var_check<IsIntOrBool>("jit_var_mod", a0, a1);
 
     uint32_t result = 0;
-    if (info.simplify && info.literal)
+    if (info.simplify && info.literal) {
         result = jitc_eval_literal(
             info, [](auto l0, auto l1) { return eval_mod(l0, l1); }, v0, v1);
+    } else if (info.simplify && v1->is_literal() && jitc_rewrite_enabled()) {
+        uint64_t d = v1->literal;
+        Ref tmp;
+        if (jitc_is_uint(info.type) && jitc_is_pow2(d)) {
+            // x % 2^k -> x & (2^k - 1)
+            Ref mask = steal(jitc_make_literal(info, d - 1));
+            tmp = steal(jitc_var_and(a0, mask));
+        } else if (Ref q = steal(jitc_var_div_const(info, a0, d)); q) {
+            // x % d -> x - (x / d) * d
+            Ref qd = steal(jitc_var_mul(q, a1));
+            tmp = steal(jitc_var_sub(a0, qd));
+        }
+
+        if (tmp) {
+            jitc_rewrite_applied(JitRewrite::ModConst);
+            result = jitc_var_resize(tmp, info.size);
+        }
+    }
 
     if (!result && info.size)
         result = jitc_var_new_node_2(info.backend, VarKind::Mod, info.type,
@@ -768,6 +1018,8 @@ uint32_t jitc_var_eq(uint32_t a0, uint32_t a1) {
                 info, [](auto l0, auto l1) { return l0 == l1; }, v0, v1);
         else if (a0 == a1 && !jitc_is_float(v0))
             result = jitc_make_true(info);
+        else if (jitc_is_bool(v0) && jitc_rewrite_enabled())
+            result = jitc_var_mask_compare(info, a0, v0, a1, v1, true);
     }
 
     if (!result && info.size)
@@ -791,6 +1043,8 @@ uint32_t jitc_var_neq(uint32_t a0, uint32_t a1) {
                 info, [](auto l0, auto l1) { return l0 != l1; }, v0, v1);
         else if (a0 == a1)
             result = jitc_make_zero(info);
+        else if (jitc_is_bool(v0) && jitc_rewrite_enabled())
+            result = jitc_var_mask_compare(info, a0, v0, a1, v1, false);
     }
 
     if (!result && info.size)
@@ -814,6 +1068,8 @@ uint32_t jitc_var_lt(uint32_t a0, uint32_t a1) {
                 info, [](auto l0, auto l1) { return l0 < l1; }, v0, v1);
         else if (a0 == a1)
             result = jitc_make_zero(info);
+        else if (jitc_is_uint(v0) && jitc_is_zero(v1) && jitc_rewrite_enabled())
+            result = jitc_make_compare_fold(info, false); // x < 0
     }
 
     if (!result && info.size)
@@ -837,6 +1093,8 @@ uint32_t jitc_var_le(uint32_t a0, uint32_t a1) {
                 info, [](auto l0, auto l1) { return l0 <= l1; }, v0, v1);
         else if (a0 == a1 && !jitc_is_float(v0))
             result = jitc_make_true(info);
+        else if (jitc_is_uint(v0) && jitc_is_zero(v0) && jitc_rewrite_enabled())
+            result = jitc_make_compare_fold(info, true); // 0 <= x
     }
 
     if (!result && info.size)
@@ -860,6 +1118,8 @@ uint32_t jitc_var_gt(uint32_t a0, uint32_t a1) {
                 info, [](auto l0, auto l1) { return l0 > l1; }, v0, v1);
         else if (a0 == a1)
             result = jitc_make_zero(info);
+        else if (jitc_is_uint(v0) && jitc_is_zero(v0) && jitc_rewrite_enabled())
+            result = jitc_make_compare_fold(info, false); // 0 > x
     }
 
     if (!result && info.size)
@@ -883,6 +1143,8 @@ uint32_t jitc_var_ge(uint32_t a0, uint32_t a1) {
                 info, [](auto l0, auto l1) { return l0 >= l1; }, v0, v1);
         else if (a0 == a1 && !jitc_is_float(v0))
             result = jitc_make_true(info);
+        else if (jitc_is_uint(v0) && jitc_is_zero(v1) && jitc_rewrite_enabled())
+            result = jitc_make_compare_fold(info, true); // x >= 0
     }
 
     if (!result && info.size)
@@ -909,6 +1171,9 @@ uint32_t jitc_var_select(uint32_t a0, uint32_t a1, uint32_t a2) {
             return jitc_var_resize(a1, info.size);
         else if (jitc_is_zero(v0))
             return jitc_var_resize(a2, info.size);
+    } else if (a1 == a2 && info.size && jitc_rewrite_enabled()) {
+        jitc_rewrite_applied(JitRewrite::SelectSame);
+        return jitc_var_resize(a1, info.size);
     }
 
     if (!result && info.size)
@@ -1249,7 +1514,7 @@ template <typename T, enable_if_t<!std::is_floating_point_v<T>> = 0>
 T eval_sin(T) { jitc_fail("eval_sin(): unsupported operands!"); }
 
 uint32_t jitc_var_sin(uint32_t a0) {
-    auto [info, v0] = jitc_var_check<IsFloat | IsCUDA>("jit_var_sin", a0);
+    auto [info, v0] = jitc_var_check<IsFloat>("jit_var_sin", a0);
 
     uint32_t result = 0;
     if (info.simplify && info.literal)
@@ -1272,7 +1537,7 @@ template <typename T, enable_if_t<!std::is_floating_point_v<T>> = 0>
 T eval_cos(T) { jitc_fail("eval_cos(): unsupported operands!"); }
 
 uint32_t jitc_var_cos(uint32_t a0) {
-    auto [info, v0] = jitc_var_check<IsFloat | IsCUDA>("jit_var_cos", a0);
+    auto [info, v0] = jitc_var_check<IsFloat>("jit_var_cos", a0);
 
     uint32_t result = 0;
     if (info.simplify && info.literal)
@@ -1295,7 +1560,7 @@ template <typename T, enable_if_t<!std::is_floating_point_v<T>> = 0>
 T eval_exp2(T) { jitc_fail("eval_exp2(): unsupported operands!"); }
 
 uint32_t jitc_var_exp2(uint32_t a0) {
-    auto [info, v0] = jitc_var_check<IsFloat | IsCUDA>("jit_var_exp2", a0);
+    auto [info, v0] = jitc_var_check<IsFloat>("jit_var_exp2", a0);
 
     uint32_t result = 0;
     if (info.simplify && info.literal)
@@ -1318,7 +1583,7 @@ template <typename T, enable_if_t<!std::is_floating_point_v<T>> = 0>
 T eval_log2(T) { jitc_fail("eval_log2(): unsupported operands!"); }
 
 uint32_t jitc_var_log2(uint32_t a0) {
-    auto [info, v0] = jitc_var_check<IsFloat | IsCUDA>("jit_var_log2", a0);
+    auto [info, v0] = jitc_var_check<IsFloat>("jit_var_log2", a0);
 
     uint32_t result = 0;
     if (info.simplify && info.literal)
@@ -1334,6 +1599,50 @@ uint32_t jitc_var_log2(uint32_t a0) {
 
 // --------------------------------------------------------------------------
 
+/**
+ * Collapse a cast of a cast into a single operation when this does not change
+ * the result: chains of reinterpreting casts, integer conversions whose
+ * intermediate type is wide enough to hold every source value, and floating
+ * point conversions whose intermediate type is at least as precise as the
+ * source. Returns 0 if no rewrite applies.
+ */
+static uint32_t jitc_var_cast_chain(const Variable *v0, VarType target_type,
+                                    int reinterpret) {
+    VarKind kind = (VarKind) v0->kind;
+    if (kind != VarKind::Cast && kind != VarKind::Bitcast)
+        return 0;
+
+    uint32_t inner = v0->dep[0];
+    VarType t0 = (VarType) jitc_var(inner)->type,
+            t1 = (VarType) v0->type,
+            t2 = target_type;
+
+    if (jitc_is_bool(t0) || jitc_is_bool(t1) || jitc_is_bool(t2))
+        return 0;
+
+    uint32_t s0 = type_size[(int) t0],
+             s1 = type_size[(int) t1],
+             s2 = type_size[(int) t2];
+
+    bool valid;
+    if (kind == VarKind::Bitcast)
+        valid = reinterpret;
+    else if (jitc_is_int(t0) && jitc_is_int(t1) && jitc_is_int(t2))
+        // Widening: sign/zero extension composes unless a signed value
+        // passes through a wider unsigned type and is widened further
+        valid = s1 > s0 && (s2 <= s1 || !jitc_is_sint(t0) || jitc_is_sint(t1));
+    else if (jitc_is_float(t0) && jitc_is_float(t1) && jitc_is_float(t2))
+        valid = s1 > s0;
+    else
+        valid = false;
+
+    if (!valid)
+        return 0;
+
+    jitc_rewrite_applied(JitRewrite::CastChain);
+    return jitc_var_cast(inner, t2, kind == VarKind::Bitcast);
+}
+
 uint32_t jitc_var_cast(uint32_t a0, VarType target_type, int reinterpret) {
     if (a0 == 0)
         return 0;
@@ -1383,6 +1692,8 @@ uint32_t jitc_var_cast(uint32_t a0, VarType target_type, int reinterpret) {
                 }
             }, v0);
         }
+    } else if (info.size && jitc_rewrite_enabled()) {
+        result = jitc_var_cast_chain(v0, target_type, reinterpret);
     }
 
     if (!result && info.size)
@@ -1413,78 +1724,130 @@ static uint32_t jitc_scatter_gather_index(uint32_t source, uint32_t index) {
     return jitc_var_cast(index, target_type, 0);
 }
 
-/// Change all indices/counters in an expression tree to 'new_index'
-static uint32_t jitc_var_reindex(uint32_t var_index, uint32_t new_index,
-                                 uint32_t mask, uint32_t size) {
-    Variable *v = jitc_var(var_index);
+/// Stack frame of the (non-recursive) traversal in jitc_var_reindex()
+struct ReindexFrame {
+    uint32_t index;
+    /// Next dependency to be processed
+    uint32_t next;
+    bool rebuild;
+    Ref dep[4];
+};
+
+enum class ReindexStatus { Fail, Done, Pushed };
+
+/// Begin re-indexing 'index'. Either produces 'result' or pushes a new frame
+static ReindexStatus
+jitc_var_reindex_enter(std::vector<ReindexFrame> &stack,
+                       const tsl::robin_map<uint32_t, uint32_t, UInt32Hasher> &memo,
+                       uint32_t index, size_t size, Ref &result) {
+    // Shared subexpression that was already re-indexed?
+    auto it = memo.find(index);
+    if (it != memo.end()) {
+        result = borrow(it->second);
+        return ReindexStatus::Done;
+    }
+
+    const Variable *v = jitc_var(index);
 
     if (v->is_data() || (VarType) v->type == VarType::Void)
-        return 0; // evaluated variable, give up
+        return ReindexStatus::Fail; // evaluated variable, give up
 
     if (v->extra) {
-        Extra &e = state.extra[var_index];
+        Extra &e = state.extra[index];
         if (e.n_dep || e.callback || e.vcall_buckets || e.assemble)
-            return 0; // "complicated" variable, give up
+            return ReindexStatus::Fail; // "complicated" variable, give up
     }
 
-    Ref dep[4];
     bool rebuild = v->size != size && v->size != 1;
 
-    if (v->kind == VarKind::DefaultMask && rebuild)
+    if (v->kind == VarKind::DefaultMask && rebuild) {
         // Do not re-index the mask, only resize it
-        return jitc_var_mask_default((JitBackend) v->backend, size);
+        result = steal(jitc_var_mask_default((JitBackend) v->backend, size));
+        return ReindexStatus::Done;
+    }
+
+    stack.push_back(ReindexFrame{ index, v->is_literal() ? 4u : 0u, rebuild, {} });
+    return ReindexStatus::Pushed;
+}
+
+/// Change all indices/counters in an expression tree to 'new_index'
+static uint32_t jitc_var_reindex(uint32_t var_index, uint32_t new_index,
+                                 uint32_t mask, size_t size) {
+    std::vector<ReindexFrame> stack;
+    tsl::robin_map<uint32_t, uint32_t, UInt32Hasher> memo;
+    std::vector<Ref> memo_refs;
+    Ref result;
 
-    if (!v->is_literal()) {
-        for (uint32_t i = 0; i < 4; ++i) {
-            uint32_t index_2 = v->dep[i];
-            if (!index_2)
+    ReindexStatus status =
+        jitc_var_reindex_enter(stack, memo, var_index, size, result);
+    if (status != ReindexStatus::Pushed)
+        return result.release();
+
+    while (true) {
+        ReindexFrame &f = stack.back();
+        const Variable *v = jitc_var(f.index);
+
+        if (f.next < 4) {
+            uint32_t index_2 = v->dep[f.next];
+            if (!index_2) {
+                f.next++;
                 continue;
+            }
 
-            if (v->kind == VarKind::Gather && i == 2) {
+            if (v->kind == VarKind::Gather && f.next == 2) {
                 // Gather nodes must have their masks replaced rather than reindexed
                 JitBackend backend = (JitBackend) v->backend;
                 Ref default_mask = steal(jitc_var_mask_default(backend, size));
-                dep[i] = steal(jitc_var_and(mask, default_mask));
+                result = steal(jitc_var_and(mask, default_mask));
             } else {
-                dep[i] = steal(jitc_var_reindex(index_2, new_index, mask, size));
+                status = jitc_var_reindex_enter(stack, memo, index_2, size, result);
+                if (status == ReindexStatus::Fail)
+                    return 0;
+                else if (status == ReindexStatus::Pushed)
+                    continue; // invalidates 'f'
             }
 
-            v = jitc_var(var_index);
-            if (!dep[i])
-                return 0; // recursive call failed, give up
-            rebuild |= dep[i] != index_2;
+            if (!result)
+                return 0;
+            f.rebuild |= result != index_2;
+            f.dep[f.next++] = std::move(result);
+            continue;
         }
-    }
-
 
-    if (v->kind == VarKind::Counter) {
-        return jitc_var_new_ref(new_index);
-    } else if (rebuild) {
-        Variable v2;
-        v2.kind = v->kind;
-        v2.backend = v->backend;
-        v2.type = v->type;
-        v2.size = size;
-        v2.optix = v->optix;
-        v2.placeholder = v->placeholder;
-        if (v->is_stmt()) {
-            if (!v->free_stmt) {
-                v2.stmt = v->stmt;
-            } else {
-                v2.stmt = strdup(v->stmt);
-                v2.free_stmt = 1;
+        // All dependencies were processed, create the re-indexed variable
+        if (v->kind == VarKind::Counter) {
+            result = steal(jitc_var_new_ref(new_index));
+        } else if (f.rebuild) {
+            Variable v2;
+            v2.kind = v->kind;
+            v2.backend = v->backend;
+            v2.type = v->type;
+            v2.size = size;
+            v2.optix = v->optix;
+            v2.placeholder = v->placeholder;
+            v2.literal = v->literal;
+            for (uint32_t i = 0; i < 4; ++i) {
+                v2.dep[i] = f.dep[i];
+                jitc_var_inc_ref(f.dep[i]);
             }
+            result = steal(jitc_var_new(v2));
         } else {
-            v2.literal = v->literal;
-        }
-        for (uint32_t i = 0; i < 4; ++i) {
-            v2.dep[i] = dep[i];
-            jitc_var_inc_ref(dep[i]);
+            jitc_var_inc_ref(f.index);
+            result = steal(f.index);
         }
-        return jitc_var_new(v2);
-    } else {
-        jitc_var_inc_ref(var_index, v);
-        return var_index;
+
+        memo.emplace(f.index, (uint32_t) result);
+        memo_refs.push_back(borrow(result));
+        stack.pop_back();
+
+        if (stack.empty())
+            return result.release();
+
+        // Hand the result to the parent
+        ReindexFrame &parent = stack.back();
+        uint32_t index_2 = jitc_var(parent.index)->dep[parent.next];
+        parent.rebuild |= result != index_2;
+        parent.dep[parent.next++] = std::move(result);
     }
 }
 
@@ -1514,7 +1877,8 @@ uint32_t jitc_var_gather(uint32_t src, uint32_t index, uint32_t mask) {
 
         /// Make sure that the src and index variables doesn't have pending side effects
         if (!result && unlikely(index_v->is_dirty() || src_v->is_dirty())) {
-            jitc_eval(thread_state(src_info.backend));
+            uint32_t dep[2] = { src, index };
+            jitc_eval_dirty(thread_state(src_info.backend), dep, 2);
             if (jitc_var(index)->is_dirty())
                 jitc_fail("jit_var_gather(): operand r%u remains dirty following evaluation!", index);
             if (jitc_var(src)->is_dirty())
@@ -1535,7 +1899,10 @@ uint32_t jitc_var_gather(uint32_t src, uint32_t index, uint32_t mask) {
 
     // Don't perform the gather operation if the inputs are trivial / can be re-indexed
     if (!result) {
-        Ref index_2 = steal(jitc_var_cast(index, VarType::UInt32, 0));
+        // Counters in arrays with 2^32 or more entries are 64 bit
+        VarType index_type =
+            src_v->size > 0xFFFFFFFF ? VarType::UInt64 : VarType::UInt32;
+        Ref index_2 = steal(jitc_var_cast(index, index_type, 0));
         Ref src_reindexed = steal(jitc_var_reindex(src, index_2, mask, var_info.size));
         if (src_reindexed) {
             // Temporarily hold an extra reference to prevent 'jitc_var_resize' from changing 'src'
@@ -1657,7 +2024,7 @@ void jitc_var_scatter_reduce_kahan(uint32_t *target_1, uint32_t *target_2,
 }
 
 uint32_t jitc_var_scatter(uint32_t target_, uint32_t value, uint32_t index,
-                          uint32_t mask, ReduceOp reduce_op) {
+                          uint32_t mask, ReduceOp reduce_op, bool unique) {
     Ref target = borrow(target_), ptr;
 
     auto print_log = [&](const char *reason, uint32_t result_node = 0) {
@@ -1729,6 +2096,8 @@ uint32_t jitc_var_scatter(uint32_t target_, uint32_t value, uint32_t index,
         jitc_var(ptr), value, jitc_var(value), index_2, jitc_var(index_2),
         mask_2, jitc_var(mask_2), (uint64_t) reduce_op);
 
+    jitc_var(result)->unique_index = unique;
+
     print_log(((uint32_t) target == target_) ? "direct" : "copy", result);
 
     jitc_var_mark_side_effect(result);
@@ -1742,7 +2111,7 @@ void jitc_var_printf(JitBackend backend, uint32_t mask, const char *fmt,
                      uint32_t narg, const uint32_t *arg) {
     ThreadState *ts = thread_state(backend);
     bool dirty, placeholder;
-    uint32_t size;
+    uint64_t size;
 
     {
         Variable *mask_v = jitc_var(mask);
@@ -1763,13 +2132,16 @@ void jitc_var_printf(JitBackend backend, uint32_t mask, const char *fmt,
     placeholder |= (bool) (jitc_flags() & (uint32_t) JitFlag::Recording);
 
     if (dirty) {
-        jitc_eval(ts);
+        std::vector<uint32_t> inputs(arg, arg + narg);
+        inputs.push_back(mask);
+        jitc_eval_dirty(ts, inputs.data(), inputs.size());
         dirty = false;
         if (mask)
             dirty = jitc_var(mask)->ref_count_se != 0;
         for (uint32_t i = 0; i < narg; ++i)
             dirty |= jitc_var(arg[i])->ref_count_se != 0;
-        jitc_fail("jit_var_printf(): variable remains dirty after evaluation!");
+        if (dirty)
+            jitc_fail("jit_var_printf(): variable remains dirty after evaluation!");
     }
 
     Ref mask_2 = steal(jitc_var_mask_apply(mask, size));
@@ -26,7 +26,7 @@ extern uint32_t jitc_var_gather(uint32_t source, uint32_t index,
 /// Schedule a scatter opartion that writes to an array
 extern uint32_t jitc_var_scatter(uint32_t target, uint32_t value,
                                  uint32_t index, uint32_t mask,
-                                 ReduceOp reduce_op);
+                                 ReduceOp reduce_op, bool unique = false);
 
 /// Atomic Kahan summation
 extern void jitc_var_scatter_reduce_kahan(uint32_t *target_1,
@@ -37,6 +37,12 @@ extern void jitc_var_scatter_reduce_kahan(uint32_t *target_1,
 extern uint32_t jitc_var_cast(uint32_t index, VarType target_type,
                               int reinterpret);
 
+/// Number of times that a rewrite rule was applied (see \ref JitFlag::Simplify)
+extern size_t jitc_rewrite_count(JitRewrite rule);
+
+/// Reset the rewrite rule statistics
+extern void jitc_rewrite_clear_statistics();
+
 
 // Common unary operations
 extern uint32_t jitc_var_neg(uint32_t a0);
@@ -96,7 +102,7 @@ extern uint32_t jitc_var_shr(uint32_t a0, uint32_t a1);
 extern uint32_t jitc_var_rcp(uint32_t a0);
 extern uint32_t jitc_var_rsqrt(uint32_t a0);
 
-// Multi-function generator (CUDA)
+// Transcendental functions (CUDA: multi-function generator, LLVM: polynomials)
 extern uint32_t jitc_var_sin(uint32_t a0);
 extern uint32_t jitc_var_cos(uint32_t a0);
 extern uint32_t jitc_var_exp2(uint32_t a0);
@@ -513,7 +513,8 @@ void jitc_optix_ray_trace(uint32_t n_args, uint32_t *args, uint32_t mask,
     if (n_args < 15)
         jitc_raise("jit_optix_ray_trace(): too few arguments (got %u < 15)", n_args);
 
-    uint32_t np = n_args - 15, size = 0;
+    uint32_t np = n_args - 15;
+    uint64_t size = 0;
     if (np > 32)
         jitc_raise("jit_optix_ray_trace(): too many payloads (got %u > 32)", np);
 
@@ -545,7 +546,10 @@ void jitc_optix_ray_trace(uint32_t n_args, uint32_t *args, uint32_t mask,
     }
 
     if (dirty) {
-        jitc_eval(thread_state(JitBackend::CUDA));
+        std::vector<uint32_t> inputs(args, args + n_args);
+        inputs.push_back(mask);
+        jitc_eval_dirty(thread_state(JitBackend::CUDA), inputs.data(),
+                        inputs.size());
         dirty = false;
 
         for (uint32_t i = 0; i <= n_args; ++i) {
@@ -560,8 +564,8 @@ void jitc_optix_ray_trace(uint32_t n_args, uint32_t *args, uint32_t mask,
     // Potentially apply any masks on the mask stack
     Ref valid = steal(jitc_var_mask_apply(mask, size));
 
-    jitc_log(InfoSym, "jit_optix_ray_trace(): tracing %u ray%s, %u payload value%s%s.",
-             size, size != 1 ? "s" : "", np, np == 1 ? "" : "s",
+    jitc_log(InfoSym, "jit_optix_ray_trace(): tracing %zu ray%s, %u payload value%s%s.",
+             (size_t) size, size != 1 ? "s" : "", np, np == 1 ? "" : "s",
              placeholder ? " (part of a recorded computation)" : "");
 
     Ref index = steal(jitc_var_new_node_3(
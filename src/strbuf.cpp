@@ -4,8 +4,9 @@
 #include "eval.h"
 #include <cstdarg>
 
-/// Global string buffer used to generate PTX/LLVM IR
-StringBuffer buffer { 1024 };
+/// String buffer used to generate PTX/LLVM IR (per thread, see
+/// jitc_var_vcall_assemble_parallel())
+thread_local StringBuffer buffer { 1024 };
 
 static const char num[] = "0123456789abcdef";
 
@@ -341,7 +342,7 @@ void StringBuffer::fmt_cuda(size_t nargs, const char *fmt, ...) {
                 case 'v': {
                         const Variable *v = va_arg(args2, const Variable *);
                         put_unchecked(type_prefix[v->type]);
-                        put_u32_unchecked(v->reg_index);
+                        put_u32_unchecked(v->cold().reg_index);
                     }
                     break;
 
@@ -361,7 +362,7 @@ void StringBuffer::fmt_cuda(size_t nargs, const char *fmt, ...) {
 
                 case 'o': {
                         const Variable *v = va_arg(args2, const Variable *);
-                        put_u32_unchecked(v->param_offset);
+                        put_u32_unchecked(v->cold().param_offset);
                     }
                     break;
 
@@ -596,7 +597,7 @@ void StringBuffer::fmt_llvm(size_t nargs, const char *fmt, ...) {
                 case 'v': {
                         const Variable *v = va_arg(args2, const Variable *);
                         put_unchecked(type_prefix[v->type]);
-                        put_u32_unchecked(v->reg_index);
+                        put_u32_unchecked(v->cold().reg_index);
                     }
                     break;
 
@@ -609,7 +610,7 @@ void StringBuffer::fmt_llvm(size_t nargs, const char *fmt, ...) {
                         *m_cur ++= '>';
                         *m_cur ++= ' ';
                         put_unchecked(type_prefix[v->type]);
-                        put_u32_unchecked(v->reg_index);
+                        put_u32_unchecked(v->cold().reg_index);
                     }
                     break;
 
@@ -650,7 +651,7 @@ void StringBuffer::fmt_llvm(size_t nargs, const char *fmt, ...) {
 
                 case 'o': {
                         const Variable *v = va_arg(args2, const Variable *);
-                        put_u32_unchecked(v->param_offset / (uint32_t) sizeof(void *));
+                        put_u32_unchecked(v->cold().param_offset / (uint32_t) sizeof(void *));
                     }
                     break;
 
@@ -213,7 +213,7 @@ private:
     char *m_start, *m_cur, *m_end;
 };
 
-extern StringBuffer buffer;
+extern thread_local StringBuffer buffer;
 
 /// Helper function used to check that fmt_cuda/fmt_llvm process all arguments
 template <typename... Ts> constexpr size_t count_args(const Ts &...) {
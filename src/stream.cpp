@@ -0,0 +1,545 @@
+/*
+    src/stream.cpp -- Out-of-core streaming evaluation. Runs a traced
+    computation chunk by chunk so that neither its inputs nor its outputs
+    must ever be resident in memory as a whole.
+
+    Copyright (c) 2021 Wenzel Jakob <wenzel.jakob@epfl.ch>
+
+    All rights reserved. Use of this source code is governed by a BSD-style
+    license that can be found in the LICENSE file.
+*/
+
+#include "stream.h"
+#include "internal.h"
+#include "var.h"
+#include "eval.h"
+#include "util.h"
+#include "op.h"
+#include "log.h"
+#include "llvm.h"
+
+#if !defined(_WIN32)
+#  include <fcntl.h>
+#  include <unistd.h>
+#  include <sys/stat.h>
+#  include <sys/mman.h>
+#endif
+
+/// Default number of elements processed per chunk
+#define DRJIT_STREAM_CHUNK_SIZE (16 * 1024 * 1024)
+
+/**
+ * Bookkeeping for a chunk that is in flight. Two of these alternate: the
+ * inputs of chunk 'i + 1' are prepared, and the outputs of chunk 'i - 1' are
+ * written out while the kernel of chunk 'i' runs.
+ */
+struct StreamChunk {
+    /// Index of the first element and number of elements
+    size_t start = 0;
+    uint32_t count = 0;
+
+    /// Variables representing the inputs and outputs (owning references)
+    std::vector<uint32_t> in, out;
+
+    /// Host buffers receiving the output of 'JitStreamInput::source'
+    std::vector<void *> in_buf;
+
+    /// Host-pinned staging memory for elementwise outputs (CUDA only)
+    std::vector<void *> out_buf;
+
+    /// Signals completion of the chunk's kernels (LLVM only)
+    Task *task = nullptr;
+
+    /// Signals completion of the chunk's kernels and downloads (CUDA only)
+    CUevent event = nullptr;
+
+    /// Does this chunk have outputs that still need to be delivered?
+    bool active = false;
+};
+
+struct Stream {
+    JitBackend backend;
+    ThreadState *ts;
+    size_t size;
+    uint32_t chunk_size;
+    uint32_t input_count, output_count;
+    const JitStreamInput *inputs;
+    JitStreamOutput *outputs;
+
+    /// Mappings of file-backed inputs, established once for the whole stream
+    struct InputMapping {
+        void *base = nullptr;
+        size_t size = 0;
+        uint8_t *ptr = nullptr;
+    };
+    std::vector<InputMapping> in_map;
+
+    /// File descriptors of file-backed outputs (or -1)
+    std::vector<int> out_fd;
+
+    /// Output types (determined by the first chunk)
+    std::vector<VarType> out_type;
+
+    /// Running value of each reduction (size-1 variables)
+    std::vector<uint32_t> acc;
+
+    StreamChunk chunks[2];
+
+    Stream(JitBackend backend, size_t size, uint32_t chunk_size,
+           uint32_t input_count, const JitStreamInput *inputs,
+           uint32_t output_count, JitStreamOutput *outputs);
+    ~Stream();
+
+    void acquire();
+    void release();
+    void prepare(StreamChunk &c, size_t start);
+    void launch(StreamChunk &c, JitStreamKernel kernel, void *payload);
+    void finish(StreamChunk &c);
+};
+
+static JitOp jitc_stream_fold_op(ReduceOp op) {
+    switch (op) {
+        case ReduceOp::Add: return JitOp::Add;
+        case ReduceOp::Mul: return JitOp::Mul;
+        case ReduceOp::Min: return JitOp::Min;
+        case ReduceOp::Max: return JitOp::Max;
+        default:
+            jitc_raise("jit_eval_stream(): unsupported reduction \"%s\"!",
+                       reduction_name[(int) op]);
+    }
+}
+
+Stream::Stream(JitBackend backend, size_t size, uint32_t chunk_size,
+               uint32_t input_count, const JitStreamInput *inputs,
+               uint32_t output_count, JitStreamOutput *outputs)
+    : backend(backend), ts(thread_state(backend)), size(size),
+      chunk_size(chunk_size), input_count(input_count),
+      output_count(output_count), inputs(inputs), outputs(outputs),
+      in_map(input_count), out_fd(output_count, -1),
+      out_type(output_count, VarType::Void), acc(output_count, 0) {
+
+    for (StreamChunk &c : chunks) {
+        c.in.resize(input_count, 0);
+        c.in_buf.resize(input_count, nullptr);
+        c.out.resize(output_count, 0);
+        c.out_buf.resize(output_count, nullptr);
+    }
+
+    // The destructor does not run when the constructor raises an exception
+    try {
+        acquire();
+    } catch (...) {
+        release();
+        throw;
+    }
+}
+
+Stream::~Stream() { release(); }
+
+/// Create events, map file-backed inputs, and open file-backed outputs
+void Stream::acquire() {
+    if (backend == JitBackend::CUDA) {
+        scoped_set_context guard(ts->context);
+        for (StreamChunk &c : chunks)
+            cuda_check(cuEventCreate(&c.event, CU_EVENT_DISABLE_TIMING));
+    }
+
+#if !defined(_WIN32)
+    size_t page_size = (size_t) sysconf(_SC_PAGESIZE);
+
+    for (uint32_t i = 0; i < input_count; ++i) {
+        const JitStreamInput &in = inputs[i];
+        if (!in.filename)
+            continue;
+
+        // Validate the file size up front instead of failing mid-stream
+        int fd = open(in.filename, O_RDONLY);
+        if (fd < 0)
+            jitc_raise("jit_eval_stream(): could not open \"%s\": %s!",
+                       in.filename, strerror(errno));
+
+        size_t total_size = size * (size_t) type_size[(int) in.type];
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (size_t) st.st_size < in.offset + total_size) {
+            close(fd);
+            jitc_raise("jit_eval_stream(): \"%s\" is too small to hold %zu "
+                       "bytes at offset %zu!", in.filename, total_size,
+                       in.offset);
+        }
+
+        /* Map the entire input once, chunks then refer to subranges. The
+           mapping is private and thus never modifies the file. */
+        size_t map_offset = in.offset / page_size * page_size,
+               map_size   = total_size + (in.offset - map_offset);
+        void *base = mmap(nullptr, map_size, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE, fd, (off_t) map_offset);
+        close(fd);
+
+        if (base == MAP_FAILED)
+            jitc_raise("jit_eval_stream(): mmap() of \"%s\" failed: %s!",
+                       in.filename, strerror(errno));
+
+        in_map[i].base = base;
+        in_map[i].size = map_size;
+        in_map[i].ptr  = (uint8_t *) base + (in.offset - map_offset);
+    }
+
+    for (uint32_t i = 0; i < output_count; ++i) {
+        const JitStreamOutput &out = outputs[i];
+        if (out.reduce != ReduceOp::None || !out.filename)
+            continue;
+        int fd = open(out.filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+            jitc_raise("jit_eval_stream(): could not open \"%s\": %s!",
+                       out.filename, strerror(errno));
+        out_fd[i] = fd;
+    }
+#endif
+}
+
+/// Release all resources (also handles partially constructed streams)
+void Stream::release() {
+    for (StreamChunk &c : chunks) {
+        if (c.task) {
+            {
+                unlock_guard guard(state.lock);
+                task_wait(c.task);
+            }
+            task_release(c.task);
+            c.task = nullptr;
+        }
+        for (uint32_t &index : c.in) {
+            jitc_var_dec_ref(index);
+            index = 0;
+        }
+        for (uint32_t &index : c.out) {
+            jitc_var_dec_ref(index);
+            index = 0;
+        }
+    }
+
+    if (backend == JitBackend::CUDA) {
+        scoped_set_context guard(ts->context);
+        cuStreamSynchronize(ts->stream);
+        for (StreamChunk &c : chunks) {
+            if (c.event)
+                cuEventDestroy(c.event);
+            c.event = nullptr;
+        }
+    }
+
+    for (StreamChunk &c : chunks) {
+        for (void *&ptr : c.in_buf) {
+            jitc_free(ptr);
+            ptr = nullptr;
+        }
+        for (void *&ptr : c.out_buf) {
+            jitc_free(ptr);
+            ptr = nullptr;
+        }
+    }
+
+    for (uint32_t &index : acc) {
+        jitc_var_dec_ref(index);
+        index = 0;
+    }
+
+#if !defined(_WIN32)
+    for (InputMapping &m : in_map) {
+        if (!m.base)
+            continue;
+        // Kernels of the caller might still reference the mapped inputs
+        if (backend == JitBackend::LLVM)
+            jitc_munmap_async(backend, m.base, m.size);
+        else
+            munmap(m.base, m.size);
+        m = InputMapping();
+    }
+    for (int &fd : out_fd) {
+        if (fd >= 0)
+            close(fd);
+        fd = -1;
+    }
+#endif
+}
+
+/// Create the input variables of chunk 'c'
+void Stream::prepare(StreamChunk &c, size_t start) {
+    c.start = start;
+    c.count = (uint32_t) std::min((size_t) chunk_size, size - start);
+
+    for (uint32_t i = 0; i < input_count; ++i) {
+        const JitStreamInput &in = inputs[i];
+        uint32_t isize = type_size[(int) in.type];
+
+        if (in.filename) {
+#if !defined(_WIN32)
+            uint8_t *ptr = in_map[i].ptr + start * isize;
+
+            // GPUs can't access the mapping directly and receive a copy
+            if (backend == JitBackend::CUDA)
+                c.in[i] = jitc_var_mem_copy(backend, AllocType::Host,
+                                            in.type, ptr, c.count);
+            else
+                c.in[i] = jitc_var_mem_map(backend, in.type, ptr, c.count, 0);
+
+            // Let the OS read the following chunk in the background
+            size_t next = start + c.count;
+            if (next < size) {
+                uintptr_t page_size = (uintptr_t) sysconf(_SC_PAGESIZE),
+                          begin = (uintptr_t) (in_map[i].ptr + next * isize),
+                          end = begin + std::min((size_t) chunk_size, size - next) * isize;
+                begin = begin / page_size * page_size;
+                madvise((void *) begin, end - begin, MADV_WILLNEED);
+            }
+#endif
+            continue;
+        }
+
+        /* The buffer of this slot was last used by chunk 'i - 2', which
+           has finished at this point. On the LLVM backend, the kernel reads
+           it directly. On the CUDA backend, it is a pinned staging area for
+           an asynchronous upload. */
+        if (!c.in_buf[i])
+            c.in_buf[i] = jitc_malloc(backend == JitBackend::CUDA
+                                          ? AllocType::HostPinned
+                                          : AllocType::Host,
+                                      (size_t) chunk_size * isize);
+
+        {
+            unlock_guard guard(state.lock);
+            in.source(in.payload, c.start, c.count, c.in_buf[i]);
+        }
+
+        if (backend == JitBackend::CUDA)
+            c.in[i] = jitc_var_mem_copy(backend, AllocType::HostPinned,
+                                        in.type, c.in_buf[i], c.count);
+        else
+            c.in[i] = jitc_var_mem_map(backend, in.type, c.in_buf[i],
+                                       c.count, 0);
+    }
+}
+
+/// Trace and launch the computation of chunk 'c'
+void Stream::launch(StreamChunk &c, JitStreamKernel kernel, void *payload) {
+    {
+        unlock_guard guard(state.lock);
+        kernel(payload, c.start, c.count, c.in.data(), c.out.data());
+    }
+
+    for (uint32_t i = 0; i < output_count; ++i) {
+        uint32_t index = c.out[i];
+        if (!index)
+            jitc_raise("jit_eval_stream(): output %u was not set!", i);
+
+        const Variable *v = jitc_var(index);
+        if ((JitBackend) v->backend != backend)
+            jitc_raise("jit_eval_stream(): output %u has the wrong backend!", i);
+        else if (v->size != c.count && v->size != 1)
+            jitc_raise("jit_eval_stream(): output %u has size %zu, expected %u!",
+                       i, (size_t) v->size, c.count);
+
+        VarType type = (VarType) v->type;
+        if (out_type[i] == VarType::Void)
+            out_type[i] = type;
+        else if (out_type[i] != type)
+            jitc_raise("jit_eval_stream(): the type of output %u changed "
+                       "between chunks!", i);
+
+        if (v->size != c.count) {
+            c.out[i] = jitc_var_resize(index, c.count);
+            jitc_var_dec_ref(index);
+        }
+
+        jitc_var_schedule(c.out[i]);
+    }
+
+    // Inputs are referenced by the kernel and can be released afterwards
+    jitc_eval(ts);
+    for (uint32_t &index : c.in) {
+        jitc_var_dec_ref(index);
+        index = 0;
+    }
+
+    for (uint32_t i = 0; i < output_count; ++i) {
+        const JitStreamOutput &out = outputs[i];
+        Variable *v = jitc_var(c.out[i]);
+
+        if (out.reduce == ReduceOp::None) {
+            if (v->is_literal())
+                jitc_var_eval_literal(c.out[i], v);
+            continue;
+        }
+
+        /* Fold the partial reduction into the running value. The combined
+           value is evaluated along with the next chunk, which keeps the
+           expression from growing with the number of chunks. */
+        uint32_t partial = jitc_var_reduce(c.out[i], out.reduce);
+        jitc_var_dec_ref(c.out[i]);
+        c.out[i] = 0;
+
+        if (!acc[i]) {
+            acc[i] = partial;
+        } else {
+            uint32_t dep[2] = { acc[i], partial };
+            uint32_t folded = jitc_var_op(jitc_stream_fold_op(out.reduce), dep);
+            jitc_var_dec_ref(acc[i]);
+            jitc_var_dec_ref(partial);
+            acc[i] = folded;
+            jitc_var_schedule(folded);
+        }
+    }
+
+    if (backend == JitBackend::CUDA) {
+        scoped_set_context guard(ts->context);
+        for (uint32_t i = 0; i < output_count; ++i) {
+            if (!c.out[i])
+                continue;
+            size_t bytes = (size_t) c.count * type_size[(int) out_type[i]];
+            if (!c.out_buf[i])
+                c.out_buf[i] =
+                    jitc_malloc(AllocType::HostPinned,
+                                (size_t) chunk_size * type_size[(int) out_type[i]]);
+            cuda_check(cuMemcpyAsync((CUdeviceptr) c.out_buf[i],
+                                     (CUdeviceptr) jitc_var(c.out[i])->data,
+                                     bytes, ts->stream));
+        }
+        cuda_check(cuEventRecord(c.event, ts->stream));
+    } else {
+        c.task = jitc_task;
+        if (c.task)
+            task_retain(c.task);
+    }
+
+    c.active = true;
+}
+
+/// Wait for chunk 'c' and deliver its elementwise outputs
+void Stream::finish(StreamChunk &c) {
+    if (!c.active)
+        return;
+
+    if (backend == JitBackend::CUDA) {
+        unlock_guard guard(state.lock);
+        scoped_set_context guard_2(ts->context);
+        cuda_check(cuEventSynchronize(c.event));
+    } else if (c.task) {
+        {
+            unlock_guard guard(state.lock);
+            task_wait(c.task);
+        }
+        task_release(c.task);
+        c.task = nullptr;
+    }
+
+    for (uint32_t i = 0; i < output_count; ++i) {
+        if (!c.out[i])
+            continue;
+
+        const JitStreamOutput &out = outputs[i];
+        const void *ptr = backend == JitBackend::CUDA ? c.out_buf[i]
+                                                      : jitc_var(c.out[i])->data;
+        size_t bytes = (size_t) c.count * type_size[(int) out_type[i]];
+        bool success = true;
+
+        {
+            unlock_guard guard(state.lock);
+            if (out.sink)
+                out.sink(out.payload, c.start, c.count, ptr);
+#if !defined(_WIN32)
+            else
+                success = jitc_write_all(out_fd[i], (const uint8_t *) ptr, bytes);
+#endif
+        }
+
+        if (!success)
+            jitc_raise("jit_eval_stream(): could not write \"%s\": %s!",
+                       out.filename, strerror(errno));
+
+        jitc_var_dec_ref(c.out[i]);
+        c.out[i] = 0;
+    }
+
+    c.active = false;
+}
+
+void jitc_eval_stream(JitBackend backend, size_t size, uint32_t chunk_size,
+                      uint32_t input_count, const JitStreamInput *inputs,
+                      uint32_t output_count, JitStreamOutput *outputs,
+                      JitStreamKernel kernel, void *payload) {
+    if (size == 0)
+        return;
+    else if (!kernel)
+        jitc_raise("jit_eval_stream(): 'kernel' must be specified!");
+
+    for (uint32_t i = 0; i < input_count; ++i) {
+        const JitStreamInput &in = inputs[i];
+        if ((in.filename != nullptr) == (in.source != nullptr))
+            jitc_raise("jit_eval_stream(): input %u must specify exactly one "
+                       "of 'filename' and 'source'!", i);
+        else if (in.type == VarType::Void || in.type >= VarType::Count)
+            jitc_raise("jit_eval_stream(): input %u has an invalid type!", i);
+    }
+
+    for (uint32_t i = 0; i < output_count; ++i) {
+        const JitStreamOutput &out = outputs[i];
+        if (out.reduce == ReduceOp::None) {
+            if ((out.filename != nullptr) == (out.sink != nullptr))
+                jitc_raise("jit_eval_stream(): output %u must specify "
+                           "exactly one of 'filename' and 'sink'!", i);
+        } else {
+            (void) jitc_stream_fold_op(out.reduce);
+        }
+    }
+
+#if defined(_WIN32)
+    for (uint32_t i = 0; i < input_count; ++i) {
+        if (inputs[i].filename)
+            jitc_raise("jit_eval_stream(): file-backed inputs are not "
+                       "supported on Windows!");
+    }
+    for (uint32_t i = 0; i < output_count; ++i) {
+        if (outputs[i].reduce == ReduceOp::None && outputs[i].filename)
+            jitc_raise("jit_eval_stream(): file-backed outputs are not "
+                       "supported on Windows!");
+    }
+#endif
+
+    if (chunk_size == 0)
+        chunk_size = DRJIT_STREAM_CHUNK_SIZE;
+    chunk_size = (uint32_t) std::min((size_t) chunk_size, size);
+    size_t chunk_count = (size + chunk_size - 1) / chunk_size;
+
+    jitc_log(Info,
+             "jit_eval_stream(): processing %zu elements in %zu chunk%s of "
+             "size %u (%u input%s, %u output%s).",
+             size, chunk_count, chunk_count == 1 ? "" : "s", chunk_size,
+             input_count, input_count == 1 ? "" : "s", output_count,
+             output_count == 1 ? "" : "s");
+
+    Stream s(backend, size, chunk_size, input_count, inputs, output_count,
+             outputs);
+
+    /* The traced computation is identical for every chunk (chunk-dependent
+       constants should be passed as opaque literals). All chunks after the
+       first one therefore hit the kernel cache. */
+    s.prepare(s.chunks[0], 0);
+    for (size_t i = 0; i < chunk_count; ++i) {
+        StreamChunk &cur  = s.chunks[i & 1],
+                    &prev = s.chunks[(i + 1) & 1];
+
+        s.launch(cur, kernel, payload);
+        s.finish(prev);
+
+        if (i + 1 < chunk_count)
+            s.prepare(prev, (i + 1) * (size_t) chunk_size);
+    }
+    s.finish(s.chunks[(chunk_count - 1) & 1]);
+
+    for (uint32_t i = 0; i < output_count; ++i) {
+        if (!s.acc[i])
+            continue;
+        outputs[i].result = 0;
+        jitc_var_read(s.acc[i], 0, &outputs[i].result);
+    }
+}
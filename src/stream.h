@@ -0,0 +1,19 @@
+/*
+    src/stream.h -- Out-of-core streaming evaluation
+
+    Copyright (c) 2021 Wenzel Jakob <wenzel.jakob@epfl.ch>
+
+    All rights reserved. Use of this source code is governed by a BSD-style
+    license that can be found in the LICENSE file.
+*/
+
+#pragma once
+
+#include <drjit-core/jit.h>
+
+/// Evaluate a traced computation chunk by chunk (see \ref jit_eval_stream())
+extern void jitc_eval_stream(JitBackend backend, size_t size,
+                             uint32_t chunk_size, uint32_t input_count,
+                             const JitStreamInput *inputs,
+                             uint32_t output_count, JitStreamOutput *outputs,
+                             JitStreamKernel kernel, void *payload);
@@ -20,12 +20,38 @@
 #  pragma warning (disable: 4146) // unary minus operator applied to unsigned type, result still unsigned
 #endif
 
+#if !defined(_WIN32)
+#  include <sys/mman.h>
+#  include <unistd.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+#  include <emmintrin.h>
+#  define DRJIT_NONTEMPORAL 1
+#else
+#  define DRJIT_NONTEMPORAL 0
+#endif
+
+/// Number of bytes processed per work unit by parallel memset/memcpy operations
+#define DRJIT_MEMOP_BLOCK_SIZE (256 * 1024)
+
+/// Bypass the cache hierarchy when filling/copying regions larger than this
+#define DRJIT_NONTEMPORAL_THRESHOLD (32 * 1024 * 1024)
+
+/// The precompiled CUDA kernels used below take 32 bit array sizes
+static uint32_t jitc_cuda_size(const char *name, size_t size) {
+    if (unlikely(size > 0xFFFFFFFF))
+        jitc_raise("%s(): arrays with 2^32 or more entries are only supported "
+                   "by the LLVM backend (got %zu entries)!", name, size);
+    return (uint32_t) size;
+}
+
 const char *reduction_name[(int) ReduceOp::Count] = { "none", "sum", "mul",
                                                       "min", "max", "and", "or" };
 
 /// Helper function: enqueue parallel CPU task (synchronous or asynchronous)
 template <typename Func>
-void jitc_submit_cpu(KernelType type, Func &&func, uint32_t width,
+void jitc_submit_cpu(KernelType type, Func &&func, size_t width,
                      uint32_t size = 1, bool release_prev = true,
                      bool always_async = false) {
 
@@ -64,7 +90,7 @@ void jitc_submit_cpu(KernelType type, Func &&func, uint32_t width,
 void jitc_submit_gpu(KernelType type, CUfunction kernel, uint32_t block_count,
                      uint32_t thread_count, uint32_t shared_mem_bytes,
                      CUstream stream, void **args, void **extra,
-                     uint32_t width) {
+                     size_t width) {
 
     KernelHistoryEntry entry = {};
 
@@ -94,13 +120,106 @@ void jitc_submit_gpu(KernelType type, CUfunction kernel, uint32_t block_count,
     }
 }
 
+/**
+ * Fill 'size' bytes with a repeating 64 bit pattern. Large fills use
+ * non-temporal stores, which don't pollute the cache with data that is unlikely
+ * to be accessed again soon. Byte 'i' of the output receives byte 'i % 8' of
+ * the pattern, hence work units must start at multiples of 8 bytes.
+ */
+static void jitc_fill_block(uint8_t *ptr, size_t size, uint64_t pattern,
+                            bool nontemporal) {
+    uint8_t pattern8[8];
+    memcpy(pattern8, &pattern, 8);
+
+    size_t i = 0;
+
+#if DRJIT_NONTEMPORAL
+    if (nontemporal) {
+        // Advance to the next 16-byte boundary
+        for (; i < size && ((uintptr_t) (ptr + i) & 15); ++i)
+            ptr[i] = pattern8[i & 7];
+
+        // Rotate the pattern so that it lines up with the aligned address
+        uint32_t shift = (uint32_t) (i & 7) * 8;
+        uint64_t rotated = shift ? ((pattern >> shift) | (pattern << (64 - shift)))
+                                 : pattern;
+
+        __m128i value = _mm_set1_epi64x((long long) rotated);
+        for (; i + 64 <= size; i += 64) {
+            _mm_stream_si128((__m128i *) (ptr + i), value);
+            _mm_stream_si128((__m128i *) (ptr + i + 16), value);
+            _mm_stream_si128((__m128i *) (ptr + i + 32), value);
+            _mm_stream_si128((__m128i *) (ptr + i + 48), value);
+        }
+
+        // Non-temporal stores are weakly ordered
+        _mm_sfence();
+    }
+#else
+    (void) nontemporal;
+#endif
+
+    if (pattern == pattern8[0] * 0x0101010101010101ull) {
+        memset(ptr + i, pattern8[0], size - i);
+        return;
+    }
+
+    // Bulk of the work: let the compiler vectorize this loop
+    for (; i < size && ((uintptr_t) (ptr + i) & 7); ++i)
+        ptr[i] = pattern8[i & 7];
+
+    uint64_t rotated = pattern;
+    if (uint32_t shift = (uint32_t) (i & 7) * 8; shift)
+        rotated = (pattern >> shift) | (pattern << (64 - shift));
+
+    uint64_t *ptr64 = (uint64_t *) (ptr + i);
+    size_t count = (size - i) / 8;
+    for (size_t j = 0; j < count; ++j)
+        ptr64[j] = rotated;
+    i += count * 8;
+
+    for (; i < size; ++i)
+        ptr[i] = pattern8[i & 7];
+}
+
+/// Copy 'size' bytes, using non-temporal stores if requested
+static void jitc_copy_block(uint8_t *dst, const uint8_t *src, size_t size,
+                            bool nontemporal) {
+#if DRJIT_NONTEMPORAL
+    if (nontemporal) {
+        size_t head = std::min(size, (size_t) ((16 - ((uintptr_t) dst & 15)) & 15));
+        memcpy(dst, src, head);
+
+        size_t i = head;
+        for (; i + 64 <= size; i += 64) {
+            __m128i v0 = _mm_loadu_si128((const __m128i *) (src + i)),
+                    v1 = _mm_loadu_si128((const __m128i *) (src + i + 16)),
+                    v2 = _mm_loadu_si128((const __m128i *) (src + i + 32)),
+                    v3 = _mm_loadu_si128((const __m128i *) (src + i + 48));
+            _mm_stream_si128((__m128i *) (dst + i), v0);
+            _mm_stream_si128((__m128i *) (dst + i + 16), v1);
+            _mm_stream_si128((__m128i *) (dst + i + 32), v2);
+            _mm_stream_si128((__m128i *) (dst + i + 48), v3);
+        }
+        _mm_sfence();
+
+        memcpy(dst + i, src + i, size - i);
+        return;
+    }
+#else
+    (void) nontemporal;
+#endif
+
+    memcpy(dst, src, size);
+}
+
 /// Fill a device memory region with constants of a given type
-void jitc_memset_async(JitBackend backend, void *ptr, uint32_t size_,
+void jitc_memset_async(JitBackend backend, void *ptr, size_t size_,
                        uint32_t isize, const void *src) {
     if (isize != 1 && isize != 2 && isize != 4 && isize != 8)
         jitc_raise("jit_memset_async(): invalid element size (must be 1, 2, 4, or 8)!");
 
-    jitc_trace("jit_memset_async(" DRJIT_PTR ", isize=%u, size=%u)",
+    jitc_trace("jit_memset_async(" DRJIT_PTR ", isize=%u, size=%zu)",
               (uintptr_t) ptr, isize, size_);
 
     if (size_ == 0)
@@ -140,9 +259,10 @@ void jitc_memset_async(JitBackend backend, void *ptr, uint32_t size_,
 
             case 8: {
                     const Device &device = state.devices[ts->device];
-                    uint32_t block_count, thread_count;
-                    device.get_launch_config(&block_count, &thread_count, size_);
-                    void *args[] = { &ptr, &size_, (void *) src };
+                    uint32_t block_count, thread_count,
+                             size_32 = jitc_cuda_size("jit_memset_async", size_);
+                    device.get_launch_config(&block_count, &thread_count, size_32);
+                    void *args[] = { &ptr, &size_32, (void *) src };
                     CUfunction kernel = jitc_cuda_fill_64[device.id];
                     jitc_submit_gpu(KernelType::Other, kernel, block_count,
                                     thread_count, 0, ts->stream, args, nullptr,
@@ -151,46 +271,106 @@ void jitc_memset_async(JitBackend backend, void *ptr, uint32_t size_,
                 break;
         }
     } else {
-        uint8_t src8[8] { };
-        memcpy(&src8, src, isize);
-
-        jitc_submit_cpu(KernelType::Other,
-            [ptr, src8, size, isize](uint32_t) {
-                switch (isize) {
-                    case 1:
-                        memset(ptr, src8[0], size);
-                        break;
-
-                    case 2: {
-                            uint16_t value = ((uint16_t *) src8)[0],
-                                    *p = (uint16_t *) ptr;
-                            for (uint32_t i = 0; i < size; ++i)
-                                p[i] = value;
-                        }
-                        break;
+        // Replicate the fill value into a 64 bit pattern
+        uint64_t pattern = 0;
+        memcpy(&pattern, src, isize);
+        switch (isize) {
+            case 1: pattern *= 0x0101010101010101ull; break;
+            case 2: pattern *= 0x0001000100010001ull; break;
+            case 4: pattern |= pattern << 32; break;
+        }
 
-                    case 4: {
-                            uint32_t value = ((uint32_t *) src8)[0],
-                                    *p = (uint32_t *) ptr;
-                            for (uint32_t i = 0; i < size; ++i)
-                                p[i] = value;
-                        }
-                        break;
+        size_t size_bytes = size * isize;
+        bool nontemporal = size_bytes >= DRJIT_NONTEMPORAL_THRESHOLD;
 
-                    case 8: {
-                            uint64_t value = ((uint64_t *) src8)[0],
-                                    *p = (uint64_t *) ptr;
-                            for (uint32_t i = 0; i < size; ++i)
-                                p[i] = value;
-                        }
-                        break;
-                }
+        size_t work_unit_size = size_bytes;
+        uint32_t work_units = 1;
+        if (pool_size() > 1) {
+            work_unit_size = DRJIT_MEMOP_BLOCK_SIZE;
+            work_units     = (uint32_t) ((size_bytes + work_unit_size - 1) / work_unit_size);
+        }
+
+        jitc_submit_cpu(
+            KernelType::Other,
+            [ptr, pattern, size_bytes, work_unit_size, nontemporal](uint32_t index) {
+                size_t start = (size_t) index * work_unit_size,
+                       end   = std::min(start + work_unit_size, size_bytes);
+                jitc_fill_block((uint8_t *) ptr + start, end - start, pattern,
+                                nontemporal);
             },
 
-            (uint32_t) size
+            size_, work_units
+        );
+    }
+}
+
+void *jitc_calloc_async(JitBackend backend, size_t size, uint32_t isize) {
+    size_t dsize = size * (size_t) isize;
+    uint64_t zero = 0;
+
+    if (backend == JitBackend::CUDA || size == 0) {
+        void *ptr = jitc_malloc(backend == JitBackend::CUDA
+                                    ? AllocType::Device
+                                    : AllocType::HostAsync, dsize);
+        jitc_memset_async(backend, ptr, size, isize, &zero);
+        return ptr;
+    }
+
+    bool is_zero = false;
+    void *ptr = jitc_malloc(AllocType::HostAsync, dsize, &is_zero);
+    size_t capacity = is_zero ? 0 : jitc_malloc_discardable(ptr);
+
+    jitc_trace("jit_calloc_async(" DRJIT_PTR ", isize=%u, size=%zu): %s",
+               (uintptr_t) ptr, isize, size,
+               is_zero ? "fresh mapping" : (capacity ? "discard" : "memset"));
+
+    if (is_zero) {
+        return ptr;
+    } else if (capacity) {
+        // Must not run before prior kernels accessing the recycled region finish
+        jitc_submit_cpu(
+            KernelType::Other,
+            [ptr, capacity](uint32_t) { jitc_malloc_discard(ptr, capacity); },
+            size
         );
+    } else {
+        jitc_memset_async(backend, ptr, size, isize, &zero);
+    }
+
+    return ptr;
+}
+
+void jitc_munmap_async(JitBackend backend, void *ptr, size_t size) {
+    if (backend != JitBackend::LLVM)
+        jitc_fail("jit_munmap_async(): only supported by the LLVM backend!");
+
+#if !defined(_WIN32)
+    jitc_trace("jit_munmap_async(" DRJIT_PTR ", size=%zu)", (uintptr_t) ptr, size);
+    jitc_submit_cpu(
+        KernelType::Other,
+        [ptr, size](uint32_t) { munmap(ptr, size); },
+        1
+    );
+#else
+    (void) ptr; (void) size;
+#endif
+}
+
+#if !defined(_WIN32)
+bool jitc_write_all(int fd, const uint8_t *ptr, size_t size) {
+    while (size > 0) {
+        ssize_t rv = write(fd, ptr, size);
+        if (rv < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        ptr += rv;
+        size -= (size_t) rv;
     }
+    return true;
 }
+#endif
 
 /// Perform a synchronous copy operation
 void jitc_memcpy(JitBackend backend, void *dst, const void *src, size_t size) {
@@ -217,18 +397,31 @@ void jitc_memcpy_async(JitBackend backend, void *dst, const void *src, size_t si
         cuda_check(cuMemcpyAsync((CUdeviceptr) dst, (CUdeviceptr) src, size,
                                  ts->stream));
     } else {
+        bool nontemporal = size >= DRJIT_NONTEMPORAL_THRESHOLD;
+
+        size_t work_unit_size = size;
+        uint32_t work_units = 1;
+        if (pool_size() > 1) {
+            work_unit_size = DRJIT_MEMOP_BLOCK_SIZE;
+            work_units     = (uint32_t) ((size + work_unit_size - 1) / work_unit_size);
+        }
+
         jitc_submit_cpu(
             KernelType::Other,
-            [dst, src, size](uint32_t) {
-                memcpy(dst, src, size);
+            [dst, src, size, work_unit_size, nontemporal](uint32_t index) {
+                size_t start = (size_t) index * work_unit_size,
+                       end   = std::min(start + work_unit_size, size);
+                jitc_copy_block((uint8_t *) dst + start,
+                                (const uint8_t *) src + start, end - start,
+                                nontemporal);
             },
 
-            (uint32_t) size
+            size, work_units
         );
     }
 }
 
-using Reduction = void (*) (const void *ptr, uint32_t start, uint32_t end, void *out);
+using Reduction = void (*) (const void *ptr, size_t start, size_t end, void *out);
 
 template <typename Value>
 static Reduction jitc_reduce_create(ReduceOp rtype) {
@@ -236,59 +429,59 @@ static Reduction jitc_reduce_create(ReduceOp rtype) {
 
     switch (rtype) {
         case ReduceOp::Add:
-            return [](const void *ptr_, uint32_t start, uint32_t end, void *out) {
+            return [](const void *ptr_, size_t start, size_t end, void *out) {
                 const Value *ptr = (const Value *) ptr_;
                 Value result = 0;
-                for (uint32_t i = start; i != end; ++i)
+                for (size_t i = start; i != end; ++i)
                     result += ptr[i];
                 *((Value *) out) = result;
             };
 
         case ReduceOp::Mul:
-            return [](const void *ptr_, uint32_t start, uint32_t end, void *out) {
+            return [](const void *ptr_, size_t start, size_t end, void *out) {
                 const Value *ptr = (const Value *) ptr_;
                 Value result = 1;
-                for (uint32_t i = start; i != end; ++i)
+                for (size_t i = start; i != end; ++i)
                     result *= ptr[i];
                 *((Value *) out) = result;
             };
 
         case ReduceOp::Max:
-            return [](const void *ptr_, uint32_t start, uint32_t end, void *out) {
+            return [](const void *ptr_, size_t start, size_t end, void *out) {
                 const Value *ptr = (const Value *) ptr_;
                 Value result = std::is_integral<Value>::value
                                    ?  std::numeric_limits<Value>::min()
                                    : -std::numeric_limits<Value>::infinity();
-                for (uint32_t i = start; i != end; ++i)
+                for (size_t i = start; i != end; ++i)
                     result = std::max(result, ptr[i]);
                 *((Value *) out) = result;
             };
 
         case ReduceOp::Min:
-            return [](const void *ptr_, uint32_t start, uint32_t end, void *out) {
+            return [](const void *ptr_, size_t start, size_t end, void *out) {
                 const Value *ptr = (const Value *) ptr_;
                 Value result = std::is_integral<Value>::value
                                    ?  std::numeric_limits<Value>::max()
                                    :  std::numeric_limits<Value>::infinity();
-                for (uint32_t i = start; i != end; ++i)
+                for (size_t i = start; i != end; ++i)
                     result = std::min(result, ptr[i]);
                 *((Value *) out) = result;
             };
 
         case ReduceOp::Or:
-            return [](const void *ptr_, uint32_t start, uint32_t end, void *out) {
+            return [](const void *ptr_, size_t start, size_t end, void *out) {
                 const UInt *ptr = (const UInt *) ptr_;
                 UInt result = 0;
-                for (uint32_t i = start; i != end; ++i)
+                for (size_t i = start; i != end; ++i)
                     result |= ptr[i];
                 *((UInt *) out) = result;
             };
 
         case ReduceOp::And:
-            return [](const void *ptr_, uint32_t start, uint32_t end, void *out) {
+            return [](const void *ptr_, size_t start, size_t end, void *out) {
                 const UInt *ptr = (const UInt *) ptr_;
                 UInt result = (UInt) -1;
-                for (uint32_t i = start; i != end; ++i)
+                for (size_t i = start; i != end; ++i)
                     result &= ptr[i];
                 *((UInt *) out) = result;
             };
@@ -314,10 +507,10 @@ static Reduction jitc_reduce_create(VarType type, ReduceOp rtype) {
 }
 
 void jitc_reduce(JitBackend backend, VarType type, ReduceOp rtype, const void *ptr,
-                uint32_t size, void *out) {
+                size_t size, void *out) {
     ThreadState *ts = thread_state(backend);
 
-    jitc_log(Debug, "jit_reduce(" DRJIT_PTR ", type=%s, rtype=%s, size=%u)",
+    jitc_log(Debug, "jit_reduce(" DRJIT_PTR ", type=%s, rtype=%s, size=%zu)",
             (uintptr_t) ptr, type_name[(int) type],
             reduction_name[(int) rtype], size);
 
@@ -325,6 +518,7 @@ void jitc_reduce(JitBackend backend, VarType type, ReduceOp rtype, const void *p
 
     if (backend == JitBackend::CUDA) {
         scoped_set_context guard(ts->context);
+        uint32_t size_32 = jitc_cuda_size("jit_reduce", size);
         const Device &device = state.devices[ts->device];
         CUfunction func = jitc_cuda_reductions[(int) rtype][(int) type][device.id];
         if (!func)
@@ -335,36 +529,37 @@ void jitc_reduce(JitBackend backend, VarType type, ReduceOp rtype, const void *p
                  shared_size = thread_count * tsize,
                  block_count;
 
-        device.get_launch_config(&block_count, nullptr, size, thread_count);
+        device.get_launch_config(&block_count, nullptr, size_32, thread_count);
 
-        if (size <= 1024) {
+        if (size_32 <= 1024) {
             // This is a small array, do everything in just one reduction.
-            void *args[] = { &ptr, &size, &out };
+            void *args[] = { &ptr, &size_32, &out };
 
             jitc_submit_gpu(KernelType::Reduce, func, 1, thread_count,
-                            shared_size, ts->stream, args, nullptr, size);
+                            shared_size, ts->stream, args, nullptr, size_32);
         } else {
             void *temp = jitc_malloc(AllocType::Device, size_t(block_count) * tsize);
 
             // First reduction
-            void *args_1[] = { &ptr, &size, &temp };
+            void *args_1[] = { &ptr, &size_32, &temp };
 
             jitc_submit_gpu(KernelType::Reduce, func, block_count, thread_count,
-                            shared_size, ts->stream, args_1, nullptr, size);
+                            shared_size, ts->stream, args_1, nullptr, size_32);
 
             // Second reduction
             void *args_2[] = { &temp, &block_count, &out };
 
             jitc_submit_gpu(KernelType::Reduce, func, 1, thread_count,
-                            shared_size, ts->stream, args_2, nullptr, size);
+                            shared_size, ts->stream, args_2, nullptr, size_32);
 
             jitc_free(temp);
         }
     } else {
-        uint32_t block_size = size, blocks = 1;
+        size_t block_size = size;
+        uint32_t blocks = 1;
         if (pool_size() > 1) {
             block_size = DRJIT_POOL_BLOCK_SIZE;
-            blocks     = (size + block_size - 1) / block_size;
+            blocks     = (uint32_t) ((size + block_size - 1) / block_size);
         }
 
         void *target = out;
@@ -391,16 +586,16 @@ void jitc_reduce(JitBackend backend, VarType type, ReduceOp rtype, const void *p
 }
 
 /// 'All' reduction for boolean arrays
-bool jitc_all(JitBackend backend, uint8_t *values, uint32_t size) {
+bool jitc_all(JitBackend backend, uint8_t *values, size_t size) {
     /* When \c size is not a multiple of 4, the implementation will initialize up
        to 3 bytes beyond the end of the supplied range so that an efficient 32 bit
        reduction algorithm can be used. This is fine for allocations made using
        \ref jit_malloc(), which allow for this. */
 
-    uint32_t reduced_size = (size + 3) / 4,
-             trailing     = reduced_size * 4 - size;
+    size_t reduced_size = (size + 3) / 4,
+           trailing     = reduced_size * 4 - size;
 
-    jitc_log(Debug, "jit_all(" DRJIT_PTR ", size=%u)", (uintptr_t) values, size);
+    jitc_log(Debug, "jit_all(" DRJIT_PTR ", size=%zu)", (uintptr_t) values, size);
 
     if (trailing) {
         bool filler = true;
@@ -425,16 +620,16 @@ bool jitc_all(JitBackend backend, uint8_t *values, uint32_t size) {
 }
 
 /// 'Any' reduction for boolean arrays
-bool jitc_any(JitBackend backend, uint8_t *values, uint32_t size) {
+bool jitc_any(JitBackend backend, uint8_t *values, size_t size) {
     /* When \c size is not a multiple of 4, the implementation will initialize up
        to 3 bytes beyond the end of the supplied range so that an efficient 32 bit
        reduction algorithm can be used. This is fine for allocations made using
        \ref jit_malloc(), which allow for this. */
 
-    uint32_t reduced_size = (size + 3) / 4,
-             trailing     = reduced_size * 4 - size;
+    size_t reduced_size = (size + 3) / 4,
+           trailing     = reduced_size * 4 - size;
 
-    jitc_log(Debug, "jit_any(" DRJIT_PTR ", size=%u)", (uintptr_t) values, size);
+    jitc_log(Debug, "jit_any(" DRJIT_PTR ", size=%zu)", (uintptr_t) values, size);
 
     if (trailing) {
         bool filler = false;
@@ -459,17 +654,17 @@ bool jitc_any(JitBackend backend, uint8_t *values, uint32_t size) {
 }
 
 template <typename T>
-void sum_reduce_1(uint32_t start, uint32_t end, const void *in_, uint32_t index,
+void sum_reduce_1(size_t start, size_t end, const void *in_, uint32_t index,
                   void *scratch) {
     const T *in = (const T *) in_;
     T accum = T(0);
-    for (uint32_t i = start; i != end; ++i)
+    for (size_t i = start; i != end; ++i)
         accum += in[i];
     ((T*) scratch)[index] = accum;
 }
 
 template <typename T>
-void sum_reduce_2(uint32_t start, uint32_t end, const void *in_, void *out_,
+void sum_reduce_2(size_t start, size_t end, const void *in_, void *out_,
                   uint32_t index, const void *scratch, bool exclusive) {
     const T *in = (const T *) in_;
     T *out = (T *) out_;
@@ -481,13 +676,13 @@ void sum_reduce_2(uint32_t start, uint32_t end, const void *in_, void *out_,
         accum = T(0);
 
     if (exclusive) {
-        for (uint32_t i = start; i != end; ++i) {
+        for (size_t i = start; i != end; ++i) {
             T value = in[i];
             out[i] = accum;
             accum += value;
         }
     } else {
-        for (uint32_t i = start; i != end; ++i) {
+        for (size_t i = start; i != end; ++i) {
             T value = in[i];
             accum += value;
             out[i] = accum;
@@ -495,7 +690,7 @@ void sum_reduce_2(uint32_t start, uint32_t end, const void *in_, void *out_,
     }
 }
 
-void sum_reduce_1(VarType vt, uint32_t start, uint32_t end, const void *in, uint32_t index, void *scratch) {
+void sum_reduce_1(VarType vt, size_t start, size_t end, const void *in, uint32_t index, void *scratch) {
     switch (vt) {
         case VarType::UInt32:  sum_reduce_1<uint32_t>(start, end, in, index, scratch); break;
         case VarType::UInt64:  sum_reduce_1<uint64_t>(start, end, in, index, scratch); break;
@@ -506,7 +701,7 @@ void sum_reduce_1(VarType vt, uint32_t start, uint32_t end, const void *in, uint
     }
 }
 
-void sum_reduce_2(VarType vt, uint32_t start, uint32_t end, const void *in, void *out, uint32_t index, const void *scratch, bool exclusive) {
+void sum_reduce_2(VarType vt, size_t start, size_t end, const void *in, void *out, uint32_t index, const void *scratch, bool exclusive) {
     switch (vt) {
         case VarType::UInt32:  sum_reduce_2<uint32_t>(start, end, in, out, index, scratch, exclusive); break;
         case VarType::UInt64:  sum_reduce_2<uint64_t>(start, end, in, out, index, scratch, exclusive); break;
@@ -519,7 +714,7 @@ void sum_reduce_2(VarType vt, uint32_t start, uint32_t end, const void *in, void
 
 /// Exclusive prefix sum
 void jitc_prefix_sum(JitBackend backend, VarType vt, bool exclusive,
-               const void *in, uint32_t size, void *out) {
+               const void *in, size_t size, void *out) {
     if (size == 0)
         return;
     if (vt == VarType::Int32)
@@ -531,8 +726,9 @@ void jitc_prefix_sum(JitBackend backend, VarType vt, bool exclusive,
     if (backend == JitBackend::CUDA) {
         const Device &device = state.devices[ts->device];
         scoped_set_context guard(ts->context);
+        uint32_t size_32 = jitc_cuda_size("jit_prefix_sum", size);
 
-        if (size == 1) {
+        if (size_32 == 1) {
             if (exclusive) {
                 cuda_check(cuMemsetD8Async((CUdeviceptr) out, 0, isize, ts->stream));
             } else {
@@ -541,17 +737,17 @@ void jitc_prefix_sum(JitBackend backend, VarType vt, bool exclusive,
                                              (CUdeviceptr) in, isize,
                                              ts->stream));
             }
-        } else if ((isize == 4 && size <= 4096) || (isize == 8 && size < 2048)) {
+        } else if ((isize == 4 && size_32 <= 4096) || (isize == 8 && size_32 < 2048)) {
             // Kernel for small arrays
             uint32_t items_per_thread = isize == 8 ? 2 : 4,
-                     thread_count     = round_pow2((size + items_per_thread - 1)
+                     thread_count     = round_pow2((size_32 + items_per_thread - 1)
                                                     / items_per_thread),
                      shared_size      = thread_count * 2 * isize;
 
             jitc_log(Debug,
                      "jit_prefix_sum(" DRJIT_PTR " -> " DRJIT_PTR
                      ", type=%s, exclusive=%i, size=%u, type=small, threads=%u, shared=%u)",
-                     (uintptr_t) in, (uintptr_t) out, type_name[(int) vt], exclusive, size,
+                     (uintptr_t) in, (uintptr_t) out, type_name[(int) vt], exclusive, size_32,
                      thread_count, shared_size);
 
             CUfunction kernel =
@@ -561,16 +757,16 @@ void jitc_prefix_sum(JitBackend backend, VarType vt, bool exclusive,
             if (!kernel)
                 jitc_raise("jit_prefix_sum(): type %s is not supported!", type_name[(int) vt]);
 
-            void *args[] = { &in, &out, &size };
+            void *args[] = { &in, &out, &size_32 };
             jitc_submit_gpu(
                 KernelType::Other, kernel, 1,
-                thread_count, shared_size, ts->stream, args, nullptr, size);
+                thread_count, shared_size, ts->stream, args, nullptr, size_32);
         } else {
             // Kernel for large arrays
             uint32_t items_per_thread = isize == 8 ? 8 : 16,
                      thread_count     = 128,
                      items_per_block  = items_per_thread * thread_count,
-                     block_count      = (size + items_per_block - 1) / items_per_block,
+                     block_count      = (size_32 + items_per_block - 1) / items_per_block,
                      shared_size      = items_per_block * isize,
                      scratch_items    = block_count + 32;
 
@@ -578,7 +774,7 @@ void jitc_prefix_sum(JitBackend backend, VarType vt, bool exclusive,
                      "jit_prefix_sum(" DRJIT_PTR " -> " DRJIT_PTR
                      ", type=%s, exclusive=%i, size=%u, type=large, blocks=%u, threads=%u, "
                      "shared=%u, scratch=%zu)",
-                     (uintptr_t) in, (uintptr_t) out, type_name[(int) vt], exclusive, size,
+                     (uintptr_t) in, (uintptr_t) out, type_name[(int) vt], exclusive, size_32,
                      block_count, thread_count, shared_size, scratch_items * sizeof(uint64_t));
 
             CUfunction kernel =
@@ -603,7 +799,7 @@ void jitc_prefix_sum(JitBackend backend, VarType vt, bool exclusive,
                             args, nullptr, scratch_items);
 
             scratch += 32; // move beyond padding area
-            void *args_2[] = { &in, &out, &size, &scratch };
+            void *args_2[] = { &in, &out, &size_32, &scratch };
             jitc_submit_gpu(KernelType::Other, kernel, block_count,
                             thread_count, shared_size, ts->stream, args_2,
                             nullptr, scratch_items);
@@ -612,15 +808,16 @@ void jitc_prefix_sum(JitBackend backend, VarType vt, bool exclusive,
             jitc_free(scratch);
         }
     } else {
-        uint32_t block_size = size, blocks = 1;
+        size_t block_size = size;
+        uint32_t blocks = 1;
         if (pool_size() > 1) {
             block_size = DRJIT_POOL_BLOCK_SIZE;
-            blocks     = (size + block_size - 1) / block_size;
+            blocks     = (uint32_t) ((size + block_size - 1) / block_size);
         }
 
         jitc_log(Debug,
                 "jit_prefix_sum(" DRJIT_PTR " -> " DRJIT_PTR
-                ", size=%u, block_size=%u, blocks=%u)",
+                ", size=%zu, block_size=%zu, blocks=%u)",
                 (uintptr_t) in, (uintptr_t) out, size, block_size, blocks);
 
         void *scratch = nullptr;
@@ -631,8 +828,8 @@ void jitc_prefix_sum(JitBackend backend, VarType vt, bool exclusive,
             jitc_submit_cpu(
                 KernelType::Other,
                 [block_size, size, in, vt, scratch](uint32_t index) {
-                    uint32_t start = index * block_size,
-                             end = std::min(start + block_size, size);
+                    size_t start = index * block_size,
+                           end = std::min(start + block_size, size);
 
                     sum_reduce_1(vt, start, end, in, index, scratch);
                 },
@@ -644,8 +841,8 @@ void jitc_prefix_sum(JitBackend backend, VarType vt, bool exclusive,
         jitc_submit_cpu(
             KernelType::Other,
             [block_size, size, in, out, vt, scratch, exclusive](uint32_t index) {
-                uint32_t start = index * block_size,
-                         end = std::min(start + block_size, size);
+                size_t start = index * block_size,
+                       end = std::min(start + block_size, size);
 
                 sum_reduce_2(vt, start, end, in, out, index, scratch, exclusive);
             },
@@ -657,9 +854,14 @@ void jitc_prefix_sum(JitBackend backend, VarType vt, bool exclusive,
 }
 
 /// Mask compression
-uint32_t jitc_compress(JitBackend backend, const uint8_t *in, uint32_t size, uint32_t *out) {
-    if (size == 0)
+uint32_t jitc_compress(JitBackend backend, const uint8_t *in, size_t size_, uint32_t *out) {
+    if (size_ == 0)
         return 0;
+    else if (unlikely(size_ > 0xFFFFFFFF))
+        jitc_raise("jit_compress(): the output consists of 32 bit indices, "
+                   "hence the input must have fewer than 2^32 entries!");
+
+    uint32_t size = (uint32_t) size_;
 
     ThreadState *ts = thread_state(backend);
 
@@ -836,12 +1038,17 @@ static ProfilerRegion profiler_region_mkperm_phase_1("jit_mkperm_phase_1");
 static ProfilerRegion profiler_region_mkperm_phase_2("jit_mkperm_phase_2");
 
 /// Compute a permutation to reorder an integer array into a sorted configuration
-uint32_t jitc_mkperm(JitBackend backend, const uint32_t *ptr, uint32_t size,
+uint32_t jitc_mkperm(JitBackend backend, const uint32_t *ptr, size_t size_,
                      uint32_t bucket_count, uint32_t *perm, uint32_t *offsets) {
-    if (size == 0)
+    if (size_ == 0)
         return 0;
     else if (unlikely(bucket_count == 0))
         jitc_fail("jit_mkperm(): bucket_count cannot be zero!");
+    else if (unlikely(size_ > 0xFFFFFFFF))
+        jitc_raise("jit_mkperm(): the permutation consists of 32 bit indices, "
+                   "hence the input must have fewer than 2^32 entries!");
+
+    uint32_t size = (uint32_t) size_;
 
     ProfilerPhase profiler(profiler_region_mkperm);
     ThreadState *ts = thread_state(backend);
@@ -1108,13 +1315,13 @@ uint32_t jitc_mkperm(JitBackend backend, const uint32_t *ptr, uint32_t size,
     }
 }
 
-using BlockOp = void (*) (const void *ptr, void *out, uint32_t start, uint32_t end, uint32_t block_size);
+using BlockOp = void (*) (const void *ptr, void *out, size_t start, size_t end, uint32_t block_size);
 
 template <typename Value> static BlockOp jitc_block_copy_create() {
-    return [](const void *in_, void *out_, uint32_t start, uint32_t end, uint32_t block_size) {
+    return [](const void *in_, void *out_, size_t start, size_t end, uint32_t block_size) {
         const Value *in = (const Value *) in_ + start;
         Value *out = (Value *) out_ + start * block_size;
-        for (uint32_t i = start; i != end; ++i) {
+        for (size_t i = start; i != end; ++i) {
             Value value = *in++;
             for (uint32_t j = 0; j != block_size; ++j)
                 *out++ = value;
@@ -1123,10 +1330,10 @@ template <typename Value> static BlockOp jitc_block_copy_create() {
 }
 
 template <typename Value> static BlockOp jitc_block_sum_create() {
-    return [](const void *in_, void *out_, uint32_t start, uint32_t end, uint32_t block_size) {
+    return [](const void *in_, void *out_, size_t start, size_t end, uint32_t block_size) {
         const Value *in = (const Value *) in_ + start * block_size;
         Value *out = (Value *) out_ + start;
-        for (uint32_t i = start; i != end; ++i) {
+        for (size_t i = start; i != end; ++i) {
             Value sum = 0;
             for (uint32_t j = 0; j != block_size; ++j)
                 sum += *in++;
@@ -1171,18 +1378,18 @@ static VarType make_int_type_unsigned(VarType type) {
 
 /// Replicate individual input elements to larger blocks
 void jitc_block_copy(JitBackend backend, enum VarType type, const void *in, void *out,
-                    uint32_t size, uint32_t block_size) {
+                    size_t size, uint32_t block_size) {
     if (block_size == 0)
         jitc_raise("jit_block_copy(): block_size cannot be zero!");
 
     jitc_log(Debug,
             "jit_block_copy(" DRJIT_PTR " -> " DRJIT_PTR
-            ", type=%s, block_size=%u, size=%u)",
+            ", type=%s, block_size=%u, size=%zu)",
             (uintptr_t) in, (uintptr_t) out,
             type_name[(int) type], block_size, size);
 
     if (block_size == 1) {
-        uint32_t tsize = type_size[(int) type];
+        size_t tsize = type_size[(int) type];
         jitc_memcpy_async(backend, out, in, size * tsize);
         return;
     }
@@ -1193,24 +1400,25 @@ void jitc_block_copy(JitBackend backend, enum VarType type, const void *in, void
     if (backend == JitBackend::CUDA) {
         scoped_set_context guard(ts->context);
         const Device &device = state.devices[ts->device];
-        size *= block_size;
+        uint32_t size_32 = jitc_cuda_size("jit_block_copy", size * block_size);
 
         CUfunction func = jitc_cuda_block_copy[(int) type][device.id];
         if (!func)
             jitc_raise("jit_block_copy(): no existing kernel for type=%s!",
                       type_name[(int) type]);
 
-        uint32_t thread_count = std::min(size, 1024u),
-                 block_count  = (size + thread_count - 1) / thread_count;
+        uint32_t thread_count = std::min(size_32, 1024u),
+                 block_count  = (size_32 + thread_count - 1) / thread_count;
 
-        void *args[] = { &in, &out, &size, &block_size };
+        void *args[] = { &in, &out, &size_32, &block_size };
         jitc_submit_gpu(KernelType::Other, func, block_count, thread_count, 0,
-                        ts->stream, args, nullptr, size);
+                        ts->stream, args, nullptr, size_32);
     } else {
-        uint32_t work_unit_size = size, work_units = 1;
+        size_t work_unit_size = size;
+        uint32_t work_units = 1;
         if (pool_size() > 1) {
             work_unit_size = DRJIT_POOL_BLOCK_SIZE;
-            work_units     = (size + work_unit_size - 1) / work_unit_size;
+            work_units     = (uint32_t) ((size + work_unit_size - 1) / work_unit_size);
         }
 
         BlockOp op = jitc_block_copy_create(type);
@@ -1218,8 +1426,8 @@ void jitc_block_copy(JitBackend backend, enum VarType type, const void *in, void
         jitc_submit_cpu(
             KernelType::Other,
             [in, out, op, work_unit_size, size, block_size](uint32_t index) {
-                uint32_t start = index * work_unit_size,
-                         end = std::min(start + work_unit_size, size);
+                size_t start = index * work_unit_size,
+                       end = std::min(start + work_unit_size, size);
 
                 op(in, out, start, end, block_size);
             },
@@ -1231,18 +1439,18 @@ void jitc_block_copy(JitBackend backend, enum VarType type, const void *in, void
 
 /// Sum over elements within blocks
 void jitc_block_sum(JitBackend backend, enum VarType type, const void *in, void *out,
-                    uint32_t size, uint32_t block_size) {
+                    size_t size, uint32_t block_size) {
     if (block_size == 0)
         jitc_raise("jit_block_sum(): block_size cannot be zero!");
 
     jitc_log(Debug,
             "jit_block_sum(" DRJIT_PTR " -> " DRJIT_PTR
-            ", type=%s, block_size=%u, size=%u)",
+            ", type=%s, block_size=%u, size=%zu)",
             (uintptr_t) in, (uintptr_t) out,
             type_name[(int) type], block_size, size);
 
-    uint32_t tsize = type_size[(int) type];
-    size_t out_size = size * tsize;
+    size_t tsize = type_size[(int) type],
+           out_size = size * tsize;
 
     if (block_size == 1) {
         jitc_memcpy_async(backend, out, in, out_size);
@@ -1256,25 +1464,26 @@ void jitc_block_sum(JitBackend backend, enum VarType type, const void *in, void
         scoped_set_context guard(ts->context);
         const Device &device = state.devices[ts->device];
 
-        size *= block_size;
+        uint32_t size_32 = jitc_cuda_size("jit_block_sum", size * block_size);
 
         CUfunction func = jitc_cuda_block_sum[(int) type][device.id];
         if (!func)
             jitc_raise("jit_block_sum(): no existing kernel for type=%s!",
                       type_name[(int) type]);
 
-        uint32_t thread_count = std::min(size, 1024u),
-                 block_count  = (size + thread_count - 1) / thread_count;
+        uint32_t thread_count = std::min(size_32, 1024u),
+                 block_count  = (size_32 + thread_count - 1) / thread_count;
 
-        void *args[] = { &in, &out, &size, &block_size };
+        void *args[] = { &in, &out, &size_32, &block_size };
         cuda_check(cuMemsetD8Async((CUdeviceptr) out, 0, out_size, ts->stream));
         jitc_submit_gpu(KernelType::Other, func, block_count, thread_count, 0,
-                        ts->stream, args, nullptr, size);
+                        ts->stream, args, nullptr, size_32);
     } else {
-        uint32_t work_unit_size = size, work_units = 1;
+        size_t work_unit_size = size;
+        uint32_t work_units = 1;
         if (pool_size() > 1) {
             work_unit_size = DRJIT_POOL_BLOCK_SIZE;
-            work_units     = (size + work_unit_size - 1) / work_unit_size;
+            work_units     = (uint32_t) ((size + work_unit_size - 1) / work_unit_size);
         }
 
         BlockOp op = jitc_block_sum_create(type);
@@ -1282,8 +1491,8 @@ void jitc_block_sum(JitBackend backend, enum VarType type, const void *in, void
         jitc_submit_cpu(
             KernelType::Other,
             [in, out, op, work_unit_size, size, block_size](uint32_t index) {
-                uint32_t start = index * work_unit_size,
-                         end = std::min(start + work_unit_size, size);
+                size_t start = index * work_unit_size,
+                       end = std::min(start + work_unit_size, size);
 
                 op(in, out, start, end, block_size);
             },
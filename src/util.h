@@ -16,29 +16,49 @@
 extern const char *reduction_name[(int) ReduceOp::Count];
 
 /// Fill a device memory region with constants of a given type
-extern void jitc_memset_async(JitBackend backend, void *ptr, uint32_t size,
+extern void jitc_memset_async(JitBackend backend, void *ptr, size_t size,
                               uint32_t isize, const void *src);
 
+/**
+ * \brief Allocate device/host-asynchronous memory for \c size elements of
+ * size \c isize and zero-initialize it
+ *
+ * On the LLVM backend, large regions are backed by the OS zero page instead
+ * of being filled explicitly: fresh mappings need no work at all, and
+ * recycled ones are reset by asynchronously discarding their pages. Physical
+ * memory is only committed for pages that are subsequently written.
+ */
+extern void *jitc_calloc_async(JitBackend backend, size_t size,
+                                uint32_t isize);
+
+/// Asynchronously unmap a memory region once all prior work has finished
+extern void jitc_munmap_async(JitBackend backend, void *ptr, size_t size);
+
+#if !defined(_WIN32)
+/// Write a memory region to a file descriptor, handling partial writes
+extern bool jitc_write_all(int fd, const uint8_t *ptr, size_t size);
+#endif
+
 /// Reduce the given array to a single value
 extern void jitc_reduce(JitBackend backend, VarType type, ReduceOp rtype,
-                        const void *ptr, uint32_t size, void *out);
+                        const void *ptr, size_t size, void *out);
 
 /// 'All' reduction for boolean arrays
-extern bool jitc_all(JitBackend backend, uint8_t *values, uint32_t size);
+extern bool jitc_all(JitBackend backend, uint8_t *values, size_t size);
 
 /// 'Any' reduction for boolean arrays
-extern bool jitc_any(JitBackend backend, uint8_t *values, uint32_t size);
+extern bool jitc_any(JitBackend backend, uint8_t *values, size_t size);
 
 /// Exclusive prefix sum
 extern void jitc_prefix_sum(JitBackend backend, VarType vt, bool exclusive,
-                            const void *in, uint32_t size, void *out);
+                            const void *in, size_t size, void *out);
 
 /// Mask compression
-extern uint32_t jitc_compress(JitBackend backend, const uint8_t *in, uint32_t size,
+extern uint32_t jitc_compress(JitBackend backend, const uint8_t *in, size_t size,
                               uint32_t *out);
 
 /// Compute a permutation to reorder an integer array into discrete groups
-extern uint32_t jitc_mkperm(JitBackend backend, const uint32_t *values, uint32_t size,
+extern uint32_t jitc_mkperm(JitBackend backend, const uint32_t *values, size_t size,
                             uint32_t bucket_count, uint32_t *perm,
                             uint32_t *offsets);
 
@@ -50,11 +70,11 @@ extern void jitc_memcpy_async(JitBackend backend, void *dst, const void *src, si
 
 /// Replicate individual input elements to larger blocks
 extern void jitc_block_copy(JitBackend backend, enum VarType type, const void *in,
-                            void *out, uint32_t size, uint32_t block_size);
+                            void *out, size_t size, uint32_t block_size);
 
 /// Sum over elements within blocks
 extern void jitc_block_sum(JitBackend backend, enum VarType type, const void *in,
-                           void *out, uint32_t size, uint32_t block_size);
+                           void *out, size_t size, uint32_t block_size);
 
 /// Asynchronously update a single element in memory
 extern void jitc_poke(JitBackend backend, void *dst, const void *src, uint32_t size);
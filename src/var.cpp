@@ -15,6 +15,16 @@
 #include "op.h"
 #include "registry.h"
 
+#if !defined(_WIN32)
+#  include <fcntl.h>
+#  include <unistd.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#endif
+
+/// Granularity of I/O requests issued by jitc_var_write_file()
+#define DRJIT_FILE_CHUNK_SIZE (64 * 1024 * 1024)
+
 // When debugging via valgrind, this will make iterator invalidation more obvious
 // #define DRJIT_VALGRIND 1
 
@@ -90,9 +100,6 @@ const char *var_kind_name[(int) VarKind::Count] {
     // An evaluated node representing data
     "data",
 
-    // Legacy string-based IR statement
-    "stmt",
-
     // A literal constant
     "literal",
 
@@ -135,7 +142,7 @@ const char *var_kind_name[(int) VarKind::Count] {
     // Fast approximations
     "rcp", "rsqrt",
 
-    // Multi-function generator (CUDA)
+    // Transcendental functions (CUDA: multi-function generator, LLVM: polynomials)
     "sin", "cos", "exp2", "log2",
 
     // Casts
@@ -169,21 +176,62 @@ const char *var_kind_name[(int) VarKind::Count] {
     "trace_ray",
 
     // Extract a component from an operation that produced multiple results
-    "extract"
+    "extract",
+
+    // Copy a variable into a new register (e.g. to change its size)
+    "copy",
+
+    // Markers denoting the start, condition, and end of a recorded loop
+    "loop_start", "loop_cond", "loop_end",
+
+    // Phi node representing the state of a loop variable (LLVM)
+    "loop_phi"
 };
 
 
 /// Temporary string buffer for miscellaneous variable-related tasks
 StringBuffer var_buffer(0);
 
-#define jitc_check_size(name, size)                                            \
-    if (unlikely(size > 0xFFFFFFFF))                                           \
+#define jitc_check_size(name, backend, size)                                   \
+    if (unlikely(backend == JitBackend::CUDA && size > 0xFFFFFFFF))            \
         jitc_raise("%s(): tried to create an array with %zu entries, which "   \
-                   "exceeds the limit of 2^32 == 4294967296 entries.",         \
-                   name, size);
+                   "exceeds the CUDA backend's limit of 2^32 == 4294967296 "   \
+                   "entries (use the LLVM backend for larger arrays).",        \
+                   name, (size_t) size);
 
-/// Cleanup handler, called when the internal/external reference count reaches zero
-void jitc_var_free(uint32_t index, Variable *v) {
+/**
+ * Reference count decrements that jitc_var_free() still needs to perform.
+ * Each entry stores a variable index (upper 32 bits) and whether the side
+ * effect reference count should be decremented (bit 0). Releasing long
+ * dependency chains through this stack instead of recursion keeps the call
+ * stack depth constant.
+ */
+static thread_local std::vector<uint64_t> jitc_var_free_stack;
+
+/// Decrease the reference count, returns 'true' if the variable should be freed
+static inline bool jitc_var_dec_ref_impl(uint32_t index, Variable *v) noexcept(true) {
+    if (unlikely(v->ref_count == 0))
+        jitc_fail("jit_var_dec_ref(): variable r%u has no external references!", index);
+
+    jitc_trace("jit_var_dec_ref(r%u): %u", index, (uint32_t) v->ref_count - 1);
+    v->ref_count--;
+
+    return v->ref_count == 0 && v->ref_count_se == 0;
+}
+
+/// Decrease the side effect reference count, returns 'true' if the variable should be freed
+static inline bool jitc_var_dec_ref_se_impl(uint32_t index, Variable *v) noexcept(true) {
+    if (unlikely(v->ref_count_se == 0))
+        jitc_fail("jit_var_dec_ref_se(): variable r%u has no side effect references!", index);
+
+    jitc_trace("jit_var_dec_ref_se(r%u): %u", index, (uint32_t) v->ref_count_se - 1);
+    v->ref_count_se--;
+
+    return v->ref_count == 0 && v->ref_count_se == 0;
+}
+
+/// Release a single variable, and push its dependencies onto 'jitc_var_free_stack'
+static void jitc_var_free_one(uint32_t index, Variable *v) {
     jitc_trace("jit_var_free(r%u)", index);
 
     if (v->is_data()) {
@@ -195,10 +243,6 @@ void jitc_var_free(uint32_t index, Variable *v) {
         jitc_lvn_drop(index, v);
     }
 
-    // Free IR string if needed
-    if (unlikely(v->free_stmt))
-        free(v->stmt);
-
     uint32_t dep[4];
     bool write_ptr = v->write_ptr;
     memcpy(dep, v->dep, sizeof(uint32_t) * 4);
@@ -239,29 +283,166 @@ void jitc_var_free(uint32_t index, Variable *v) {
         free(extra.label);
     }
 
-    // Remove from hash table
+    // Remove from the variable table
     state.variables.erase(index);
 
-#if defined(DRJIT_VALGRIND)
-    VariableMap var_new(state.variables);
-    state.variables.swap(var_new);
-#endif
-
+    // Decrease reference count of dependencies (pushed in reverse order so
+    // that they are released in the same order as a recursive traversal)
+    std::vector<uint64_t> &stack = jitc_var_free_stack;
     if (likely(!write_ptr)) {
-        // Decrease reference count of dependencies
-        for (int i = 0; i < 4; ++i)
-            jitc_var_dec_ref(dep[i]);
-    } else {
-        jitc_var_dec_ref_se(dep[3]);
+        for (int i = 3; i >= 0; --i) {
+            if (dep[i])
+                stack.push_back((uint64_t) dep[i] << 32);
+        }
+    } else if (dep[3]) {
+        stack.push_back(((uint64_t) dep[3] << 32) | 1);
+    }
+}
+
+/// Cleanup handler, called when the internal/external reference count reaches zero
+static void jitc_var_free(uint32_t index, Variable *v) {
+    /* Callbacks invoked by jitc_var_free_one() may release further variables
+       and re-enter this function. Such nested calls only process the entries
+       that they added themselves. */
+    std::vector<uint64_t> &stack = jitc_var_free_stack;
+    size_t base = stack.size();
+
+    jitc_var_free_one(index, v);
+
+    while (stack.size() > base) {
+        uint64_t entry = stack.back();
+        stack.pop_back();
+
+        uint32_t index_2 = (uint32_t) (entry >> 32);
+        Variable *v2 = jitc_var(index_2);
+        bool free_2 = (entry & 1) ? jitc_var_dec_ref_se_impl(index_2, v2)
+                                  : jitc_var_dec_ref_impl(index_2, v2);
+        if (free_2)
+            jitc_var_free_one(index_2, v2);
     }
 }
 
 /// Access a variable by ID, terminate with an error if it doesn't exist
 Variable *jitc_var(uint32_t index) {
-    auto it = state.variables.find(index);
-    if (unlikely(it == state.variables.end()))
+    Variable *v = state.variables.find(index);
+    if (unlikely(!v))
         jitc_fail("jit_var(r%u): unknown variable!", index);
-    return &it.value();
+    return v;
+}
+
+/// Counter for the epochs of graph traversals (see jitc_var_epoch_new())
+static uint32_t jitc_var_epoch = 0;
+
+uint32_t jitc_var_epoch_new(uint32_t count) {
+    if (unlikely(jitc_var_epoch > 0xFFFFFFFFu - count)) {
+        // The counter wrapped around, clear all marks
+        state.variables.for_each(
+            [](uint32_t, Variable &v) { v.cold().visit_epoch = 0; });
+        jitc_var_epoch = 0;
+    }
+
+    uint32_t epoch = jitc_var_epoch + 1;
+    jitc_var_epoch += count;
+    return epoch;
+}
+
+using VariableChunkAllocator =
+    aligned_allocator<VariableTable::Chunk, sizeof(VariableTable::Chunk)>;
+
+static_assert((sizeof(VariableTable::Chunk) &
+               (sizeof(VariableTable::Chunk) - 1)) == 0,
+              "VariableTable::Chunk: size must be a power of two!");
+
+Variable *VariableTable::insert(uint32_t index, const Variable &v) {
+    uint32_t chunk_id = index >> ChunkShift,
+             slot = index & (ChunkSize - 1);
+
+    if (chunk_id >= m_chunks.size()) {
+        /* The previous chunk was exempt from release while it received new
+           variables (see erase()). Catch up on this if it is empty now. */
+        if (!m_chunks.empty() && m_chunks.back() && m_chunk_size.back() == 0)
+            release((uint32_t) m_chunks.size() - 1);
+
+        m_chunks.resize(chunk_id + 1, nullptr);
+        m_chunk_size.resize(chunk_id + 1, 0);
+    }
+
+    Chunk *chunk = m_chunks[chunk_id];
+    if (!chunk) {
+        if (!m_free.empty()) {
+            // All entries of released chunks are already marked as invalid
+            chunk = m_free.back();
+            m_free.pop_back();
+        } else {
+            chunk = VariableChunkAllocator().allocate(1);
+            memset((void *) chunk->hot, 0, sizeof(chunk->hot));
+        }
+        m_chunks[chunk_id] = chunk;
+    }
+
+    Variable *vo = &chunk->hot[slot];
+    if (unlikely(vo->kind != (uint32_t) VarKind::Invalid))
+        return nullptr;
+
+    *vo = v;
+    memset(&chunk->cold[slot], 0, sizeof(VariableCold));
+    m_chunk_size[chunk_id]++;
+    m_size++;
+
+    return vo;
+}
+
+void VariableTable::erase(uint32_t index) {
+    uint32_t chunk_id = index >> ChunkShift;
+
+    m_chunks[chunk_id]->hot[index & (ChunkSize - 1)].kind =
+        (uint32_t) VarKind::Invalid;
+    m_size--;
+
+    /* Release chunks that no longer contain any variables. The last chunk
+       is exempt, since it receives newly created variables. Releasing it
+       would cause churn when variables are repeatedly created and freed. */
+    if (--m_chunk_size[chunk_id] == 0 && chunk_id + 1 != m_chunks.size())
+        release(chunk_id);
+}
+
+void VariableTable::release(uint32_t chunk_id) {
+    Chunk *chunk = m_chunks[chunk_id];
+    m_chunks[chunk_id] = nullptr;
+
+#if !defined(DRJIT_VALGRIND)
+    // Keep a few chunks around, since more will be needed soon
+    if (m_free.size() < FreeListSize) {
+        m_free.push_back(chunk);
+        return;
+    }
+#endif
+
+    VariableChunkAllocator().deallocate(chunk, 1);
+}
+
+size_t VariableTable::memory() const {
+    size_t chunk_count = m_free.size();
+    for (Chunk *chunk : m_chunks)
+        chunk_count += chunk != nullptr;
+
+    return chunk_count * sizeof(Chunk) +
+           m_chunks.capacity() * sizeof(Chunk *) +
+           m_chunk_size.capacity() * sizeof(uint32_t);
+}
+
+void VariableTable::clear() {
+    for (Chunk *chunk : m_chunks) {
+        if (chunk)
+            VariableChunkAllocator().deallocate(chunk, 1);
+    }
+    for (Chunk *chunk : m_free)
+        VariableChunkAllocator().deallocate(chunk, 1);
+
+    m_chunks.clear();
+    m_chunk_size.clear();
+    m_free.clear();
+    m_size = 0;
 }
 
 /// Increase the external reference count of a given variable
@@ -292,13 +473,7 @@ void jitc_var_inc_ref_se(uint32_t index) noexcept(true) {
 
 /// Decrease the external reference count of a given variable
 void jitc_var_dec_ref(uint32_t index, Variable *v) noexcept(true) {
-    if (unlikely(v->ref_count == 0))
-        jitc_fail("jit_var_dec_ref(): variable r%u has no external references!", index);
-
-    jitc_trace("jit_var_dec_ref(r%u): %u", index, (uint32_t) v->ref_count - 1);
-    v->ref_count--;
-
-    if (v->ref_count == 0 && v->ref_count_se == 0)
+    if (jitc_var_dec_ref_impl(index, v))
         jitc_var_free(index, v);
 }
 
@@ -310,13 +485,7 @@ void jitc_var_dec_ref(uint32_t index) noexcept(true) {
 
 /// Decrease the side effect reference count of a given variable
 void jitc_var_dec_ref_se(uint32_t index, Variable *v) noexcept(true) {
-    if (unlikely(v->ref_count_se == 0))
-        jitc_fail("jit_var_dec_ref_se(): variable r%u has no side effect references!", index);
-
-    jitc_trace("jit_var_dec_ref_se(r%u): %u", index, (uint32_t) v->ref_count_se - 1);
-    v->ref_count_se--;
-
-    if (v->ref_count == 0 && v->ref_count_se == 0)
+    if (jitc_var_dec_ref_se_impl(index, v))
         jitc_var_free(index, v);
 }
 
@@ -429,10 +598,55 @@ void jitc_value_print(const Variable *v, bool graphviz = false) {
     #undef JIT_LITERAL_PRINT
 }
 
+/**
+ * Bring the operands of commutative operations into a canonical order (lower
+ * variable index first) and rewrite 'a > b' and 'a >= b' into 'b < a' and
+ * 'b <= a'. Equivalent expressions then map to the same LVN entry and
+ * generate identical kernel code.
+ */
+static void jitc_var_canonicalize(Variable &v) {
+    switch ((VarKind) v.kind) {
+        case VarKind::Gt:
+            v.kind = VarKind::Lt;
+            std::swap(v.dep[0], v.dep[1]);
+            break;
+
+        case VarKind::Ge:
+            v.kind = VarKind::Le;
+            std::swap(v.dep[0], v.dep[1]);
+            break;
+
+        case VarKind::And:
+        case VarKind::Or:
+            // Masking operations ('x & mask') are not commutative
+            if (jitc_var(v.dep[0])->type != jitc_var(v.dep[1])->type)
+                break;
+            [[fallthrough]];
+
+        case VarKind::Add:
+        case VarKind::Mul:
+        case VarKind::Mulhi:
+        case VarKind::Fma: // only the first two operands
+        case VarKind::Min:
+        case VarKind::Max:
+        case VarKind::Eq:
+        case VarKind::Neq:
+        case VarKind::Xor:
+            if (v.dep[0] > v.dep[1])
+                std::swap(v.dep[0], v.dep[1]);
+            break;
+
+        default:
+            break;
+    }
+}
+
 /// Append the given variable to the instruction trace and return its ID
 uint32_t jitc_var_new(Variable &v, bool disable_lvn) {
     ThreadState *ts = thread_state(v.backend);
 
+    jitc_var_canonicalize(v);
+
     bool lvn = !disable_lvn && (VarType) v.type != VarType::Void &&
                !v.is_data() &&
                jit_flag(JitFlag::ValueNumbering);
@@ -450,23 +664,16 @@ uint32_t jitc_var_new(Variable &v, bool disable_lvn) {
     Variable *vo;
 
     if (likely(!lvn || lvn_key_inserted)) {
-        #if defined(DRJIT_VALGRIND)
-            VariableMap var_new(state.variables);
-            state.variables.swap(var_new);
-        #endif
-
         // .. nope, it is new.
-        VariableMap::iterator var_it;
-        bool var_inserted = false;
+        vo = nullptr;
         do {
             index = state.variable_index++;
 
             if (unlikely(index == 0)) // overflow
                 continue;
 
-            std::tie(var_it, var_inserted) =
-                state.variables.try_emplace(index, v);
-        } while (!var_inserted);
+            vo = state.variables.insert(index, v);
+        } while (!vo);
 
         state.variable_watermark = std::max(state.variable_watermark,
                                             (uint32_t) state.variables.size());
@@ -474,17 +681,12 @@ uint32_t jitc_var_new(Variable &v, bool disable_lvn) {
         if (lvn_key_inserted)
             key_it.value() = index;
 
-        vo = &var_it.value();
-
         if (unlikely(ts->prefix)) {
             vo->extra = true;
             state.extra[index].label = strdup(ts->prefix);
         }
     } else {
         // .. found a match! Deallocate 'v'.
-        if (v.free_stmt)
-            free(v.stmt);
-
         if (likely(!v.write_ptr)) {
             for (int i = 0; i < 4; ++i)
                 jitc_var_dec_ref(v.dep[i]);
@@ -501,7 +703,7 @@ uint32_t jitc_var_new(Variable &v, bool disable_lvn) {
         var_buffer.clear();
         var_buffer.fmt("jit_var_new(%s r%u", type_name[v.type], index);
         if (v.size > 1)
-            var_buffer.fmt("[%u]", v.size);
+            var_buffer.fmt("[%zu]", (size_t) v.size);
 
         uint32_t n_dep = 0;
         for (int i = 0; i < 4; ++i) {
@@ -519,8 +721,6 @@ uint32_t jitc_var_new(Variable &v, bool disable_lvn) {
             jitc_value_print(&v);
         } else if (v.is_data()) {
             var_buffer.fmt(DRJIT_PTR, (uintptr_t) v.data);
-        } else if (v.is_stmt()) {
-            var_buffer.put(v.stmt, strlen(v.stmt));
         } else if (v.is_node()) {
             var_buffer.fmt("\"%s\" operation", var_kind_name[v.kind]);
         }
@@ -550,7 +750,7 @@ uint32_t jitc_var_literal(JitBackend backend, VarType type, const void *value,
     if (unlikely(size == 0))
         return 0;
 
-    jitc_check_size("jit_var_literal", size);
+    jitc_check_size("jit_var_literal", backend, size);
 
     /* When initializing a value pointer array while recording a virtual
        function, we can leverage the already available `self` variable
@@ -569,17 +769,25 @@ uint32_t jitc_var_literal(JitBackend backend, VarType type, const void *value,
         memcpy(&v.literal, value, type_size[(uint32_t) type]);
         v.kind = (uint32_t) VarKind::Literal;
         v.type = (uint32_t) type;
-        v.size = (uint32_t) size;
+        v.size = size;
         v.backend = (uint32_t) backend;
 
         return jitc_var_new(v);
     } else {
         uint32_t isize = type_size[(int) type];
-        void *data =
-            jitc_malloc(backend == JitBackend::CUDA ? AllocType::Device
-                                                    : AllocType::HostAsync,
-                        size * (size_t) isize);
-        jitc_memset_async(backend, data, (uint32_t) size, isize, value);
+        uint64_t zero = 0;
+        void *data;
+
+        if (memcmp(value, &zero, isize) == 0) {
+            data = jitc_calloc_async(backend, size, isize);
+        } else {
+            data = jitc_malloc(backend == JitBackend::CUDA
+                                   ? AllocType::Device
+                                   : AllocType::HostAsync,
+                               size * (size_t) isize);
+            jitc_memset_async(backend, data, size, isize, value);
+        }
+
         return jitc_var_mem_map(backend, type, data, size, 1);
     }
 }
@@ -618,12 +826,13 @@ uint32_t jitc_var_counter(JitBackend backend, size_t size,
         return jitc_var_literal(backend, VarType::UInt32, &zero, 1, 0);
     }
 
-    jitc_check_size("jit_var_counter", size);
+    jitc_check_size("jit_var_counter", backend, size);
     Variable v;
     v.kind = VarKind::Counter;
     v.backend = (uint32_t) backend;
-    v.type = (uint32_t) VarType::UInt32;
-    v.size = (uint32_t) size;
+    // Counters in arrays with 2^32 or more entries are 64 bit
+    v.type = (uint32_t) (size > 0xFFFFFFFF ? VarType::UInt64 : VarType::UInt32);
+    v.size = size;
     return jitc_var_new(v);
 }
 
@@ -644,11 +853,8 @@ uint32_t jitc_var_wrap_vcall(uint32_t index) {
     }
 
     Variable v2;
-    v2.stmt = (char *) (((JitBackend) v->backend == JitBackend::CUDA)
-                            ? "mov.$t0 $r0, $r1"
-                            : "$r0 = bitcast <$w x $t0> $r1 to <$w x $t0>");
     v2.backend = v->backend;
-    v2.kind = (uint32_t) VarKind::Stmt;
+    v2.kind = (uint32_t) VarKind::Copy;
     v2.type = v->type;
     v2.size = 1;
     v2.placeholder = v2.vcall_iface = 1;
@@ -669,71 +875,6 @@ void jitc_new_scope(JitBackend backend) {
     thread_state(backend)->scope = scope_index;
 }
 
-uint32_t jitc_var_stmt(JitBackend backend, VarType vt, const char *stmt,
-                       int stmt_static, uint32_t n_dep,
-                       const uint32_t *dep) {
-    uint32_t size = n_dep == 0 ? 1 : 0;
-    bool dirty = false, uninitialized = false, placeholder = false;
-    Variable *v[4] { };
-
-    if (unlikely(n_dep > 4))
-        jitc_fail("jit_var_stmt(): 0-4 dependent variables supported!");
-
-    for (uint32_t i = 0; i < n_dep; ++i) {
-        if (likely(dep[i])) {
-            Variable *vi = jitc_var(dep[i]);
-            size = std::max(size, vi->size);
-            dirty |= vi->is_dirty();
-            placeholder |= (bool) vi->placeholder;
-            v[i] = vi;
-        } else {
-            uninitialized = true;
-        }
-    }
-
-    if (unlikely(size == 0)) {
-        if (!stmt_static)
-            free((char *) stmt);
-        return 0;
-    } else if (unlikely(uninitialized)) {
-        jitc_raise("jit_var_stmt(): arithmetic involving an "
-                   "uninitialized variable!");
-    }
-
-    for (uint32_t i = 0; i < n_dep; ++i) {
-        if (v[i]->size != size && v[i]->size != 1)
-            jitc_raise("jit_var_stmt(): arithmetic involving arrays of "
-                       "incompatible size!");
-    }
-
-    if (dirty) {
-        jitc_eval(thread_state(backend));
-        dirty = false;
-        for (uint32_t i = 0; i < n_dep; ++i) {
-            v[i] = jitc_var(dep[i]);
-            dirty |= v[i]->is_dirty();
-        }
-        if (dirty)
-            jitc_raise("jit_var_stmt(): variable remains dirty following evaluation!");
-    }
-
-    Variable v2;
-    for (uint32_t i = 0; i < n_dep; ++i) {
-        v2.dep[i] = dep[i];
-        jitc_var_inc_ref(dep[i], v[i]);
-    }
-
-    v2.kind = (uint32_t) VarKind::Stmt;
-    v2.stmt = stmt_static ? (char *) stmt : strdup(stmt);
-    v2.size = size;
-    v2.type = (uint32_t) vt;
-    v2.backend = (uint32_t) backend;
-    v2.free_stmt = stmt_static == 0;
-    v2.placeholder = placeholder;
-
-    return jitc_var_new(v2);
-}
-
 /**
  * \brie Create a new IR node
  *
@@ -745,7 +886,7 @@ uint32_t jitc_var_stmt(JitBackend backend, VarType vt, const char *stmt,
  *   evaluated, and the function checks that this worked as expected.
  */
 uint32_t jitc_var_new_node_0(JitBackend backend, VarKind kind, VarType vt,
-                             uint32_t size, bool placeholder, uint64_t payload) {
+                             size_t size, bool placeholder, uint64_t payload) {
 
     Variable v;
     v.literal = payload;
@@ -759,11 +900,11 @@ uint32_t jitc_var_new_node_0(JitBackend backend, VarKind kind, VarType vt,
 }
 
 uint32_t jitc_var_new_node_1(JitBackend backend, VarKind kind, VarType vt,
-                             uint32_t size, bool placeholder,
+                             size_t size, bool placeholder,
                              uint32_t a0, Variable *v0, uint64_t payload) {
 
     if (unlikely(v0->is_dirty())) {
-        jitc_eval(thread_state(backend));
+        jitc_eval_dirty(thread_state(backend), &a0, 1);
         v0 = jitc_var(a0);
         if (v0->is_dirty())
             jitc_fail("jit_var_new_node(): variable remains dirty following "
@@ -785,12 +926,13 @@ uint32_t jitc_var_new_node_1(JitBackend backend, VarKind kind, VarType vt,
 }
 
 uint32_t jitc_var_new_node_2(JitBackend backend, VarKind kind, VarType vt,
-                             uint32_t size, bool placeholder,
+                             size_t size, bool placeholder,
                              uint32_t a0, Variable *v0,
                              uint32_t a1, Variable *v1, uint64_t payload) {
 
     if (unlikely(v0->is_dirty() || v1->is_dirty())) {
-        jitc_eval(thread_state(backend));
+        uint32_t dep[2] = { a0, a1 };
+        jitc_eval_dirty(thread_state(backend), dep, 2);
         v0 = jitc_var(a0); v1 = jitc_var(a1);
         if (v0->is_dirty() || v1->is_dirty())
             jitc_fail("jit_var_new_node(): variable remains dirty!");
@@ -813,11 +955,12 @@ uint32_t jitc_var_new_node_2(JitBackend backend, VarKind kind, VarType vt,
 }
 
 uint32_t jitc_var_new_node_3(JitBackend backend, VarKind kind, VarType vt,
-                             uint32_t size, bool placeholder,
+                             size_t size, bool placeholder,
                              uint32_t a0, Variable *v0, uint32_t a1, Variable *v1,
                              uint32_t a2, Variable *v2, uint64_t payload) {
     if (unlikely(v0->is_dirty() || v1->is_dirty() || v2->is_dirty())) {
-        jitc_eval(thread_state(backend));
+        uint32_t dep[3] = { a0, a1, a2 };
+        jitc_eval_dirty(thread_state(backend), dep, 3);
         v0 = jitc_var(a0); v1 = jitc_var(a1); v2 = jitc_var(a2);
         if (v0->is_dirty() || v1->is_dirty() || v2->is_dirty())
             jitc_fail("jit_var_new_node(): variable remains dirty!");
@@ -842,12 +985,13 @@ uint32_t jitc_var_new_node_3(JitBackend backend, VarKind kind, VarType vt,
 }
 
 uint32_t jitc_var_new_node_4(JitBackend backend, VarKind kind, VarType vt,
-                             uint32_t size, bool placeholder,
+                             size_t size, bool placeholder,
                              uint32_t a0, Variable *v0, uint32_t a1, Variable *v1,
                              uint32_t a2, Variable *v2, uint32_t a3, Variable *v3,
                              uint64_t payload) {
     if (unlikely(v0->is_dirty() || v1->is_dirty() || v2->is_dirty() || v3->is_dirty())) {
-        jitc_eval(thread_state(backend));
+        uint32_t dep[4] = { a0, a1, a2, a3 };
+        jitc_eval_dirty(thread_state(backend), dep, 4);
         v0 = jitc_var(a0); v1 = jitc_var(a1); v2 = jitc_var(a2); v3 = jitc_var(a3);
         if (v0->is_dirty() || v1->is_dirty() || v2->is_dirty() || v3->is_dirty())
             jitc_fail("jit_var_new_node(): variable remains dirty!");
@@ -1004,15 +1148,14 @@ static void jitc_raise_placeholder_error(const char *func, uint32_t index) {
 
 /// Schedule a variable \c index for future evaluation via \ref jit_eval()
 int jitc_var_schedule(uint32_t index) {
-    auto it = state.variables.find(index);
-    if (unlikely(it == state.variables.end()))
+    Variable *v = state.variables.find(index);
+    if (unlikely(!v))
         jitc_raise("jit_var_schedule(r%u): unknown variable!", index);
-    Variable *v = &it.value();
 
     if (unlikely(v->placeholder))
         jitc_raise_placeholder_error("jitc_var_schedule", index);
 
-    if (v->is_stmt() || v->is_node()) {
+    if (v->is_node()) {
         thread_state(v->backend)->scheduled.push_back(index);
         jitc_log(Debug, "jit_var_schedule(r%u)", index);
         return 1;
@@ -1032,7 +1175,7 @@ void *jitc_var_ptr(uint32_t index) {
        generating code to do so.. */
     if (v->is_literal())
         jitc_var_eval_literal(index, v);
-    else if (v->is_stmt() || v->is_node())
+    else if (v->is_node())
         jitc_var_eval(index);
 
     return jitc_var(index)->data;
@@ -1041,18 +1184,28 @@ void *jitc_var_ptr(uint32_t index) {
 /// Evaluate a literal constant variable
 void jitc_var_eval_literal(uint32_t index, Variable *v) {
     jitc_log(Debug,
-            "jit_var_eval_literal(r%u): writing %s literal of size %u",
-            index, type_name[v->type], v->size);
+            "jit_var_eval_literal(r%u): writing %s literal of size %zu",
+            index, type_name[v->type], (size_t) v->size);
 
     jitc_lvn_drop(index, v);
 
     JitBackend backend = (JitBackend) v->backend;
     uint32_t isize = type_size[v->type];
-    void* data = jitc_malloc(backend == JitBackend::CUDA ? AllocType::Device
-                                                         : AllocType::HostAsync,
-                             (size_t) v->size * (size_t) isize);
+    size_t dsize = (size_t) v->size * (size_t) isize;
+    void *data;
+
+    // Zero-valued literals (e.g. scatter-reduce targets) can use the zero page
+    if (v->literal == 0) {
+        data = jitc_calloc_async(backend, v->size, isize);
+    } else {
+        data = jitc_malloc(backend == JitBackend::CUDA ? AllocType::Device
+                                                       : AllocType::HostAsync,
+                           dsize);
+        v = jitc_var(index);
+        jitc_memset_async(backend, data, v->size, isize, &v->literal);
+    }
+
     v = jitc_var(index);
-    jitc_memset_async(backend, data, v->size, isize, &v->literal);
 
     v->kind = (uint32_t) VarKind::Data;
     v->data = data;
@@ -1065,13 +1218,16 @@ int jitc_var_eval(uint32_t index) {
     if (unlikely(v->placeholder))
         jitc_raise_placeholder_error("jitc_var_eval", index);
 
-    if (v->is_stmt() || v->is_node() || (v->is_data() && v->is_dirty())) {
+    if (v->is_node() || (v->is_data() && v->is_dirty())) {
         ThreadState *ts = thread_state(v->backend);
 
-        if (!v->is_data())
+        if (!v->is_data()) {
             ts->scheduled.push_back(index);
-
-        jitc_eval(ts);
+            jitc_eval(ts);
+        } else {
+            // Only run the side effects that write to this variable
+            jitc_eval_dirty(ts, &index, 1);
+        }
         v = jitc_var(index);
 
         if (unlikely(v->is_dirty()))
@@ -1089,7 +1245,7 @@ int jitc_var_eval(uint32_t index) {
 void jitc_var_read(uint32_t index, size_t offset, void *dst) {
     const Variable *v = jitc_var(index);
 
-    if (v->is_stmt() || v->is_node() || (v->is_data() && v->is_dirty())) {
+    if (v->is_node() || (v->is_data() && v->is_dirty())) {
         jitc_var_eval(index);
         v = jitc_var(index);
     }
@@ -1098,7 +1254,7 @@ void jitc_var_read(uint32_t index, size_t offset, void *dst) {
         offset = 0;
     else if (unlikely(offset >= (size_t) v->size))
         jitc_raise("jit_var_read(): attempted to access entry %zu in an array of "
-                   "size %u!", offset, v->size);
+                   "size %zu!", offset, (size_t) v->size);
 
     uint32_t isize = type_size[v->type];
     if (v->is_literal())
@@ -1125,7 +1281,7 @@ uint32_t jitc_var_write(uint32_t index, size_t offset, const void *src) {
     v = jitc_var(index);
     if (unlikely(offset >= (size_t) v->size))
         jitc_raise("jit_var_write(): attempted to access entry %zu in an array of "
-                   "size %u!", offset, v->size);
+                   "size %zu!", offset, (size_t) v->size);
 
     uint32_t isize = type_size[v->type];
     uint8_t *dst = (uint8_t *) v->data + offset * isize;
@@ -1140,14 +1296,14 @@ uint32_t jitc_var_mem_map(JitBackend backend, VarType type, void *ptr,
     if (unlikely(size == 0))
         return 0;
 
-    jitc_check_size("jit_var_mem_map", size);
+    jitc_check_size("jit_var_mem_map", backend, size);
 
     Variable v;
     v.kind = (uint32_t) VarKind::Data;
     v.type = (uint32_t) type;
     v.backend = (uint32_t) backend;
     v.data = ptr;
-    v.size = (uint32_t) size;
+    v.size = size;
     v.retain_data = free == 0;
 
     if (backend == JitBackend::LLVM) {
@@ -1165,7 +1321,7 @@ uint32_t jitc_var_mem_copy(JitBackend backend, AllocType atype, VarType vtype,
     if (unlikely(size == 0))
         return 0;
 
-    jitc_check_size("jit_var_mem_copy", size);
+    jitc_check_size("jit_var_mem_copy", backend, size);
 
     size_t total_size = (size_t) size * (size_t) type_size[(int) vtype];
     void *target_ptr;
@@ -1219,6 +1375,188 @@ uint32_t jitc_var_mem_copy(JitBackend backend, AllocType atype, VarType vtype,
     return index;
 }
 
+#if !defined(_WIN32)
+/// Bookkeeping for variables created by jitc_var_mem_map_file()
+struct FileMapping {
+    void *base;
+    size_t size;
+};
+#endif
+
+uint32_t jitc_var_mem_map_file(JitBackend backend, VarType type,
+                               const char *filename, size_t offset,
+                               size_t size, int shared) {
+#if defined(_WIN32)
+    (void) backend; (void) type; (void) filename; (void) offset; (void) size;
+    (void) shared;
+    jitc_raise("jit_var_mem_map_file(): not supported on Windows!");
+#else
+    if (unlikely(size == 0))
+        return 0;
+
+    jitc_check_size("jit_var_mem_map_file", backend, size);
+
+    size_t total_size = size * (size_t) type_size[(int) type];
+
+    int fd = open(filename, shared ? O_RDWR : O_RDONLY);
+    if (fd < 0)
+        jitc_raise("jit_var_mem_map_file(): could not open \"%s\": %s!",
+                   filename, strerror(errno));
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < offset + total_size) {
+        close(fd);
+        jitc_raise("jit_var_mem_map_file(): \"%s\" is too small to hold %zu "
+                   "bytes at offset %zu!", filename, total_size, offset);
+    }
+
+    // mmap() requires a page-aligned file offset
+    size_t page_size   = (size_t) sysconf(_SC_PAGESIZE),
+           map_offset  = offset / page_size * page_size,
+           map_size    = total_size + (offset - map_offset);
+
+    /* Private mappings are copy-on-write: pages are shared with the page
+       cache until written (e.g. by a scatter), and the file is never
+       modified. Shared mappings carry writes through to the file. */
+    void *base = mmap(nullptr, map_size, PROT_READ | PROT_WRITE,
+                      shared ? MAP_SHARED : MAP_PRIVATE, fd, (off_t) map_offset);
+    close(fd);
+
+    if (base == MAP_FAILED)
+        jitc_raise("jit_var_mem_map_file(): mmap() of \"%s\" failed: %s!",
+                   filename, strerror(errno));
+
+    uint8_t *ptr = (uint8_t *) base + (offset - map_offset);
+
+    if (backend == JitBackend::CUDA) {
+        // GPUs can't access the mapping directly. Upload and unmap right away
+        uint32_t index =
+            jitc_var_mem_copy(backend, AllocType::Host, type, ptr, size);
+        munmap(base, map_size);
+        return index;
+    }
+
+    uint32_t index = jitc_var_mem_map(backend, type, ptr, size, 0);
+
+    FileMapping *fm = (FileMapping *) malloc_check(sizeof(FileMapping));
+    fm->base = base;
+    fm->size = map_size;
+
+    // Unmap once the variable is freed and all kernels using it have finished
+    Extra &extra = state.extra[index];
+    extra.callback = [](uint32_t, int free_, void *payload) {
+        if (!free_)
+            return;
+        FileMapping *fm2 = (FileMapping *) payload;
+        jitc_munmap_async(JitBackend::LLVM, fm2->base, fm2->size);
+        free(fm2);
+    };
+    extra.callback_data = fm;
+    extra.callback_internal = true;
+    jitc_var(index)->extra = true;
+
+    jitc_log(Debug, "jit_var_mem_map_file(%s r%u[%zu] <- \"%s\" @ %zu, %s)",
+             type_name[(int) type], index, size, filename, offset,
+             shared ? "shared" : "private");
+
+    return index;
+#endif
+}
+
+void jitc_var_write_file(uint32_t index, const char *filename) {
+#if defined(_WIN32)
+    (void) index; (void) filename;
+    jitc_raise("jit_var_write_file(): not supported on Windows!");
+#else
+    Variable *v = jitc_var(index);
+    if (v->is_node() || (v->is_data() && v->is_dirty())) {
+        jitc_var_eval(index);
+        v = jitc_var(index);
+    }
+
+    JitBackend backend = (JitBackend) v->backend;
+    uint32_t isize = type_size[v->type];
+    size_t total_size = (size_t) v->size * isize,
+           chunk_size = std::min(total_size, (size_t) DRJIT_FILE_CHUNK_SIZE);
+    bool is_literal = v->is_literal();
+    uint64_t literal = v->literal;
+    const uint8_t *src = (const uint8_t *) v->data;
+
+    int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        jitc_raise("jit_var_write_file(): could not open \"%s\": %s!",
+                   filename, strerror(errno));
+
+    jitc_log(Debug, "jit_var_write_file(r%u -> \"%s\"): writing %s.", index,
+             filename, std::string(jitc_mem_string(total_size)).c_str());
+
+    // Keep the variable alive while the lock is temporarily released below
+    jitc_var_inc_ref(index);
+    ThreadState *ts = thread_state(backend);
+    bool success = true;
+
+    if (is_literal) {
+        // Replicate the literal into a staging buffer that is written repeatedly
+        uint8_t *buf = (uint8_t *) malloc_check(chunk_size);
+        for (size_t i = 0; i < chunk_size; i += isize)
+            memcpy(buf + i, &literal, isize);
+
+        unlock_guard guard(state.lock);
+        for (size_t i = 0; i < total_size && success; i += chunk_size)
+            success = jitc_write_all(fd, buf, std::min(chunk_size, total_size - i));
+        free(buf);
+    } else if (backend == JitBackend::LLVM) {
+        unlock_guard guard(state.lock);
+        jitc_sync_thread(ts);
+        success = jitc_write_all(fd, src, total_size);
+    } else {
+        /* Double-buffered download: copy chunk 'i + 1' to host-pinned memory
+           while chunk 'i' is being written to disk */
+        uint8_t *staging[2] = {
+            (uint8_t *) jitc_malloc(AllocType::HostPinned, chunk_size),
+            (uint8_t *) jitc_malloc(AllocType::HostPinned, chunk_size)
+        };
+
+        scoped_set_context guard(ts->context);
+        CUevent events[2];
+        for (int i = 0; i < 2; ++i)
+            cuda_check(cuEventCreate(&events[i], CU_EVENT_DISABLE_TIMING));
+
+        auto download = [&](size_t offset, int slot) {
+            cuda_check(cuMemcpyAsync(
+                (CUdeviceptr) staging[slot], (CUdeviceptr) (src + offset),
+                std::min(chunk_size, total_size - offset), ts->stream));
+            cuda_check(cuEventRecord(events[slot], ts->stream));
+        };
+
+        download(0, 0);
+        for (size_t offset = 0, slot = 0; offset < total_size && success;
+             offset += chunk_size, slot ^= 1) {
+            if (offset + chunk_size < total_size)
+                download(offset + chunk_size, (int) slot ^ 1);
+
+            unlock_guard guard2(state.lock);
+            cuda_check(cuEventSynchronize(events[slot]));
+            success = jitc_write_all(fd, staging[slot],
+                                     std::min(chunk_size, total_size - offset));
+        }
+
+        cuda_check(cuStreamSynchronize(ts->stream));
+        for (int i = 0; i < 2; ++i) {
+            cuda_check(cuEventDestroy(events[i]));
+            jitc_free(staging[i]);
+        }
+    }
+
+    int close_rv = close(fd);
+    jitc_var_dec_ref(index);
+
+    if (!success || close_rv != 0)
+        jitc_raise("jit_var_write_file(): could not write \"%s\": %s!",
+                   filename, strerror(errno));
+#endif
+}
+
 uint32_t jitc_var_copy(uint32_t index) {
     if (index == 0)
         return 0;
@@ -1247,10 +1585,7 @@ uint32_t jitc_var_copy(uint32_t index) {
             v2.kind = (uint32_t) VarKind::Literal;
             v2.literal = v->literal;
         } else {
-            v2.kind = (uint32_t) VarKind::Stmt;
-            v2.stmt = (char *) (((JitBackend) v->backend == JitBackend::CUDA)
-                                ? "mov.$t0 $r0, $r1"
-                                : "$r0 = bitcast <$w x $t1> $r1 to <$w x $t0>");
+            v2.kind = (uint32_t) VarKind::Copy;
             v2.dep[0] = index;
             jitc_var_inc_ref(index, v);
         }
@@ -1266,9 +1601,8 @@ uint32_t jitc_var_resize(uint32_t index, size_t size) {
     if (index == 0 && size == 0)
         return 0;
 
-    jitc_check_size("jit_var_resize", size);
-
     Variable *v = jitc_var(index);
+    jitc_check_size("jit_var_resize", (JitBackend) v->backend, size);
 
     if (v->size == size) {
         jitc_var_inc_ref(index, v);
@@ -1278,7 +1612,7 @@ uint32_t jitc_var_resize(uint32_t index, size_t size) {
     }
 
     if (v->is_dirty()) {
-        jitc_eval(thread_state(v->backend));
+        jitc_eval_dirty(thread_state(v->backend), &index, 1);
         v = jitc_var(index);
         if (v->is_dirty())
             jitc_raise("jit_var_resize(): variable remains dirty following evaluation!");
@@ -1289,7 +1623,7 @@ uint32_t jitc_var_resize(uint32_t index, size_t size) {
         // Nobody else holds a reference -- we can directly resize this variable
         jitc_var_inc_ref(index, v);
         jitc_lvn_drop(index, v);
-        v->size = (uint32_t) size;
+        v->size = size;
         jitc_lvn_put(index, v);
         result = index;
     } else if (v->is_literal()) {
@@ -1297,15 +1631,12 @@ uint32_t jitc_var_resize(uint32_t index, size_t size) {
                                   &v->literal, size, 0);
     } else {
         Variable v2;
-        v2.kind = (uint32_t) VarKind::Stmt;
+        v2.kind = (uint32_t) VarKind::Copy;
         v2.type = v->type;
         v2.backend = v->backend;
         v2.placeholder = v->placeholder;
-        v2.size = (uint32_t) size;
+        v2.size = size;
         v2.dep[0] = index;
-        v2.stmt = (char *) (((JitBackend) v->backend == JitBackend::CUDA)
-                            ? "mov.$t0 $r0, $r1"
-                            : "$r0 = bitcast <$w x $t1> $r1 to <$w x $t0>");
         jitc_var_inc_ref(index, v);
         result = jitc_var_new(v2, true);
     }
@@ -1359,7 +1690,7 @@ uint32_t jitc_var_migrate(uint32_t src_index, AllocType dst_type) {
             jitc_memset_async(dst_type == AllocType::HostAsync
                                   ? JitBackend::LLVM
                                   : JitBackend::CUDA,
-                              ptr, (uint32_t) size, type_size[v->type], &v->literal);
+                              ptr, size, type_size[v->type], &v->literal);
         }
 
         return jitc_var_mem_map(backend, (VarType) v->type, ptr, v->size, 1);
@@ -1427,7 +1758,7 @@ uint32_t jitc_var_migrate(uint32_t src_index, AllocType dst_type) {
     return dst_index;
 }
 
-uint32_t jitc_var_mask_default(JitBackend backend, uint32_t size) {
+uint32_t jitc_var_mask_default(JitBackend backend, size_t size) {
     if (backend == JitBackend::CUDA) {
         bool value = true;
         return jitc_var_literal(backend, VarType::Bool, &value, size, 0);
@@ -1459,7 +1790,7 @@ void jitc_var_mask_push(JitBackend backend, uint32_t index) {
     thread_state(backend)->mask_stack.push_back(index);
 }
 
-uint32_t jitc_var_mask_apply(uint32_t index, uint32_t size) {
+uint32_t jitc_var_mask_apply(uint32_t index, size_t size) {
     const Variable *v = jitc_var(index);
     JitBackend backend = (JitBackend) v->backend;
 
@@ -1469,8 +1800,8 @@ uint32_t jitc_var_mask_apply(uint32_t index, uint32_t size) {
     auto &stack = thread_state(backend)->mask_stack;
     Ref mask;
     if (!stack.empty()) {
-        uint32_t index_2 = stack.back(),
-                 size_2  = jitc_var(index_2)->size;
+        uint32_t index_2 = stack.back();
+        uint64_t size_2  = jitc_var(index_2)->size;
 
         // Use mask from the mastk stack if its size is compatible
         if (size == 1 || size_2 == 1 || size_2 == size)
@@ -1488,7 +1819,7 @@ uint32_t jitc_var_mask_apply(uint32_t index, uint32_t size) {
         result = jitc_var_resize(index, size);
     }
 
-    jitc_log(Debug, "jit_var_apply_mask(r%u <- r%u, size=%u)", result, index, size);
+    jitc_log(Debug, "jit_var_apply_mask(r%u <- r%u, size=%zu)", result, index, size);
     return result;
 }
 
@@ -1539,7 +1870,7 @@ bool jitc_var_all(uint32_t index) {
     return jitc_all((JitBackend) v->backend, (uint8_t *) v->data, v->size);
 }
 
-template <typename T> static void jitc_var_reduce_scalar(uint32_t size, void *ptr) {
+template <typename T> static void jitc_var_reduce_scalar(size_t size, void *ptr) {
     T value;
     memcpy(&value, ptr, sizeof(T));
     value = T(value * T(size));
@@ -1559,7 +1890,7 @@ uint32_t jitc_var_reduce(uint32_t index, ReduceOp reduce_op) {
 
     if (v->is_literal()) {
         uint64_t value = v->literal;
-        uint32_t size = v->size;
+        size_t size = v->size;
 
         // Tricky cases
         if (size != 1 && (reduce_op == ReduceOp::Add)) {
@@ -1589,7 +1920,7 @@ uint32_t jitc_var_reduce(uint32_t index, ReduceOp reduce_op) {
         v = jitc_var(index);
 
     uint8_t *values = (uint8_t *) v->data;
-    uint32_t size = v->size;
+    size_t size = v->size;
 
     void *data =
         jitc_malloc(backend == JitBackend::CUDA ? AllocType::Device
@@ -1627,8 +1958,8 @@ const char *jitc_var_whos() {
 
     std::vector<uint32_t> indices;
     indices.reserve(state.variables.size());
-    for (const auto& it : state.variables)
-        indices.push_back(it.first);
+    state.variables.for_each(
+        [&](uint32_t index, const Variable &) { indices.push_back(index); });
     std::sort(indices.begin(), indices.end());
 
     size_t mem_size_evaluated = 0,
@@ -1670,7 +2001,7 @@ const char *jitc_var_whos() {
         size_t sz = var_buffer.fmt("  %u", (uint32_t) v->ref_count);
         const char *label = jitc_var_label(index);
 
-        var_buffer.fmt("%*s%-10u%-8s   %s\n", 10 - (int) sz, "", v->size,
+        var_buffer.fmt("%*s%-10zu%-8s   %s\n", 10 - (int) sz, "", (size_t) v->size,
                    jitc_mem_string(mem_size), label ? label : "");
 
         if (v->is_data())
@@ -1681,8 +2012,7 @@ const char *jitc_var_whos() {
     if (indices.empty())
         var_buffer.put("                       -- No variables registered --\n");
 
-    constexpr size_t BucketSize1 = sizeof(tsl::detail_robin_hash::bucket_entry<VariableMap::value_type, false>);
-    constexpr size_t BucketSize2 = sizeof(tsl::detail_robin_hash::bucket_entry<LVNMap::value_type, false>);
+    constexpr size_t BucketSize = sizeof(tsl::detail_robin_hash::bucket_entry<LVNMap::value_type, false>);
 
     var_buffer.put("  =======================================================================\n\n");
     var_buffer.put("  JIT compiler\n");
@@ -1694,13 +2024,18 @@ const char *jitc_var_whos() {
     var_buffer.fmt("   - Variables created : %u (peak: %u, table size: %s).\n",
                state.variable_index, state.variable_watermark,
                jitc_mem_string(
-                   state.variables.bucket_count() * BucketSize1 +
-                   state.lvn_map.bucket_count() * BucketSize2));
+                   state.variables.memory() +
+                   state.lvn_map.bucket_count() * BucketSize));
     var_buffer.fmt("   - Kernel launches   : %zu (%zu cache hits, "
-               "%zu soft, %zu hard misses).\n\n",
+               "%zu soft, %zu hard misses).\n",
                state.kernel_launches, state.kernel_hits,
                state.kernel_soft_misses, state.kernel_hard_misses);
 
+    size_t rewrites = 0;
+    for (size_t count : state.rewrite_count)
+        rewrites += count;
+    var_buffer.fmt("   - Rewrites applied  : %zu.\n\n", rewrites);
+
     var_buffer.put("  Memory allocator\n");
     var_buffer.put("  ================\n");
     for (int i = 0; i < (int) AllocType::Count; ++i)
@@ -1717,8 +2052,8 @@ const char *jitc_var_whos() {
 const char *jitc_var_graphviz() {
     std::vector<uint32_t> indices;
     indices.reserve(state.variables.size());
-    for (const auto& it : state.variables)
-        indices.push_back(it.first);
+    state.variables.for_each(
+        [&](uint32_t index, const Variable &) { indices.push_back(index); });
 
     std::sort(indices.begin(), indices.end());
     var_buffer.clear();
@@ -1840,17 +2175,10 @@ const char *jitc_var_graphviz() {
                 var_buffer.put("Evaluated");
                 color = "lightblue2";
             }
-        } else if (v->is_stmt()) {
+        } else {
             if ((VarType) v->type == VarType::Void)
                 color = "yellowgreen";
 
-            if (*v->stmt != '\0') {
-                print_escape(v->stmt);
-                var_buffer.put("\\l");
-            } else if (labeled) {
-                var_buffer.rewind_to(var_buffer.size() - 1);
-            }
-        } else {
             const char *name = var_kind_name[v->kind];
             var_buffer.put(name, strlen(name));
         }
@@ -1860,9 +2188,9 @@ const char *jitc_var_graphviz() {
         if (labeled && !color)
             color = "wheat";
 
-        var_buffer.fmt("|{Type: %s %s|Size: %u}|{r%u|Refs: %u}}",
+        var_buffer.fmt("|{Type: %s %s|Size: %zu}|{r%u|Refs: %u}}",
             (JitBackend) v->backend == JitBackend::CUDA ? "cuda" : "llvm",
-            type_name_short[v->type], v->size, index,
+            type_name_short[v->type], (size_t) v->size, index,
             (uint32_t) v->ref_count);
 
         var_buffer.put("}\"");
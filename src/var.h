@@ -19,6 +19,16 @@ struct Variable;
 /// Look up a variable by its ID
 extern Variable *jitc_var(uint32_t index);
 
+/**
+ * \brief Reserve \c count consecutive epochs for graph traversals and return
+ * the first one
+ *
+ * Traversals mark visited variables by storing the epoch in
+ * 'VariableCold::visit_epoch', which avoids the need for a separate set data
+ * structure. Epochs start at 1, hence a mark of 0 never matches.
+ */
+extern uint32_t jitc_var_epoch_new(uint32_t count = 1);
+
 /// Create a value constant variable of the given size
 extern uint32_t jitc_var_literal(JitBackend backend, VarType type,
                                  const void *value, size_t size,
@@ -28,36 +38,28 @@ extern uint32_t jitc_var_literal(JitBackend backend, VarType type,
 extern uint32_t jitc_var_counter(JitBackend backend, size_t size,
                                  bool simplify_scalar);
 
-/// Create a variable representing the result of a custom IR statement
-extern uint32_t jitc_var_stmt(JitBackend backend,
-                              VarType type,
-                              const char *stmt,
-                              int stmt_static,
-                              uint32_t n_dep,
-                              const uint32_t *dep);
-
 /// Create a new IR node. Just a wrapper around jitc_var_new without any error checking
 extern uint32_t jitc_var_new_node_0(JitBackend backend, VarKind kind,
-                                    VarType vt, uint32_t size, bool placeholder,
+                                    VarType vt, size_t size, bool placeholder,
                                     uint64_t payload = 0);
 
 extern uint32_t jitc_var_new_node_1(JitBackend backend, VarKind kind,
-                                    VarType vt, uint32_t size, bool placeholder,
+                                    VarType vt, size_t size, bool placeholder,
                                     uint32_t a0, Variable *v0,
                                     uint64_t payload = 0);
 
 extern uint32_t jitc_var_new_node_2(JitBackend backend, VarKind kind,
-                                    VarType vt, uint32_t size, bool placeholder,
+                                    VarType vt, size_t size, bool placeholder,
                                     uint32_t a0, Variable *v0, uint32_t a1, Variable *v1,
                                     uint64_t payload = 0);
 
 extern uint32_t jitc_var_new_node_3(JitBackend backend, VarKind kind,
-                                    VarType vt, uint32_t size, bool placeholder,
+                                    VarType vt, size_t size, bool placeholder,
                                     uint32_t a0, Variable *v0, uint32_t a1, Variable *v1,
                                     uint32_t a2, Variable *v2, uint64_t payload = 0);
 
 extern uint32_t jitc_var_new_node_4(JitBackend backend, VarKind kind,
-                                    VarType vt, uint32_t size, bool placeholder,
+                                    VarType vt, size_t size, bool placeholder,
                                     uint32_t a0, Variable *v0, uint32_t a1, Variable *v1,
                                     uint32_t a2, Variable *v2, uint32_t a3, Variable *v4,
                                     uint64_t payload = 0);
@@ -78,6 +80,14 @@ extern uint32_t jitc_var_mem_copy(JitBackend backend, AllocType atype,
                                   VarType vtype, const void *ptr,
                                   size_t size);
 
+/// Create a variable backed by a memory-mapped file region
+extern uint32_t jitc_var_mem_map_file(JitBackend backend, VarType type,
+                                      const char *filename, size_t offset,
+                                      size_t size, int shared);
+
+/// Write the contents of a variable to a file
+extern void jitc_var_write_file(uint32_t index, const char *filename);
+
 /// Duplicate a variable
 extern uint32_t jitc_var_copy(uint32_t index);
 
@@ -186,10 +196,10 @@ extern void jitc_var_mask_push(JitBackend backend, uint32_t index);
 extern void jitc_var_mask_pop(JitBackend backend);
 
 /// Combine the given mask 'index' with the mask stack. 'size' indicates the wavefront size
-extern uint32_t jitc_var_mask_apply(uint32_t index, uint32_t size);
+extern uint32_t jitc_var_mask_apply(uint32_t index, size_t size);
 
 /// Return the default mask
-extern uint32_t jitc_var_mask_default(JitBackend backend, uint32_t size);
+extern uint32_t jitc_var_mask_default(JitBackend backend, size_t size);
 
 /// Start a new scope of the program being recorded
 extern void jitc_new_scope(JitBackend backend);
@@ -85,14 +85,26 @@ uint32_t jitc_var_vcall(const char *name, uint32_t self, uint32_t mask_,
         jitc_raise("jit_var_vcall(): list of all output indices must be a "
                    "multiple of the instance count!");
 
-    uint32_t n_out = n_out_nested / n_inst, size = 0,
+    uint32_t n_out = n_out_nested / n_inst,
              in_size_initial = 0, out_size_initial = 0;
+    uint64_t size = 0;
 
     bool placeholder = false, dirty = false;
 
     JitBackend backend;
     /* Check 'self' */ {
         const Variable *self_v = jitc_var(self);
+
+        /* Coherent dispatch on the LLVM backend sorts the lanes of each block
+           by 'self', which must be an evaluated array for this purpose */
+        if ((JitBackend) self_v->backend == JitBackend::LLVM &&
+            state.llvm_vcall_coherence > 0.f &&
+            self_v->size > DRJIT_POOL_BLOCK_SIZE && !self_v->is_data() &&
+            !self_v->is_literal() && !self_v->placeholder) {
+            jitc_var_eval(self);
+            self_v = jitc_var(self);
+        }
+
         size = self_v->size;
         placeholder |= (bool) self_v->placeholder;
         dirty |= self_v->is_dirty();
@@ -156,7 +168,15 @@ uint32_t jitc_var_vcall(const char *name, uint32_t self, uint32_t mask_,
                    "expected size!");
 
     if (dirty) {
-        jitc_eval(ts);
+        std::vector<uint32_t> inputs;
+        inputs.reserve(n_in + 1);
+        inputs.push_back(self);
+        for (uint32_t i = 0; i < n_in; ++i) {
+            const Variable *v = jitc_var(in[i]);
+            if (v->vcall_iface)
+                inputs.push_back(v->dep[0]);
+        }
+        jitc_eval_dirty(ts, inputs.data(), inputs.size());
 
         dirty = jitc_var(self)->is_dirty();
         for (uint32_t i = 0; i < n_in; ++i) {
@@ -374,7 +394,7 @@ uint32_t jitc_var_vcall(const char *name, uint32_t self, uint32_t mask_,
     jitc_log(InfoSym,
              "jit_var_vcall(r%u, self=r%u): call (\"%s\") with %u instance%s, %u "
              "input%s, %u output%s (%u devirtualized), %u side effect%s, %u "
-             "byte%s of call data, %u elements%s%s", (uint32_t) vcall_v, self, name, n_inst,
+             "byte%s of call data, %zu elements%s%s", (uint32_t) vcall_v, self, name, n_inst,
              n_inst == 1 ? "" : "s", n_in, n_in == 1 ? "" : "s", n_out,
              n_out == 1 ? "" : "s", n_devirt, se_count, se_count == 1 ? "" : "s",
              data_size, data_size == 1 ? "" : "s", size,
@@ -420,7 +440,7 @@ uint32_t jitc_var_vcall(const char *name, uint32_t self, uint32_t mask_,
         for (uint32_t i = 0; i < vcall_2->in.size(); ++i) {
             uint32_t index_2 = vcall_2->in_nested[i];
             if (index_2 &&
-                state.variables.find(index_2) == state.variables.end()) {
+                !state.variables.find(index_2)) {
                 Extra *e = &state.extra[vcall_2->id];
                 if (unlikely(e->dep[i] != vcall_2->in[i]))
                     jitc_fail("jit_var_vcall(): internal error! (1)");
@@ -551,11 +571,172 @@ uint32_t jitc_var_vcall(const char *name, uint32_t self, uint32_t mask_,
 
 static ProfilerRegion profiler_region_vcall_assemble("jit_var_vcall_assemble");
 
+/// Vcalls with at least this many instances generate their callables in parallel
+#define DRJIT_VCALL_PARALLEL_MIN 16
+
+/// Per-instance state of jitc_var_vcall_assemble_parallel()
+struct ParallelCallable {
+    std::vector<ScheduledVariable> schedule;
+    uint32_t n_regs = 0;
+    StringBuffer code;
+    StringBuffer globals;
+};
+
+struct ParallelAssembly {
+    VCall *vcall;
+    ParallelCallable *callables;
+    uint32_t in_size, n_out;
+};
+
+/// Can code for this variable be generated concurrently with other callables?
+static bool jitc_var_vcall_parallel_safe(uint32_t index, const Variable *v) {
+    switch ((VarKind) v->kind) {
+        case VarKind::Dispatch:
+        case VarKind::TraceRay:
+        case VarKind::Printf:
+        case VarKind::LoopStart:
+        case VarKind::LoopCond:
+        case VarKind::LoopEnd:
+        case VarKind::LoopPhi:
+            return false;
+
+        default:
+            break;
+    }
+
+    if (v->extra) {
+        auto it = state.extra.find(index);
+        if (it == state.extra.end() || it->second.assemble)
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * \brief Generate the callables of an LLVM vcall on the thread pool
+ *
+ * Graph traversal and register assignment modify shared state and run
+ * sequentially. Code generation then only reads the graph and proceeds in
+ * parallel, with each worker writing to its own (thread-local) 'buffer' and
+ * deferring the registration of global declarations. Finally, callables are
+ * deduplicated in instance order, which produces the same result as
+ * sequential assembly up to the register numbering of variables that are
+ * shared by several instances.
+ *
+ * This is only possible when the register indices of variables agree across
+ * the instances that use them (see jitc_assemble_func_schedule() regarding
+ * inputs), and when they don't contain operations with custom code
+ * generation (see jitc_var_vcall_parallel_safe()). Labeled IR output (which
+ * depends on thread-local flags) is also generated sequentially. Returns
+ * \c false if the vcall needs to be assembled sequentially.
+ */
+static bool jitc_var_vcall_assemble_parallel(ThreadState *ts, VCall *vcall,
+                                             uint32_t in_size, uint32_t n_in,
+                                             uint32_t n_out,
+                                             CallablesSet &callables_set) {
+    uint32_t n_inst = vcall->n_inst;
+    bool print_labels = std::max(state.log_level_stderr,
+                                 state.log_level_callback) >= LogLevel::Trace ||
+                        (jitc_flags() & (uint32_t) JitFlag::PrintIR);
+
+    if (vcall->backend != JitBackend::LLVM || print_labels ||
+        n_inst < DRJIT_VCALL_PARALLEL_MIN || pool_size() < 2)
+        return false;
+
+    std::unique_ptr<ParallelCallable[]> callables(new ParallelCallable[n_inst]);
+    tsl::robin_map<uint32_t, uint32_t, UInt32Hasher> owner;
+    std::vector<uint32_t> shared;
+    uint32_t n_regs = 0;
+
+    for (uint32_t i = 0; i < n_inst; ++i) {
+        ParallelCallable &c = callables[i];
+        c.n_regs = jitc_assemble_func_schedule(
+            ts, n_in, vcall->in.data(), n_out,
+            vcall->out_nested.data() + n_out * i,
+            vcall->checkpoints[i + 1] - vcall->checkpoints[i],
+            vcall->side_effects.data() + vcall->checkpoints[i]);
+        n_regs = std::max(n_regs, c.n_regs);
+
+        for (const ScheduledVariable &sv : schedule) {
+            const Variable *v = jitc_var(sv.index);
+            if (!jitc_var_vcall_parallel_safe(sv.index, v))
+                return false;
+            if (v->vcall_iface)
+                continue;
+
+            // Variables used by several instances (e.g. following LVN)
+            uint32_t &o = owner.emplace(sv.index, i).first.value();
+            if (o != i && o != (uint32_t) -1) {
+                o = (uint32_t) -1;
+                shared.push_back(sv.index);
+            }
+        }
+
+        // Copy, since an enclosing callable may still be iterating over 'schedule'
+        c.schedule = schedule;
+    }
+
+    /* Each instance computes its own copy of a shared variable. Since the
+       dependencies of a shared variable are inputs or shared as well, it
+       suffices to assign a register above those used by any instance, which
+       is then the same in every instance. */
+    for (uint32_t index : shared)
+        jitc_var(index)->cold().reg_index = n_regs++;
+    if (!shared.empty()) {
+        for (uint32_t i = 0; i < n_inst; ++i)
+            callables[i].n_regs = n_regs;
+    }
+
+    ParallelAssembly payload { vcall, callables.get(), in_size, n_out };
+
+    auto callback = [](uint32_t i, void *ptr) {
+        ParallelAssembly *p = (ParallelAssembly *) ptr;
+        ParallelCallable &c = p->callables[i];
+        VCall *vcall = p->vcall;
+
+        jitc_register_global_defer(&c.globals);
+
+        // The pool may also run this on the calling thread, don't clear 'buffer'
+        size_t offset = buffer.size();
+        jitc_llvm_assemble_func(vcall->name, i, p->in_size,
+                                vcall->data_offset[i], vcall->data_map,
+                                p->n_out,
+                                vcall->out_nested.data() + p->n_out * i,
+                                vcall->use_self, c.schedule);
+        c.code.put(buffer.get() + offset, buffer.size() - offset);
+        buffer.rewind_to(offset);
+
+        jitc_register_global_defer(nullptr);
+    };
+
+    callable_depth++;
+    task_wait_and_release(
+        task_submit_dep(nullptr, nullptr, 0, n_inst, callback, &payload));
+    callable_depth--;
+
+    for (uint32_t i = 0; i < n_inst; ++i) {
+        ParallelCallable &c = callables[i];
+        jitc_register_globals(c.globals.get(), c.globals.size());
+
+        size_t offset = buffer.size();
+        buffer.put(c.code.get(), c.code.size());
+        XXH128_hash_t hash = jitc_assemble_func_register(ts, offset, c.n_regs);
+        vcall->inst_hash[i] = hash;
+        callables_set.insert(hash);
+    }
+
+    jitc_log(Debug, "jit_var_vcall_assemble(): generated %u callables in parallel.",
+             n_inst);
+
+    return true;
+}
+
 
 /// Called by the JIT compiler when compiling a virtual function call
 void jitc_var_vcall_assemble(VCall *vcall, uint32_t self_reg, uint32_t mask_reg,
                              uint32_t offset_reg, uint32_t data_reg) {
-    uint32_t vcall_reg = jitc_var(vcall->id)->reg_index;
+    uint32_t vcall_reg = jitc_var(vcall->id)->cold().reg_index;
 
     ProfilerPhase profiler(profiler_region_vcall_assemble);
 
@@ -576,8 +757,8 @@ void jitc_var_vcall_assemble(VCall *vcall, uint32_t self_reg, uint32_t mask_reg,
 
     for (const ScheduledVariable &sv : schedule) {
         const Variable *v = jitc_var(sv.index);
-        backup.push_back(JitBackupRecord{ sv, v->param_type, v->output_flag,
-                                          v->reg_index, v->param_offset });
+        backup.push_back(JitBackupRecord{ sv, v->cold().param_type, v->cold().output_flag,
+                                          v->cold().reg_index, v->cold().param_offset });
     }
 
     int32_t alloca_size_backup = alloca_size;
@@ -598,33 +779,28 @@ void jitc_var_vcall_assemble(VCall *vcall, uint32_t self_reg, uint32_t mask_reg,
              n_out_active = 0;
 
     for (uint32_t i = 0; i < n_in; ++i) {
-        auto it = state.variables.find(vcall->in[i]);
-        if (it == state.variables.end())
+        Variable *v = state.variables.find(vcall->in[i]);
+        if (!v)
             continue;
 
-        uint32_t size = type_size[it.value().type],
+        uint32_t size = type_size[v->type],
                  offset = in_size;
-        Variable *v = &it.value();
         in_size += size;
         in_align = std::max(size, in_align);
         n_in_active++;
 
         // Transfer parameter offset to instances
-        auto it2 = state.variables.find(vcall->in_nested[i]);
-        if (it2 == state.variables.end())
+        Variable *v2 = state.variables.find(vcall->in_nested[i]);
+        if (!v2)
             continue;
-
-        Variable *v2 = &it2.value();
-        v2->param_offset = offset;
-        v2->reg_index = v->reg_index;
+        v2->cold().param_offset = offset;
+        v2->cold().reg_index = v->cold().reg_index;
     }
 
     for (uint32_t i = 0; i < n_out; ++i) {
-        auto it = state.variables.find(vcall->out_nested[i]);
-        if (it == state.variables.end())
+        Variable *v = state.variables.find(vcall->out_nested[i]);
+        if (!v)
             continue;
-
-        Variable *v = &it.value();
         uint32_t size = type_size[v->type];
         out_size += size;
         out_align = std::max(size, out_align);
@@ -642,7 +818,10 @@ void jitc_var_vcall_assemble(VCall *vcall, uint32_t self_reg, uint32_t mask_reg,
     ThreadState *ts = thread_state(vcall->backend);
 
     CallablesSet callables_set;
-    for (uint32_t i = 0; i < vcall->n_inst; ++i) {
+    bool parallel = jitc_var_vcall_assemble_parallel(ts, vcall, in_size, n_in,
+                                                     n_out, callables_set);
+
+    for (uint32_t i = 0; i < vcall->n_inst && !parallel; ++i) {
         XXH128_hash_t hash = jitc_assemble_func(
             ts, vcall->name, i, in_size, in_align, out_size, out_align,
             vcall->data_offset[i], vcall->data_map, n_in, vcall->in.data(),
@@ -664,10 +843,10 @@ void jitc_var_vcall_assemble(VCall *vcall, uint32_t self_reg, uint32_t mask_reg,
     schedule.clear();
     for (const JitBackupRecord &b : backup) {
         Variable *v = jitc_var(b.sv.index);
-        v->param_type = b.param_type;
-        v->output_flag = b.output_flag;
-        v->reg_index = b.reg_index;
-        v->param_offset = b.param_offset;
+        v->cold().param_type = b.param_type;
+        v->cold().output_flag = b.output_flag;
+        v->cold().reg_index = b.reg_index;
+        v->cold().param_offset = b.param_offset;
         schedule.push_back(b.sv);
     }
 
@@ -726,10 +905,10 @@ void jitc_var_vcall_collect_data(tsl::robin_map<uint64_t, uint32_t, UInt64Hasher
             jitc_raise(
                 "jit_var_vcall(): the virtual function call associated with "
                 "instance %u accesses an evaluated variable r%u of type "
-                "%s and size %u. However, only *scalar* (size == 1) "
+                "%s and size %zu. However, only *scalar* (size == 1) "
                 "evaluated variables can be accessed while recording "
                 "virtual function calls",
-                inst_id, index, type_name[v->type], v->size);
+                inst_id, index, type_name[v->type], (size_t) v->size);
     } else {
         for (uint32_t i = 0; i < 4; ++i) {
             uint32_t index_2 = v->dep[i];
@@ -822,7 +1001,7 @@ VCallBucket *jitc_var_vcall_reduce(JitBackend backend, const char *domain,
     // Ensure input index array is fully evaluated
     jitc_var_eval(index);
 
-    uint32_t size = jitc_var(index)->size;
+    size_t size = jitc_var(index)->size;
 
     if (domain)
         jitc_log(Debug, "jit_vcall(r%u, domain=\"%s\")", index, domain);
@@ -7,6 +7,7 @@
 #include <cmath>
 #include <cstring>
 #include <typeinfo>
+#include <vector>
 
 TEST_BOTH(01_creation_destruction_cse) {
     // Test CSE involving normal and evaluated constant literals
@@ -156,7 +157,7 @@ const char *op_name[(int) JitOp::Count] {
     // Fast approximations
     "rcp", "rsqrt",
 
-    // Multi-function generator (CUDA)
+    // Transcendental functions (CUDA: multi-function generator, LLVM: polynomials)
     "sin", "cos", "exp2", "log2",
 };
 
@@ -626,6 +627,327 @@ TEST_BOTH(07_and_or_mixed) {
     }
 }
 
+TEST_BOTH(09_long_dependency_chain) {
+    /* Graph traversal and variable destruction must not recurse along
+       dependency edges, which would overflow the stack for long chains */
+    {
+        UInt32 y = arange<UInt32>(4), x = y;
+        for (int i = 0; i < 200000; ++i)
+            x = x + y;
+        // Destroyed without ever being evaluated
+    }
+
+    UInt32 y = arange<UInt32>(4), x = y;
+    for (int i = 0; i < 10000; ++i)
+        x = x + y;
+    jit_assert(strcmp(x.str(), "[0, 10001, 20002, 30003]") == 0);
+}
+
+TEST_BOTH(10_large_size) {
+    /* Arrays with 2^32 or more entries are only supported by the LLVM backend,
+       whose counters then switch to 64 bit indices */
+    size_t size = ((size_t) 1 << 32) + 1;
+
+    if (Backend == JitBackend::CUDA) {
+        bool raised = false;
+        try {
+            jit_var_dec_ref(jit_var_counter(Backend, size));
+        } catch (const std::exception &) {
+            raised = true;
+        }
+        jit_assert(raised);
+    } else {
+        uint32_t index = jit_var_counter(Backend, size);
+        jit_assert(jit_var_size(index) == size &&
+                   jit_var_type(index) == VarType::UInt64);
+        jit_var_dec_ref(index);
+    }
+}
+
+TEST_BOTH(11_commutative_lvn) {
+    /* Equivalent expressions that only differ in the order of operands of a
+       commutative operation or in the direction of a comparison should be
+       merged by value numbering */
+    Float a = arange<Float>(10), b = a * 2.f;
+
+    jit_assert((a + b).index() == (b + a).index());
+    jit_assert(min(a, b).index() == min(b, a).index());
+    jit_assert((a > b).index() == (b < a).index());
+    jit_assert((a >= b).index() == (b <= a).index());
+    jit_assert((a - b).index() != (b - a).index());
+    jit_assert(strcmp((b > a).str(), "[0, 1, 1, 1, 1, 1, 1, 1, 1, 1]") == 0);
+}
+
+TEST_BOTH(12_eval_dirty) {
+    /* Accessing an array with pending writes should only run the side effects
+       that target it, other queued work should remain lazy */
+    UInt32 b = arange<UInt32>(10), c = arange<UInt32>(10);
+    b.eval();
+    c.eval();
+
+    UInt32 a = arange<UInt32>(10) + 1;
+    a.schedule();
+
+    scatter(b, UInt32(100), UInt32(2));
+    scatter(c, UInt32(200), UInt32(3));
+
+    UInt32 d = gather(b, arange<UInt32>(5));
+    jit_assert(!jit_var_is_evaluated(a.index()));
+    jit_assert(strcmp(c.str(), "[0, 1, 2, 200, 4, 5, 6, 7, 8, 9]") == 0);
+    jit_assert(!jit_var_is_evaluated(a.index()));
+    jit_assert(strcmp(d.str(), "[0, 1, 100, 3, 4]") == 0);
+    jit_assert(strcmp(a.str(), "[1, 2, 3, 4, 5, 6, 7, 8, 9, 10]") == 0);
+}
+
+TEST_BOTH(13_auto_materialize) {
+    /* Intermediate results that remain referenced after an evaluation are
+       stored if they are expensive to recompute */
+    jit_set_flag(JitFlag::AutoMaterialize, 1);
+
+    Float x = arange<Float>(16), y = x, w = x + 1.f;
+    for (int i = 0; i < 8; ++i)
+        y = sqrt(y + 1.f);
+
+    Float z = y + w;
+    z.eval();
+    jit_assert(jit_var_is_evaluated(y.index()));
+    jit_assert(!jit_var_is_evaluated(w.index()));
+
+    /* Shared subexpressions count once: this graph has a handful of
+       operations, while the expression tree that it represents has dozens */
+    Float t = x + 1.f;
+    for (int i = 0; i < 4; ++i)
+        t = t * t;
+    Float z3 = t + w;
+    z3.eval();
+    jit_assert(!jit_var_is_evaluated(t.index()));
+
+    jit_set_flag(JitFlag::AutoMaterialize, 0);
+    Float y2 = x;
+    for (int i = 0; i < 8; ++i)
+        y2 = sqrt(y2 + 2.f);
+    Float z2 = y2 + w;
+    z2.eval();
+    jit_assert(!jit_var_is_evaluated(y2.index()));
+}
+
+TEST_BOTH(14_kernel_split) {
+    /* Kernels exceeding the operation limit are split into several parts that
+       pass intermediate results through memory */
+    uint32_t max_ops, max_live;
+    jit_kernel_split_threshold(&max_ops, &max_live);
+
+    for (int split = 0; split < 2; ++split) {
+        jit_set_kernel_split_threshold(split ? 16 : 0, 0);
+
+        UInt32 x = arange<UInt32>(10), y = x;
+        std::vector<UInt32> chain;
+        for (int i = 0; i < 64; ++i) {
+            y = y * UInt32(3) + x;
+            chain.push_back(y);
+        }
+
+        jit_var_eval(y.index());
+
+        uint32_t value[10];
+        for (uint32_t i = 0; i < 10; ++i) {
+            uint32_t z = i;
+            for (int j = 0; j < 64; ++j)
+                z = z * 3 + i;
+            value[i] = z;
+        }
+        for (uint32_t i = 0; i < 10; ++i)
+            jit_assert(y.read(i) == value[i]);
+
+        size_t stored = 0;
+        for (const UInt32 &c : chain)
+            stored += jit_var_is_evaluated(c.index());
+        jit_assert(split ? (stored >= 2 && stored < 64) : stored == 1);
+    }
+
+    jit_set_kernel_split_threshold(max_ops, max_live);
+}
+
+TEST_BOTH(15_small_kernels) {
+    /* Many small kernels of different sizes produced by one evaluation (these
+       are launched by a single task on the LLVM backend) */
+    UInt32 a = arange<UInt32>(1) + 5u,
+           b = arange<UInt32>(3) * 2u,
+           c = arange<UInt32>(17) + 1u,
+           d = arange<UInt32>(256) * 3u,
+           e = zero<UInt32>(5);
+    scatter_reduce(ReduceOp::Add, e, UInt32(1), arange<UInt32>(3));
+    jit_var_schedule(a.index());
+    jit_var_schedule(b.index());
+    jit_var_schedule(c.index());
+    jit_var_schedule(d.index());
+    jit_eval();
+
+    jit_assert(strcmp(a.str(), "[5]") == 0);
+    jit_assert(strcmp(b.str(), "[0, 2, 4]") == 0);
+    jit_assert(strcmp(e.str(), "[1, 1, 1, 0, 0]") == 0);
+    for (uint32_t i = 0; i < 17; ++i)
+        jit_assert(c.read(i) == i + 1);
+    for (uint32_t i = 0; i < 256; ++i)
+        jit_assert(d.read(i) == i * 3);
+}
+
+template <typename Array, typename Value = typename Array::Value>
+void check_transcendental(uint32_t (*op)(uint32_t), Value (*ref)(Value),
+                          Value min, Value max, Value tol) {
+    Array x = linspace<Array>(min, max, 1001),
+          y = Array::steal(op(x.index()));
+
+    for (uint32_t i = 0; i < 1001; ++i) {
+        Value xi = x.read(i), yi = y.read(i), ri = ref(xi);
+        jit_assert(std::abs(yi - ri) <= tol * std::max(std::abs(ri), Value(1)));
+    }
+}
+
+TEST_LLVM(16_transcendental) {
+    using Double = Array<double>;
+    const float tol_f = 4e-7f;
+    const double tol_d = 1e-15;
+    check_transcendental<Float>(jit_var_sin, std::sin, -100.f, 100.f, tol_f);
+    check_transcendental<Float>(jit_var_cos, std::cos, -100.f, 100.f, tol_f);
+    check_transcendental<Float>(jit_var_exp2, std::exp2, -140.f, 120.f, tol_f);
+    check_transcendental<Float>(jit_var_log2, std::log2, 1e-40f, 1e30f, tol_f);
+    check_transcendental<Double>(jit_var_sin, std::sin, -1e5, 1e5, tol_d);
+    check_transcendental<Double>(jit_var_cos, std::cos, -1e5, 1e5, tol_d);
+    check_transcendental<Double>(jit_var_exp2, std::exp2, -1000., 1000., tol_d);
+    check_transcendental<Double>(jit_var_log2, std::log2, 1e-300, 1e300, tol_d);
+
+    // Large arguments (alone and mixed with small ones) need a precise reduction
+    check_transcendental<Float>(jit_var_sin, std::sin, -2e4f, 2e4f, tol_f);
+    check_transcendental<Float>(jit_var_cos, std::cos, 1e6f, 3e38f, tol_f);
+    check_transcendental<Float>(jit_var_sin, std::sin, -3e38f, -1e6f, tol_f);
+    check_transcendental<Double>(jit_var_sin, std::sin, -1e10, 1e10, tol_d);
+    check_transcendental<Double>(jit_var_cos, std::cos, 1e15, 1e308, tol_d);
+    check_transcendental<Double>(jit_var_sin, std::sin, -1e308, -1e15, tol_d);
+
+    float large_f[] = { 1e7f, 1e10f, 1e20f, 3e38f };
+    Float lf = Float::copy(large_f, 4),
+          sf = Float::steal(jit_var_sin(lf.index()));
+    for (uint32_t i = 0; i < 4; ++i)
+        jit_assert(std::abs(sf.read(i) - std::sin(large_f[i])) <= tol_f);
+
+    double large_d[] = { 1e16, 1e20, 1e300 };
+    Double ld = Double::copy(large_d, 3),
+           sd = Double::steal(jit_var_sin(ld.index()));
+    for (uint32_t i = 0; i < 3; ++i)
+        jit_assert(std::abs(sd.read(i) - std::sin(large_d[i])) <= tol_d);
+
+    // Special values
+    float special[] = { 0.f, -0.f, INFINITY, -INFINITY, NAN, -1.f };
+    Float s = Float::copy(special, 6);
+    jit_assert(strcmp(Float::steal(jit_var_exp2(s.index())).str(),
+                      "[1, 1, inf, 0, nan, 0.5]") == 0);
+    jit_assert(strcmp(Float::steal(jit_var_log2(s.index())).str(),
+                      "[-inf, -inf, inf, nan, nan, nan]") == 0);
+    jit_assert(std::signbit(Float::steal(jit_var_sin(s.index())).read(1)));
+    Float sc = Float::steal(jit_var_cos(s.index()));
+    for (uint32_t i = 2; i < 5; ++i)
+        jit_assert(std::isnan(sc.read(i)));
+}
+
+TEST_LLVM(17_kernel_width) {
+    uint32_t target = jit_llvm_vector_width(), n = 100000;
+    int autotune = 1;
+
+    bool raised = false;
+    try {
+        jit_llvm_set_kernel_width(target * 2, 0);
+    } catch (const std::exception &) {
+        raised = true;
+    }
+    jit_assert(raised);
+
+    // Kernels of each width, and autotuned ones (which alternate widths)
+    for (uint32_t width : { 4u, 0u }) {
+        for (int tune : { 0, 1 }) {
+            jit_llvm_set_kernel_width(width, tune);
+            jit_assert(jit_llvm_kernel_width(&autotune) == width &&
+                       autotune == tune);
+
+            for (uint32_t k = 0; k < 8; ++k) {
+                UInt32 x = arange<UInt32>(n) * 3u + UInt32(k);
+                Float y = Float(x) * 0.5f;
+                y.eval();
+                jit_assert(x.read(n - 1) == (n - 1) * 3u + k);
+                jit_assert(y.read(7) == (float) (21 + k) * 0.5f);
+            }
+        }
+    }
+
+    jit_llvm_set_kernel_width(0, 0);
+    jit_assert(jit_llvm_kernel_width(nullptr) == 0);
+}
+
+TEST_LLVM(18_unroll_hoist) {
+    // Sizes that are not a multiple of the unrolled step use a remainder loop
+    uint32_t n = 1001, value = 5;
+
+    bool raised = false;
+    try {
+        jit_llvm_set_unroll(5);
+    } catch (const std::exception &) {
+        raised = true;
+    }
+    jit_assert(raised && jit_llvm_unroll() == 1);
+
+    for (uint32_t unroll = 1; unroll <= 4; ++unroll) {
+        for (int hoist = 0; hoist < 2; ++hoist) {
+            jit_llvm_set_unroll(unroll);
+            jit_set_flag(JitFlag::HoistUniform, hoist);
+
+            // Scalar input and uniform arithmetic mixed with a wide array
+            UInt32 s = UInt32::copy(&value, 1),
+                   a = s * s + UInt32(unroll),
+                   x = arange<UInt32>(n) * a + s;
+            x.eval();
+
+            for (uint32_t i = 0; i < n; i += 97)
+                jit_assert(x.read(i) == i * (25 + unroll) + 5);
+            jit_assert(x.read(n - 1) == (n - 1) * (25 + unroll) + 5);
+        }
+    }
+
+    jit_llvm_set_unroll(1);
+    jit_set_flag(JitFlag::HoistUniform, 1);
+}
+
+TEST_LLVM(19_hoist_hash) {
+    /* Kernels that only differ in their hoisted prologue must have
+       different hashes (these also name the kernel cache files) */
+    uint32_t n = 100, value = 5;
+    jit_set_flag(JitFlag::KernelHistory, 1);
+    jit_kernel_history_clear();
+
+    // Both kernels are built in the same order and only differ in 'a'
+    UInt32 s = UInt32::copy(&value, 1);
+    auto kernel = [&](bool add) {
+        UInt32 a = add ? (s + UInt32(3)) : (s * UInt32(3)),
+               r = arange<UInt32>(n) * a;
+        r.eval();
+        return r;
+    };
+    UInt32 x = kernel(true), y = kernel(false);
+    jit_assert(x.read(n - 1) == (n - 1) * 8 && y.read(n - 1) == (n - 1) * 15);
+
+    KernelHistoryEntry *data = jit_kernel_history(), *e = data;
+    std::vector<std::pair<uint64_t, uint64_t>> hashes;
+    while (e && e->ir) {
+        if (e->size == n)
+            hashes.emplace_back(e->hash[0], e->hash[1]);
+        free(e->ir);
+        e++;
+    }
+    free(data);
+    jit_set_flag(JitFlag::KernelHistory, 0);
+
+    jit_assert(hashes.size() == 2 && hashes[0] != hashes[1]);
+}
+
 #if 0
 template <JitBackend Backend, typename... Ts>
 void printf_async(const JitArray<Backend, bool> &mask, const char *fmt,
@@ -1,5 +1,6 @@
 #include "test.h"
 #include <cstring>
+#include <vector>
 
 TEST_BOTH(01_gather) {
     Int32 r = arange<Int32>(100) + 100;
@@ -232,3 +233,287 @@ TEST_BOTH(15_gather_symbolic_multiple_mask) {
     Float buf_2 = gather<Float>(buf_1, index_2, mask_2);
     jit_assert(strcmp(buf_2.str(), "[1, 2, 0, 0]") == 0);
 }
+
+TEST_LLVM(16_numa_modes) {
+    /* Results must not depend on the NUMA policy (the request is ignored
+       with a warning on machines with a single NUMA node) */
+    NUMAMode modes[] = { NUMAMode::Interleave, NUMAMode::Partition,
+                         NUMAMode::Disabled };
+
+    for (NUMAMode mode : modes) {
+        jit_llvm_set_numa_mode(mode);
+        UInt32 x = arange<UInt32>(4000000) * 2 + 1;
+        x.eval();
+        UInt32 y = hsum(x - arange<UInt32>(4000000) * 2);
+        jit_assert(y.read(0) == 4000000);
+    }
+    jit_assert(jit_llvm_numa_mode() == NUMAMode::Disabled);
+}
+
+TEST_LLVM(17_memset_memcpy_large) {
+    /* Exercise the blocked (and for the largest size, non-temporal) fill and
+       copy paths, including sizes that aren't multiples of the work unit */
+    uint32_t sizes[] = { 1, 17, 100003, 20000003 };
+    for (uint32_t size : sizes) {
+        uint16_t value = 0x1234;
+        size_t bytes = (size_t) size * sizeof(uint16_t);
+        uint16_t *a = (uint16_t *) jit_malloc(AllocType::HostAsync, bytes),
+                 *b = (uint16_t *) jit_malloc(AllocType::HostAsync, bytes);
+
+        jit_memset_async(Backend, a, size, sizeof(uint16_t), &value);
+        jit_memcpy_async(Backend, b, a, bytes);
+        jit_sync_thread();
+
+        jit_assert(b[0] == value && b[size / 2] == value &&
+                   b[size - 1] == value);
+
+        jit_free(a);
+        jit_free(b);
+    }
+}
+
+TEST_BOTH(18_scatter_reduce_zero_target) {
+    /* Large zero-valued scatter-reduce targets are backed by the zero page on
+       the LLVM backend. Repeat to exercise both fresh and recycled memory */
+    for (int i = 0; i < 3; ++i) {
+        UInt32 target = zero<UInt32>(1000000),
+               index  = UInt32(5, 999999, 5, 123456);
+        scatter_reduce(ReduceOp::Add, target, UInt32(1, 2, 3, 4), index);
+        target.eval();
+
+        jit_assert(target.read(0) == 0 && target.read(5) == 4 &&
+                   target.read(123456) == 4 && target.read(999999) == 2 &&
+                   target.read(500000) == 0);
+    }
+}
+
+TEST_BOTH(19_mem_map_file) {
+    const char *fname = "test_mem_map_file.bin";
+
+    /* Round trip */ {
+        UInt32 x = arange<UInt32>(1000) * 3;
+        jit_var_write_file(x.index(), fname);
+
+        // Map a region starting at an unaligned (non-page) offset
+        UInt32 y = UInt32::steal(jit_var_mem_map_file(
+            Backend, VarType::UInt32, fname, 10 * sizeof(uint32_t), 990));
+        jit_assert(all(eq(y, arange<UInt32>(10, 1000, 1) * 3)));
+
+        // Private mappings are copy-on-write, the file stays unchanged
+        scatter(y, UInt32(7), UInt32(0));
+        jit_assert(y.read(0) == 7);
+        UInt32 z = UInt32::steal(jit_var_mem_map_file(
+            Backend, VarType::UInt32, fname, 0, 1000));
+        jit_assert(z.read(10) == 30);
+    }
+
+    jit_sync_thread();
+
+    /* Literals are written without being materialized */ {
+        UInt32 w = full<UInt32>(5, 100);
+        jit_var_write_file(w.index(), fname);
+        UInt32 v = UInt32::steal(jit_var_mem_map_file(
+            Backend, VarType::UInt32, fname, 0, 100));
+        jit_assert(all(eq(v, 5)));
+    }
+
+    remove(fname);
+}
+
+TEST_BOTH(20_eval_stream) {
+    const char *fname_in = "test_eval_stream_in.bin",
+               *fname_out = "test_eval_stream_out.bin";
+    const uint32_t n = 1000;
+
+    UInt32 x = arange<UInt32>(n);
+    jit_var_write_file(x.index(), fname_in);
+
+    std::vector<uint32_t> sink_data(n, 0);
+
+    JitStreamInput inputs[2] { };
+    inputs[0].type = VarType::UInt32;
+    inputs[0].filename = fname_in;
+    inputs[1].type = VarType::UInt32;
+    inputs[1].source = [](void *, size_t start, uint32_t count, void *dst) {
+        for (uint32_t i = 0; i < count; ++i)
+            ((uint32_t *) dst)[i] = (uint32_t) (start + i) * 2;
+    };
+
+    JitStreamOutput outputs[4] { };
+    outputs[0].reduce = ReduceOp::None;
+    outputs[0].sink = [](void *payload, size_t start, uint32_t count,
+                         const void *src) {
+        memcpy((uint32_t *) payload + start, src, count * sizeof(uint32_t));
+    };
+    outputs[0].payload = sink_data.data();
+    outputs[1].reduce = ReduceOp::None;
+    outputs[1].filename = fname_out;
+    outputs[2].reduce = ReduceOp::Add;
+    outputs[3].reduce = ReduceOp::Max;
+
+    JitStreamKernel kernel =
+        [](void *, size_t, uint32_t, const uint32_t *in, uint32_t *out) {
+            jit_var_inc_ref(in[0]);
+            jit_var_inc_ref(in[1]);
+            UInt32 a = UInt32::steal(in[0]), b = UInt32::steal(in[1]);
+            UInt32 r[4] = { a + b, a * 3, a, UInt32(7) };
+            for (int i = 0; i < 4; ++i) {
+                out[i] = r[i].index();
+                jit_var_inc_ref(out[i]);
+            }
+        };
+
+    // Chunk size that does not divide the array size
+    jit_eval_stream(Backend, n, 300, 2, inputs, 4, outputs, kernel, nullptr);
+
+    for (uint32_t i = 0; i < n; ++i)
+        jit_assert(sink_data[i] == i * 3);
+
+    UInt32 y = UInt32::steal(
+        jit_var_mem_map_file(Backend, VarType::UInt32, fname_out, 0, n));
+    jit_assert(all(eq(y, arange<UInt32>(n) * 3)));
+
+    jit_assert(outputs[2].result == n * (n - 1) / 2);
+    jit_assert(outputs[3].result == 7);
+
+    // Resources acquired before an error are released
+    bool raised = false;
+    try {
+        jit_eval_stream(Backend, n + 1, 300, 2, inputs, 4, outputs, kernel,
+                        nullptr);
+    } catch (const std::exception &) {
+        raised = true;
+    }
+    jit_assert(raised);
+
+    remove(fname_in);
+    remove(fname_out);
+}
+
+TEST_BOTH(21_gather_scatter_affine) {
+    /* Gathers and scatters whose index is an affine function of the lane
+       counter use (strided) vector loads and stores on the LLVM backend.
+       The size is deliberately not a multiple of the vector width. */
+    uint32_t n = 37;
+    UInt32 i = arange<UInt32>(n);
+
+    UInt32 src = arange<UInt32>(4 * n + 5) * 10u;
+    Mask src_m = eq(arange<UInt32>(2 * n) & UInt32(1), 1u);
+    src.eval();
+    src_m.eval();
+
+    UInt32 a = gather<UInt32>(src, i + 5u),
+           b = gather<UInt32>(src, i * 2u + 1u),
+           c = gather<UInt32>(src, i * 3u, i > 10u),
+           d = gather<UInt32>(src, Array<uint64_t>(i) * Array<uint64_t>(4)),
+           f = gather<UInt32>(src, (UInt32(n) - i) << UInt32(1)); // Stride -2
+    Mask e = gather<Mask>(src_m, i + 1u);
+
+    UInt32 t1 = zero<UInt32>(n + 2), t2 = zero<UInt32>(3 * n + 1);
+    scatter(t1, i + 1u, i + 2u, i < 30u);
+    scatter(t2, i + 1u, i * 3u + 1u);
+
+    for (uint32_t j = 0; j < n; ++j) {
+        jit_assert(a.read(j) == (j + 5) * 10);
+        jit_assert(b.read(j) == (j * 2 + 1) * 10);
+        jit_assert(c.read(j) == (j > 10 ? j * 30 : 0));
+        jit_assert(d.read(j) == j * 40);
+        jit_assert(f.read(j) == (n - j) * 20);
+        jit_assert(e.read(j) == (((j + 1) & 1) == 1));
+        jit_assert(t1.read(j + 2) == (j < 30 ? j + 1 : 0));
+        jit_assert(t2.read(j * 3 + 1) == j + 1);
+        jit_assert(t2.read(j * 3) == 0);
+    }
+}
+
+TEST_BOTH(22_gather_prefetch) {
+    // Gathers with an index loaded from memory, using software prefetching
+    uint32_t n = 1000, distance = 123;
+    for (uint32_t d : { 0u, 3u }) {
+        jit_llvm_set_prefetch(1, d);
+        jit_assert(jit_llvm_prefetch(&distance) == 1 && distance == d);
+
+        UInt32 src = arange<UInt32>(n) * 2u,
+               index = (arange<UInt32>(n) * 7919u) % UInt32(n);
+        index.eval();
+
+        // The second index is computed and cannot be prefetched
+        Float y = gather<Float>(Float(src), UInt32(n - 1) - index);
+        UInt32 x = gather<UInt32>(src, index, index > 10u);
+
+        for (uint32_t i = 0; i < n; ++i) {
+            uint32_t j = (i * 7919u) % n;
+            jit_assert(x.read(i) == (j > 10 ? j * 2 : 0));
+            jit_assert(y.read(i) == (float) ((n - 1 - j) * 2));
+        }
+    }
+    jit_llvm_set_prefetch(0, 0);
+    jit_assert(jit_llvm_prefetch(nullptr) == 0);
+}
+
+TEST_BOTH(23_gather_small_table) {
+    /* Gathers from tiny tables are lowered to in-register permutations on
+       the LLVM backend. Try tables that span one or more packets. */
+    uint32_t n = 100;
+    for (uint32_t size : { 3u, 5u, 16u, 40u, 64u }) {
+        Float table = arange<Float>(size) * Float(0.5f) + Float(1.f);
+        Int32 table_i = arange<Int32>(size) - Int32(7);
+        table.eval();
+        table_i.eval();
+
+        UInt32 index = (arange<UInt32>(n) * 13u) % UInt32(size);
+        Mask active = neq(arange<UInt32>(n) & UInt32(3), 0u);
+
+        Float x = gather<Float>(table, index);
+        Int32 y = gather<Int32>(table_i, index, active);
+
+        for (uint32_t i = 0; i < n; ++i) {
+            uint32_t j = (i * 13u) % size;
+            jit_assert(x.read(i) == j * 0.5f + 1.f);
+            jit_assert(y.read(i) == ((i & 3) != 0 ? (int32_t) j - 7 : 0));
+        }
+    }
+}
+
+TEST_BOTH(24_scatter_reduce_private) {
+    /* Large scatter-reductions into small arrays are privatized per worker
+       thread on the LLVM backend. Use several targets and operations. */
+    uint32_t n = 100000, size = 37;
+    UInt32 i = arange<UInt32>(n), index = i % UInt32(size);
+
+    UInt32 count = zero<UInt32>(size);
+    Float max_value = zero<Float>(size);
+    Int32 min_value = zero<Int32>(size);
+
+    scatter_reduce(ReduceOp::Add, count, UInt32(1), index);
+    scatter_reduce(ReduceOp::Max, max_value, Float(i), index);
+    scatter_reduce(ReduceOp::Min, min_value, -Int32(i), index);
+    jit_eval();
+
+    for (uint32_t j = 0; j < size; ++j) {
+        uint32_t last = (n - 1 - j) / size * size + j;
+        jit_assert(count.read(j) == n / size + (j < n % size ? 1 : 0));
+        jit_assert(max_value.read(j) == (float) last);
+        jit_assert(min_value.read(j) == -(int32_t) last);
+    }
+}
+
+TEST_BOTH(25_scatter_reduce_unique) {
+    /* Scatter-reductions with unique indices don't need atomics */
+    UInt32 target = arange<UInt32>(16);
+    Float target_f = arange<Float>(16);
+    UInt32 index = UInt32(15) - arange<UInt32>(16);
+    Mask active = neq(index & UInt32(1), 0u);
+
+    target = UInt32::steal(jit_var_scatter_unique(
+        target.index(), UInt32(100).index(), index.index(), active.index(),
+        ReduceOp::Add));
+    target_f = Float::steal(jit_var_scatter_unique(
+        target_f.index(), Float(2.f).index(), index.index(), active.index(),
+        ReduceOp::Mul));
+
+    jit_assert(strcmp(target.str(), "[0, 101, 2, 103, 4, 105, 6, 107, 8, "
+                                    "109, 10, 111, 12, 113, 14, 115]") == 0);
+    jit_assert(strcmp(target_f.str(), "[0, 2, 2, 6, 4, 10, 6, 14, 8, 18, 10, "
+                                      "22, 12, 26, 14, 30]") == 0);
+}
@@ -0,0 +1,160 @@
+#include "test.h"
+#include <initializer_list>
+
+/// Evaluate x / d and x % d and compare against the host
+template <typename Array, typename Value>
+void check_div_mod(const Value *values, size_t size, Value d) {
+    Array x = Array::copy(values, size),
+          q = x / Array(d),
+          r = x % Array(d);
+
+    for (size_t i = 0; i < size; ++i) {
+        jit_assert(q.read(i) == (Value) (values[i] / d));
+        jit_assert(r.read(i) == (Value) (values[i] % d));
+    }
+}
+
+TEST_BOTH(01_div_const) {
+    size_t div_count = jit_rewrite_count(JitRewrite::DivConst),
+           mod_count = jit_rewrite_count(JitRewrite::ModConst);
+
+    uint32_t u32[] = { 0, 1, 2, 6, 7, 8, 1000, 123456789, 0x7fffffffu,
+                       0x80000000u, 0xfffffffeu, 0xffffffffu };
+    int32_t i32[] = { 0, 1, -1, 6, -6, 7, -7, 1000, -1000, 0x7fffffff,
+                      -0x7fffffff - 1 };
+    uint64_t u64[] = { 0, 1, 7, 1000, 0xffffffffull, 0x123456789abcdefull,
+                       0xfffffffffffffffeull, 0xffffffffffffffffull };
+    int64_t i64[] = { 0, 1, -1, 7, -7, 0x123456789abcdefll,
+                      -0x123456789abcdefll, 0x7fffffffffffffffll };
+
+    for (uint32_t d : { 3u, 7u, 10u, 641u, 0x80000001u, 0xffffffffu })
+        check_div_mod<UInt32>(u32, sizeof(u32) / sizeof(uint32_t), d);
+    for (int32_t d : { 3, -3, 7, -7, 8, -8, 1000, -0x7fffffff - 1 })
+        check_div_mod<Int32>(i32, sizeof(i32) / sizeof(int32_t), d);
+    for (uint64_t d : { 3ull, 10ull, 0x100000001ull, 0x8000000000000001ull })
+        check_div_mod<Array<uint64_t>>(u64, sizeof(u64) / sizeof(uint64_t), d);
+    for (int64_t d : { 3ll, -7ll, 16ll, 0x100000001ll })
+        check_div_mod<Array<int64_t>>(i64, sizeof(i64) / sizeof(int64_t), d);
+
+    jit_assert(jit_rewrite_count(JitRewrite::DivConst) > div_count);
+    jit_assert(jit_rewrite_count(JitRewrite::ModConst) > mod_count);
+
+    // Unsigned modulo by a power of two becomes a bit mask
+    mod_count = jit_rewrite_count(JitRewrite::ModConst);
+    UInt32 x = arange<UInt32>(10) % UInt32(4);
+    jit_assert(jit_rewrite_count(JitRewrite::ModConst) == mod_count + 1);
+    jit_assert(strcmp(x.str(), "[0, 1, 2, 3, 0, 1, 2, 3, 0, 1]") == 0);
+}
+
+TEST_BOTH(02_mul_two) {
+    size_t count = jit_rewrite_count(JitRewrite::MulTwo);
+    Float x = arange<Float>(5);
+    Float y = x * Float(2.f), z = Float(2.f) * x;
+    jit_assert(jit_rewrite_count(JitRewrite::MulTwo) == count + 2);
+    jit_assert(y.index() == z.index());
+    jit_assert(y.index() == (x + x).index());
+    jit_assert(strcmp(y.str(), "[0, 2, 4, 6, 8]") == 0);
+}
+
+TEST_BOTH(03_double_neg) {
+    size_t count = jit_rewrite_count(JitRewrite::DoubleNeg);
+    Float x = arange<Float>(5);
+    UInt32 y = arange<UInt32>(5);
+    jit_assert((-(-x)).index() == x.index());
+    jit_assert((~(~y)).index() == y.index());
+    jit_assert(jit_rewrite_count(JitRewrite::DoubleNeg) == count + 2);
+}
+
+TEST_BOTH(04_select_same) {
+    size_t count = jit_rewrite_count(JitRewrite::SelectSame);
+    Float x = arange<Float>(5);
+    Mask m = x > Float(2.f);
+    jit_assert(select(m, x, x).index() == x.index());
+    jit_assert(jit_rewrite_count(JitRewrite::SelectSame) == count + 1);
+}
+
+TEST_BOTH(05_compare_fold) {
+    size_t count = jit_rewrite_count(JitRewrite::CompareFold);
+    UInt32 x = arange<UInt32>(5), zero = 0;
+    Int32 y = arange<Int32>(5) - Int32(2);
+
+    // Unsigned comparisons against zero
+    jit_assert(strcmp((x < zero).str(), "[0, 0, 0, 0, 0]") == 0);
+    jit_assert(strcmp((x >= zero).str(), "[1, 1, 1, 1, 1]") == 0);
+
+    // Masks compared against literals
+    Mask m = y > Int32(0);
+    jit_assert(eq(m, Mask(true)).index() == m.index());
+    jit_assert(neq(m, Mask(false)).index() == m.index());
+
+    // Negated integer comparisons
+    Mask n = ~(y < Int32(0));
+    jit_assert(n.index() == (y >= Int32(0)).index());
+    jit_assert(strcmp(n.str(), "[0, 0, 1, 1, 1]") == 0);
+    jit_assert(strcmp(eq(m, Mask(false)).str(), "[1, 1, 1, 0, 0]") == 0);
+
+    jit_assert(jit_rewrite_count(JitRewrite::CompareFold) == count + 7);
+
+    // Not valid for floating point values (NaNs)
+    Float z = arange<Float>(5);
+    Mask o = ~(z < Float(1.f));
+    jit_assert(o.index() != (z >= Float(1.f)).index());
+}
+
+TEST_BOTH(06_fma_contract) {
+    size_t count = jit_rewrite_count(JitRewrite::FmaContract);
+
+    // Floating point products are only contracted if permitted
+    Float x = arange<Float>(5), y = x + Float(0.5f);
+    Float z1 = x * y + Float(1.f);
+    z1.eval();
+    jit_assert(jit_rewrite_count(JitRewrite::FmaContract) == count);
+
+    jit_set_flag(JitFlag::ContractFma, 1);
+    Float z2 = x * x + Float(2.f);
+    z2.eval();
+    jit_assert(jit_rewrite_count(JitRewrite::FmaContract) == count + 1);
+    jit_assert(strcmp(z2.str(), "[2, 3, 6, 11, 18]") == 0);
+
+    // .. and integer products never (there is no fused instruction)
+    UInt32 a = arange<UInt32>(5), b = a + UInt32(3);
+    UInt32 c = a * b + UInt32(1);
+    jit_assert(strcmp(c.str(), "[1, 5, 11, 19, 29]") == 0);
+    jit_assert(jit_rewrite_count(JitRewrite::FmaContract) == count + 1);
+
+    // Products that are referenced elsewhere (even just by a handle) remain
+    Float p = x * y, q = p + Float(1.f);
+    q.eval();
+    jit_assert(jit_rewrite_count(JitRewrite::FmaContract) == count + 1);
+    jit_assert(strcmp(p.str(), "[0, 1.5, 5, 10.5, 18]") == 0);
+
+    // .. but are contracted once the handle is gone
+    Float r;
+    {
+        Float p2 = x * x + Float(5.f);
+        r = p2 * Float(3.f) + Float(1.f);
+    }
+    jit_assert(strcmp(r.str(), "[16, 19, 28, 43, 64]") == 0);
+    jit_assert(jit_rewrite_count(JitRewrite::FmaContract) == count + 3);
+    jit_set_flag(JitFlag::ContractFma, 0);
+}
+
+TEST_BOTH(07_cast_chain) {
+    size_t count = jit_rewrite_count(JitRewrite::CastChain);
+    Int32 x = arange<Int32>(5) - Int32(2);
+
+    // Widening and narrowing again yields the original variable
+    Array<int64_t> y = x;
+    Int32 z = y;
+    jit_assert(z.index() == x.index());
+
+    // Signed values passing through a wider unsigned type must not collapse
+    Array<uint64_t> w = Array<uint32_t>(Array<int16_t>(x));
+    jit_assert(jit_rewrite_count(JitRewrite::CastChain) == count + 1);
+    jit_assert(w.read(0) == 0xfffffffeull);
+
+    Float f = arange<Float>(5);
+    Float g = Array<double>(f);
+    jit_assert(g.index() == f.index());
+    jit_assert(jit_rewrite_count(JitRewrite::CastChain) == count + 2);
+}
@@ -3,6 +3,7 @@
 #include <drjit-core/array.h>
 #include <cstdio>
 #include <cstring>
+#include <string>
 
 using namespace drjit;
 
@@ -15,6 +16,9 @@ static constexpr LogLevel Trace = LogLevel::Trace;
 extern int test_register(const char *name, void (*func)(), const char *flags = nullptr);
 extern "C" void log_level_callback(LogLevel cb, const char *msg);
 
+/// Messages received by 'log_level_callback' during the current test
+extern std::string log_value;
+
 using FloatC  = CUDAArray<float>;
 using Int32C  = CUDAArray<int32_t>;
 using UInt32C = CUDAArray<uint32_t>;
@@ -961,3 +961,184 @@ TEST_BOTH(13_load_bool_data) {
         jit_registry_trim();
     }
 }
+
+TEST_BOTH(14_coherent_dispatch) {
+    /* Coherent dispatch sorts the lanes of each block by instance on the LLVM
+       backend. The results must not depend on whether this happens. */
+    struct Base {
+        virtual Float f(Float x) = 0;
+    };
+
+    struct A1 : Base {
+        Float f(Float x) override { return (x + 10) * 2; }
+    };
+
+    struct A2 : Base {
+        Float f(Float x) override { return (x + 100) * 2; }
+    };
+
+    A1 a1;
+    A2 a2;
+    uint32_t i1 = jit_registry_put(Backend, "Base", &a1);
+    uint32_t i2 = jit_registry_put(Backend, "Base", &a2);
+    jit_assert(i1 == 1 && i2 == 2);
+
+    using BasePtr = Array<Base *>;
+    uint32_t n = 40000;
+
+    for (uint32_t t = 0; t < 4; ++t) {
+        jit_llvm_set_vcall_coherence(t % 2 ? 100.f : 1.f);
+
+        // Kernels may use a narrower width than the target
+        if (Backend == JitBackend::LLVM)
+            jit_llvm_set_kernel_width(t < 2 ? 0 : 4, 0);
+
+        UInt32 i = arange<UInt32>(n);
+        BasePtr self = (i * 7u) % UInt32(3);
+        Float x = Float(i);
+        Float y = vcall(
+            "Base", [](Base *self2, Float x2) { return self2->f(x2); }, self, x);
+        Mask m = y > Float(1000.f);
+        jit_var_schedule(y.index());
+        jit_var_schedule(m.index());
+        jit_eval();
+
+        for (uint32_t j = 0; j < n; j += 7) {
+            uint32_t k = (j * 7) % 3;
+            float ref = k == 0 ? 0.f : (j + (k == 1 ? 10.f : 100.f)) * 2;
+            jit_assert(y.read(j) == ref);
+            jit_assert(m.read(j) == (ref > 1000.f));
+        }
+    }
+
+    jit_llvm_set_vcall_coherence(0.f);
+    jit_assert(jit_llvm_vcall_coherence() == 0.f);
+    if (Backend == JitBackend::LLVM)
+        jit_llvm_set_kernel_width(0, 0);
+
+    jit_registry_remove(Backend, &a1);
+    jit_registry_remove(Backend, &a2);
+}
+
+TEST_BOTH(15_callable_library) {
+    /* On the LLVM backend, callables are compiled once and shared between
+       kernels. Launch several different kernels that call the same
+       instances and check that each one links against working code. */
+    struct Base {
+        virtual Float f(Float x) = 0;
+    };
+
+    struct A1 : Base {
+        Float f(Float x) override { return x * x + 1; }
+    };
+
+    struct A2 : Base {
+        Float f(Float x) override { return x * 3; }
+    };
+
+    A1 a1;
+    A2 a2;
+    uint32_t i1 = jit_registry_put(Backend, "Base", &a1);
+    uint32_t i2 = jit_registry_put(Backend, "Base", &a2);
+    jit_assert(i1 == 1 && i2 == 2);
+
+    using BasePtr = Array<Base *>;
+
+    for (uint32_t k = 0; k < 3; ++k) {
+        UInt32 i = arange<UInt32>(10);
+        BasePtr self = i % UInt32(3);
+        Float x = Float(i) + Float((float) k);
+        Float y = vcall(
+            "Base", [](Base *self2, Float x2) { return self2->f(x2); }, self, x);
+        y = y * Float((float) (k + 1));
+        jit_eval();
+
+        for (uint32_t j = 0; j < 10; ++j) {
+            float xv = (float) (j + k), ref = 0.f;
+            if (j % 3 == 1)
+                ref = xv * xv + 1;
+            else if (j % 3 == 2)
+                ref = xv * 3;
+            jit_assert(y.read(j) == ref * (k + 1));
+        }
+    }
+
+    jit_registry_remove(Backend, &a1);
+    jit_registry_remove(Backend, &a2);
+}
+
+TEST_BOTH(16_parallel_assembly) {
+    /* Vcalls with many instances generate their callables in parallel on the
+       LLVM backend. Each instance takes inputs, evaluates an intrinsic and
+       reads its own data, which exercises the deferred registration of
+       globals and the register numbering of inputs. */
+    struct Base {
+        virtual Float f(Float x, Float y) = 0;
+    };
+
+    struct I : Base {
+        Float scale;
+        uint32_t id = 0;
+        Float f(Float x, Float y) override {
+            if (id % 2)
+                return abs(x - y) * scale;
+            else
+                return max(x, y) + scale;
+        }
+    };
+
+    const uint32_t n_inst = 40, n = 200;
+    I inst[n_inst];
+
+    for (uint32_t i = 0; i < n_inst; ++i) {
+        inst[i].scale = Float((float) i);
+        inst[i].id = i;
+        jit_assert(jit_registry_put(Backend, "Base", &inst[i]) == i + 1);
+    }
+
+    using BasePtr = Array<Base *>;
+    UInt32 i = arange<UInt32>(n);
+    BasePtr self = i % UInt32(n_inst) + UInt32(1);
+    Float x = Float(i), y = Float(100.f);
+
+    // The parallel path requires more than one worker thread
+    uint32_t thread_count = jit_llvm_thread_count();
+    if (Backend == JitBackend::LLVM && thread_count < 2)
+        jit_llvm_set_thread_count(2);
+
+    for (uint32_t k = 0; k < 2; ++k) {
+        jit_set_flag(JitFlag::VCallOptimize, k);
+
+        /* Labeled IR (generated when logging at the 'Trace' level) disables
+           the parallel path, check that it runs otherwise */
+        Float z;
+        {
+            scoped_set_log_level guard(LogLevel::Debug);
+            log_value.clear();
+
+            z = vcall(
+                "Base",
+                [](Base *self2, Float x2, Float y2) { return self2->f(x2, y2); },
+                self, x, y);
+            z.eval();
+
+            if (Backend == JitBackend::LLVM)
+                jit_assert(strstr(log_value.c_str(), "generated 40 callables "
+                                                     "in parallel") != nullptr);
+        }
+
+        for (uint32_t j = 0; j < n; ++j) {
+            uint32_t id = j % n_inst;
+            float xv = (float) j,
+                  ref = (id % 2) ? (xv > 100.f ? xv - 100.f : 100.f - xv) * id
+                                 : (xv > 100.f ? xv : 100.f) + id;
+            jit_assert(z.read(j) == ref);
+        }
+    }
+
+    for (uint32_t j = 0; j < n_inst; ++j)
+        jit_registry_remove(Backend, &inst[j]);
+
+    if (Backend == JitBackend::LLVM)
+        jit_llvm_set_thread_count(thread_count);
+}